@@ -16,11 +16,14 @@ OUTPUT_IMAGE_PATH="PIC32CM_TestApp_I2C.img"
 CONFIG_FILE_PATH="../../Bootloader_I2C/src/config/default/bootloader/configurations/bootloader_configuration.toml"
 
 if [ "$IS_DEBUG" = false ]; then
+    # - Store the last address used by the application in the footer and get the range covered by the CRC
+    VERIFY_RANGE=$(python ../../tools/mdfu_verify_range.py -i $INPUT_IMAGE_PATH --start 0x1000 --footer 0x1FFEC)
+
     # - Fill the empty application data
     hexmate r0-FFFFFFFF,$INPUT_IMAGE_PATH -O$INPUT_IMAGE_PATH -FILL=w2:0xFFFF@0x1000:0x1FFFF -format=inhx32
 
-    # - Calculate the CRC32 over the application space 
-    hexmate $INPUT_IMAGE_PATH -O$INPUT_IMAGE_PATH +-CK=1000-1FFFB@1FFFC+FFFFFFFFg-5w-4p04C11DB7 -format=inhx32
+    # - Calculate the CRC32 over the range used by the application
+    hexmate $INPUT_IMAGE_PATH -O$INPUT_IMAGE_PATH +-CK=$VERIFY_RANGE@1FFFC+FFFFFFFFg-5w-4p04C11DB7 -format=inhx32
 
     # - Build the application binary
     pyfwimagebuilder build -i $INPUT_IMAGE_PATH -c $CONFIG_FILE_PATH -o $OUTPUT_IMAGE_PATH
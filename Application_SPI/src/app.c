@@ -60,6 +60,22 @@ APP_DATA appData;
 
 uint32_t __attribute((address(BTL_RAM_TRIGGER_START))) ramArray[4U];
 
+/* Boot time record written by the bootloader right after the trigger pattern.
+   It must not be initialized at startup, otherwise the time stamps are lost before they are read. */
+#define BTL_BOOT_TRACE_START (0x20000010)
+#define BTL_BOOT_TRACE_KEY (0x54544C42U)
+#define BTL_BOOT_PHASE_COUNT (7U)
+
+typedef struct
+{
+    uint32_t traceKey;
+    uint32_t tickFrequency;
+    uint32_t phaseMask;
+    uint32_t timeStamp[BTL_BOOT_PHASE_COUNT];
+} BTL_BOOT_TRACE;
+
+BTL_BOOT_TRACE __attribute((address(BTL_BOOT_TRACE_START), persistent)) bootTrace;
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: Application Callback Functions
@@ -95,6 +111,31 @@ static void Trigger_Bootloader(uint32_t triggerPattern)
     NVIC_SystemReset();
 }
 
+static void Boot_Trace_Print(void)
+{
+    static const char * const phaseNames[BTL_BOOT_PHASE_COUNT] = {
+        "SYS_Initialize", "Forced entry check", "Load new image", "Image verify",
+        "Load image backup", "Application start", "FTP start"
+    };
+
+    if ((bootTrace.traceKey == BTL_BOOT_TRACE_KEY) && (bootTrace.tickFrequency >= 1000000U))
+    {
+        uint32_t ticksPerUs = bootTrace.tickFrequency / 1000000U;
+
+        printf("\r\nBoot time from the end of SYS_Initialize in the bootloader:\r\n");
+        for (uint32_t phase = 0U; phase < BTL_BOOT_PHASE_COUNT; phase++)
+        {
+            if ((bootTrace.phaseMask & (1UL << phase)) != 0U)
+            {
+                printf("    %-18s : %lu us\r\n", phaseNames[phase], (unsigned long) (bootTrace.timeStamp[phase] / ticksPerUs));
+            }
+        }
+
+        // Only report the record once per boot
+        bootTrace.traceKey = 0U;
+    }
+}
+
 
 // *****************************************************************************
 // *****************************************************************************
@@ -144,6 +185,8 @@ void APP_Tasks(void)
 
         printf("\r\n############ Example Bootloader Application ############\r\n");
 
+        Boot_Trace_Print();
+
         bool appInitialized = true;
 
         if (appInitialized)
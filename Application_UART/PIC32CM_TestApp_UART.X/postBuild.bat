@@ -8,6 +8,7 @@ REM -     %1 - the INPUT_IMAGE_PATH argument is passed by the MPLAB post build s
 REM -     %2 - the IS_DEBUG argument is passed by the MPLAB post build step to identify if the application is being built to a hex file (for production) or an elf file (for debugging).
 REM ----------------------------------------------------------------------------
 @echo off
+setlocal EnableDelayedExpansion
 REM - Create variables from given arguments
 set INPUT_IMAGE_PATH=%1
 set IS_DEBUG=%2
@@ -16,11 +17,14 @@ REM - Relative path to client config file
 set CONFIG_FILE_PATH="..\..\Bootloader_UART\src\config\default\bootloader\configurations\bootloader_configuration.toml"
 
 if %IS_DEBUG% == false (
+    REM - Store the last address used by the application in the footer and get the range covered by the CRC
+    for /f %%r in ('python ..\..\tools\mdfu_verify_range.py -i %INPUT_IMAGE_PATH% --start 0x1000 --footer 0x1FFEC') do set VERIFY_RANGE=%%r
+
     REM - Fill the empty application data
     hexmate r0-FFFFFFFF,%INPUT_IMAGE_PATH% -O%INPUT_IMAGE_PATH% -FILL=w2:0xFFFF@0x1000:0x1FFFF -format=inhx32
 
-    REM - Calculate the CRC32 over the application space 
-    hexmate %INPUT_IMAGE_PATH% -O%INPUT_IMAGE_PATH% +-CK=1000-1FFFB@1FFFC+FFFFFFFFg-5w-4p04C11DB7 -format=inhx32
+    REM - Calculate the CRC32 over the range used by the application
+    hexmate %INPUT_IMAGE_PATH% -O%INPUT_IMAGE_PATH% +-CK=!VERIFY_RANGE!@1FFFC+FFFFFFFFg-5w-4p04C11DB7 -format=inhx32
 
     REM - Build the application binary
     pyfwimagebuilder build -i %INPUT_IMAGE_PATH% -c %CONFIG_FILE_PATH% -o %OUTPUT_IMAGE_PATH%
@@ -1,4 +1,20 @@
 #include <stdint.h>
 
+#define EXECUTION_IMAGE_ID 0x00000000U
+
+// NOTE: The top 2 bytes of this object are unused.
+volatile const uint32_t
+applicationSlotId __attribute__((used, section("application_slot_id"), space(prog), address(0x1FFEC))) = EXECUTION_IMAGE_ID;
+
+volatile const uint32_t
+applicationVersion __attribute__((used, section("application_version"), space(prog), address(0x1FFF0))) = 0x00000100U;
+
+// NOTE: The post build step replaces this value with the last address used by the application.
+volatile const uint32_t
+verificationEndAddress __attribute__((used, section("application_verify_end"), space(prog), address(0x1FFF4))) = 0x0001FFFBU;
+
+volatile const uint32_t
+verificationStartAddress __attribute__((used, section("application_verify_start"), space(prog), address(0x1FFF8))) = 0x00001000U;
+
 volatile const uint32_t
-crcStart __attribute__((used, section("crc_foot_start_address"), space(prog), address(0x1FFFC))) = 0xFFFFFFFF;
\ No newline at end of file
+crcStart __attribute__((used, section("crc_foot_start_address"), space(prog), address(0x1FFFC))) = 0xFFFFFFFF;
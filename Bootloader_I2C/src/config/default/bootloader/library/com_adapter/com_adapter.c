@@ -59,7 +59,7 @@
  * @def MAX_RESPONSE_DATA_FIELD
  * Contains the maximum size of a response.
  */
-#define MAX_RESPONSE_DATA_FIELD (25U)
+#define MAX_RESPONSE_DATA_FIELD (30U)
 
 /**
  * @ingroup com_adapter_i2c
@@ -94,10 +94,39 @@ static volatile uint16_t comResponseBufferIndex = 0U;
 static uint8_t comResponseBuffer[MAX_RESPONSE_DATA_FIELD + RESPONSE_OFFSET];
 static uint8_t *comReceiveBuffer = NULL;
 static uint16_t *comReceiveBufferIndex = NULL;  
-static volatile com_adapter_result_t comStatus;
+static volatile com_adapter_result_t comStatus = COM_BUSY;
+/**
+ * @ingroup com_adapter_i2c
+ * @brief Running sum of the command bytes stored by the receive interrupt, including the frame check bytes.
+ */
+static volatile uint32_t comReceiveCheckSum = 0U;
 
 static bool SERCOM_EventHandler(SERCOM_I2C_SLAVE_TRANSFER_EVENT event);
 
+/**
+ * @ingroup com_adapter_i2c
+ * @brief Calculate the frame check on the given data buffer
+ *
+ * The data is summed as little endian 16-bit words. Word aligned data is read 32 bits at a time.
+ *
+ * @param [in] ftpData Data buffer to be used for the frame check calculation
+ * @param [in] bufferLength Length of data objects in the buffer
+ * @return Calculated frame check
+ */
+static uint16_t FrameChecksumCalculate(const uint8_t * ftpData, uint16_t bufferLength);
+
+/**
+ * @ingroup com_adapter_i2c
+ * @brief Gets the value a frame byte adds to the frame check sum.
+ *
+ * Bytes at even offsets of the frame are the low byte of a little endian word and bytes at odd offsets the high byte.
+ *
+ * @param [in] data - Byte of the frame
+ * @param [in] byteIndex - Offset of the byte from the start of the frame
+ * @return Value to be added to the frame check sum
+ */
+static uint32_t FrameCheckTermGet(uint8_t data, uint16_t byteIndex);
+
 com_adapter_result_t COM_Initialize(uint16_t maximumBufferLength)
 {
     com_adapter_result_t result = COM_FAIL;
@@ -138,6 +167,7 @@ static bool SERCOM_EventHandler(SERCOM_I2C_SLAVE_TRANSFER_EVENT event)
                 result = true;
                 wasTransactionAcknowledged = true;
                 *comReceiveBufferIndex = 0x00U;
+                comReceiveCheckSum = 0U;
                 areTooManyBytesInCommand = false;
             }
             else
@@ -172,6 +202,7 @@ static bool SERCOM_EventHandler(SERCOM_I2C_SLAVE_TRANSFER_EVENT event)
             if (*comReceiveBufferIndex < maxBufferLength)
             {
                 comReceiveBuffer[*comReceiveBufferIndex] = nextByte;
+                comReceiveCheckSum += FrameCheckTermGet(nextByte, *comReceiveBufferIndex);
                 (*comReceiveBufferIndex)++;   
             }
             else
@@ -240,25 +271,45 @@ static bool SERCOM_EventHandler(SERCOM_I2C_SLAVE_TRANSFER_EVENT event)
     return result;
 }
 
-static uint16_t FrameChecksumCalculate(uint8_t * ftpData,uint16_t bufferLength)
+static uint16_t FrameChecksumCalculate(const uint8_t * ftpData, uint16_t bufferLength)
 {
-    uint16_t numBytesChecksummed = 0x0000U;
-    uint16_t checksum = 0x0000U;
+    uint32_t checksum = 0U;
+    uint16_t byteIndex = 0U;
 
-    while (numBytesChecksummed < (bufferLength))
+    // Aligned data is summed one 32-bit word, so two little endian halfwords, at a time
+    /* cppcheck-suppress misra-c2012-11.4 */
+    if ((((uint32_t)ftpData) % 4U) == 0U)
     {
-        if ((numBytesChecksummed % 2U) == 0U)
-        {
-            checksum += ((uint16_t)(ftpData[numBytesChecksummed]));
-        }
-        else
+        /* cppcheck-suppress misra-c2012-11.3 */
+        const uint32_t * wordPtr = (const uint32_t *) ftpData;
+
+        while (((uint32_t)byteIndex + 4U) <= bufferLength)
         {
-            checksum += (uint16_t)(((uint16_t)(ftpData[numBytesChecksummed])) << 8);
+            uint32_t dataWord = *wordPtr;
+            checksum += (dataWord & 0xFFFFU) + (dataWord >> 16);
+            wordPtr++;
+            byteIndex += 4U;
         }
-        numBytesChecksummed++;
     }
 
-    return (uint16_t )(~checksum);
+    while (((uint32_t)byteIndex + 2U) <= bufferLength)
+    {
+        checksum += (uint32_t)ftpData[byteIndex] | ((uint32_t)ftpData[byteIndex + 1U] << 8);
+        byteIndex += 2U;
+    }
+
+    // An odd length leaves a last byte in the low half of a word
+    if (byteIndex < bufferLength)
+    {
+        checksum += (uint32_t)ftpData[byteIndex];
+    }
+
+    return (uint16_t)(~checksum);
+}
+
+static uint32_t FrameCheckTermGet(uint8_t data, uint16_t byteIndex)
+{
+    return ((uint32_t)data << (((uint32_t)byteIndex & 1U) * 8U));
 }
 
 com_adapter_result_t COM_FrameTransfer(uint8_t *receiveBufferPtr,uint16_t *receiveIndexPtr)
@@ -281,21 +332,22 @@ com_adapter_result_t COM_FrameTransfer(uint8_t *receiveBufferPtr,uint16_t *recei
                 areTooManyBytesInCommand = false;
                 result = COM_BUFFER_ERROR;
             }
+            else if (*receiveIndexPtr < FRAME_CHECK_SIZE)
+            {
+                // Set the status to transport failure if the packet is too short to hold a checksum
+                result = COM_TRANSPORT_FAILURE;
+            }
             else 
             {
-
-                // Calculate the frame check sequence on the received packet 
-                uint16_t calcuatedFrameChecksum = FrameChecksumCalculate(receiveBufferPtr,*receiveIndexPtr - FRAME_CHECK_SIZE); 
-
                 // Extract the last two bytes from the packet
-                uint8_t *startOfWord = &receiveBufferPtr[*receiveIndexPtr - FRAME_CHECK_SIZE];
-                uint16_t frameCheckSequence = 0x0000U;
+                uint16_t frameCheckIndex = *receiveIndexPtr - FRAME_CHECK_SIZE;
+                uint8_t lowByte = receiveBufferPtr[frameCheckIndex];
+                uint8_t highByte = receiveBufferPtr[frameCheckIndex + 1U];
+                uint16_t frameCheckSequence = (uint16_t)((uint16_t)((uint16_t)highByte << 8) | lowByte);
 
-                uint8_t *workPtr = startOfWord;
-                uint8_t lowByte = *workPtr;
-                workPtr++;
-                uint8_t highByte = *workPtr;
-                frameCheckSequence = (uint16_t)((uint16_t)((uint16_t)highByte << 8) | lowByte);
+                // The sum built by the receive interrupt also holds the checksum bytes, take them back out
+                uint32_t dataChecksum = comReceiveCheckSum - FrameCheckTermGet(lowByte, frameCheckIndex) - FrameCheckTermGet(highByte, frameCheckIndex + 1U);
+                uint16_t calcuatedFrameChecksum = (uint16_t)(~dataChecksum);
 
                 // Check if calculated checksum and received checksum are equal
                 if (calcuatedFrameChecksum == frameCheckSequence)
@@ -369,6 +421,9 @@ com_adapter_result_t COM_FrameSet(uint8_t *responseBufferPtr, uint16_t responseL
         comResponseBufferIndex = 0U;
         result = COM_PASS;
     }
+    // Forget the send complete of the previous response, no read can end while the command is being processed
+    comStatus = COM_BUSY;
+
     // Set the state to sending length when the comResponseBuffer is ready
     comResponseTransferState = SENDING_LENGTH;
     isCommandReadyToProcess = false;
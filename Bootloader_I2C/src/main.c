@@ -41,17 +41,30 @@ int main(void)
     /* Initialize all modules */
     SYS_Initialize(NULL);
 
+    // Time stamp each boot phase from here on in the boot time record
+    BL_BootTraceStart();
+
     /**
      * Check to see if a bootload is requested.
      * If not, then validate the image before running it.
      */
-    if (BL_CheckForcedEntry() == false && BL_ImageVerify() == BL_PASS)
+    bool isEntryForced = BL_CheckForcedEntry();
+    BL_BootTraceMark(BL_BOOT_PHASE_FORCED_ENTRY_CHECK);
+
+    if (isEntryForced == false)
     {
-        BL_INDICATOR_Set();
-        BL_ApplicationStart();
+        bl_result_t verifyResult = BL_ImageVerify();
+        BL_BootTraceMark(BL_BOOT_PHASE_IMAGE_VERIFY);
+
+        if (verifyResult == BL_PASS)
+        {
+            BL_INDICATOR_Set();
+            BL_ApplicationStart();
+        }
     }
 
     // When a bootload is needed; Initialize the FTP layer and run the FTP task to download the new data
+    BL_BootTraceMark(BL_BOOT_PHASE_FTP_START);
     FTP_Initialize();
 
     BL_INDICATOR_Clear();
@@ -263,11 +263,15 @@ bl_example_result_t BL_ExampleInitialize(void)
         BootState = BOOTLOADER;
 
         // If forced entry is requested, enter bootloader
-        if (true == BL_CheckForcedEntry())
+        bool isEntryForced = BL_CheckForcedEntry();
+
+        if (false == isEntryForced)
         {
-            BootState = BOOTLOADER;
+            isEntryForced = ForcedEntryCheck();
         }
-        else if (true == ForcedEntryCheck())
+        BL_BootTraceMark(BL_BOOT_PHASE_FORCED_ENTRY_CHECK);
+
+        if (true == isEntryForced)
         {
             BootState = BOOTLOADER;
         }
@@ -290,6 +294,7 @@ bl_example_result_t BL_ExampleInitialize(void)
              * - Otherwise, no load is required
              */
             initStatus = LoadNewImage();
+            BL_BootTraceMark(BL_BOOT_PHASE_LOAD_NEW_IMAGE);
 
             /**
              * Stay in Bootloader mode if:
@@ -311,6 +316,7 @@ bl_example_result_t BL_ExampleInitialize(void)
                 {
                     // Run the verification if we have not done so already
                     isExecutionAreaValidated = (BL_PASS == BL_ImageVerifyById((uint8_t)(IMAGE_0)));
+                    BL_BootTraceMark(BL_BOOT_PHASE_IMAGE_VERIFY);
                 }
 
                 // Set the initial status based on the execution space's status
@@ -382,6 +388,7 @@ bl_example_result_t BL_ExampleInitialize(void)
                 if (initStatus != BL_ERROR_ROLLBACK_FAILURE) // Only attempt backup if not already a rollback error
                 {
                     initStatus = LoadImageBackup();
+                    BL_BootTraceMark(BL_BOOT_PHASE_LOAD_IMAGE_BACKUP);
                 }
                 else
                 {
@@ -397,6 +404,12 @@ bl_example_result_t BL_ExampleInitialize(void)
 
         BootState = ERROR_STATE;
     }
+
+    // The application start is stamped by BL_ApplicationStart
+    if (APPLICATION != BootState)
+    {
+        BL_BootTraceMark(BL_BOOT_PHASE_FTP_START);
+    }
     return EXAMPLE_OK;
 }
 
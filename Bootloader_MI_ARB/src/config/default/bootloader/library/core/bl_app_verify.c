@@ -28,6 +28,7 @@
  *              application image space.
  */
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include "bl_app_verify.h"
@@ -54,20 +55,75 @@
 static void CRC32_Calculate(uint32_t startAddress, uint32_t length, uint32_t *crc);
 /**
  * @ingroup mdfu_client_32bit
- * @brief Validates the CRC32 checksum for a specified memory region.
+ * @brief Validates the CRC32 checksum calculated over a memory region.
  *
  * This function checks the CRC32 checksum of a memory block against a
  * stored CRC value to verify data integrity and then returns a value indicating
  * whether the validation was successful or not.
  *
- * @param [in] startAddress - The starting address of the memory block to validate
- * @param [in] length - The length of the memory block in bytes
+ * @param [in] crc - The CRC32 checksum calculated over the memory block
  * @param [in] crcAddress - The address where the expected CRC32 checksum is stored
  * @return @ref BL_PASS - Bootloader verified the application image with no errors \n
  * @return @ref BL_FAIL - Bootloader encountered an error and failed unexpectedly \n
  * @return @ref BL_ERROR_VERIFICATION_FAIL - Bootloader image verification failed \n
  */
-static bl_result_t CRC32_Validate(uint32_t startAddress, uint32_t length, uint32_t crcAddress);
+static bl_result_t CRC32_Validate(uint32_t crc, uint32_t crcAddress);
+
+/**
+ * @ingroup mdfu_client_32bit
+ * @struct bl_verify_job_t
+ * @brief Holds the progress of a verification that is calculated in steps.
+ * @var bl_verify_job_t::address
+ * Contains the next address to be added to the CRC.
+ * @var bl_verify_job_t::endAddress
+ * Contains the first address after the hash range.
+ * @var bl_verify_job_t::crc
+ * Contains the CRC32 checksum of the bytes calculated so far.
+ * @var bl_verify_job_t::hashAddress
+ * Contains the address of the expected CRC32 checksum.
+ * @var bl_verify_job_t::installLocationId
+ * Contains the identifier of the image space being verified.
+ * @var bl_verify_job_t::isRollbackCheckRequired
+ * Indicates that the anti-rollback check is applied to the result, as done by @ref BL_ImageVerify.
+ * @var bl_verify_job_t::result
+ * Contains the result of the verification, @ref BL_BUSY while it is running.
+ */
+typedef struct
+{
+    uint32_t address;
+    uint32_t endAddress;
+    uint32_t crc;
+    uint32_t hashAddress;
+    uint8_t installLocationId;
+    bool isRollbackCheckRequired;
+    bl_result_t result;
+} bl_verify_job_t;
+
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief State of the verification that is calculated in steps.
+ */
+static bl_verify_job_t verifyJob = {0U, 0U, 0U, 0U, 0U, false, BL_FAIL};
+
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief Starts the verification of the given image space.
+ *
+ * A result already held by the image space descriptor is returned right away.
+ *
+ * @param [in] installLocationId - Identifier for the application image space
+ * @return @ref BL_BUSY - The hash range must be calculated by @ref BL_ImageVerifyStep \n
+ * @return Result of the verification otherwise \n
+ */
+static bl_result_t VerifyJobStart(uint8_t installLocationId);
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief Applies the anti-rollback check to the result of the staging area verification.
+ *
+ * @param [in] verificationStatus - Result of the staging area verification
+ * @return Result reported to the host for the staging area \n
+ */
+static bl_result_t RollbackCheckApply(bl_result_t verificationStatus);
 
 
 static void CRC32_Calculate(uint32_t startAddress, uint32_t length, uint32_t *crc)
@@ -85,13 +141,11 @@ static void CRC32_Calculate(uint32_t startAddress, uint32_t length, uint32_t *cr
     *crc = workCrc;
 }
 
-static bl_result_t CRC32_Validate(uint32_t startAddress, uint32_t length, uint32_t refAddress)
+static bl_result_t CRC32_Validate(uint32_t crc, uint32_t refAddress)
 {
     bl_result_t result = BL_FAIL;
-    uint32_t crc = 0xFFFFFFFF;
     uint32_t refCRC = 0x00000000U;
 
-    CRC32_Calculate(startAddress, length, &crc);
     (void)NVMCTRL_Read(&refCRC, 4U, refAddress);
 
     if ((refCRC == 0U) || (crc == 0U) || (refCRC == 0xFFFFFFFFU) || (crc == 0xFFFFFFFFU)) 
@@ -113,28 +167,85 @@ static bl_result_t CRC32_Validate(uint32_t startAddress, uint32_t length, uint32
 bl_result_t BL_ImageVerify(void)
 {
     // The staging area must always be validated when the FTP is connected to the core.
-    // Verify the staging area
-    bl_result_t verificationStatus = BL_ImageVerifyById(BL_STAGING_IMAGE_ID);
+    // Calculate the whole hash range in a single step
+    bl_result_t verificationStatus = BL_ImageVerifyStart();
 
-    // The protocol calls for having Anti-Rollback notify the host of the failure in versions at the time of the update
-#if (BL_ANTI_ROLLBACK_ENABLED == 1)
-    if (BL_PASS == verificationStatus)
+    while (BL_BUSY == verificationStatus)
     {
-        // Perform rollback check on the data held at the staging area
-        if (true == BL_ApplicationRollbackCheck((uint8_t) BL_STAGING_IMAGE_ID))
+        verificationStatus = BL_ImageVerifyStep((uint32_t)BL_IMAGE_PARTITION_SIZE);
+    }
+
+    return verificationStatus;
+}
+
+bl_result_t BL_ImageVerifyStart(void)
+{
+    bl_result_t verificationStatus = VerifyJobStart(BL_STAGING_IMAGE_ID);
+
+    verifyJob.isRollbackCheckRequired = true;
+
+    if (BL_BUSY != verificationStatus)
+    {
+        verificationStatus = RollbackCheckApply(verificationStatus);
+        verifyJob.result = verificationStatus;
+    }
+
+    return verificationStatus;
+}
+
+bl_result_t BL_ImageVerifyStep(uint32_t byteBudget)
+{
+    if (BL_BUSY == verifyJob.result)
+    {
+        // The DSU works on whole 32-bit words
+        uint32_t length = (byteBudget < 4U) ? 4U : (byteBudget - (byteBudget % 4U));
+
+        if (length > (verifyJob.endAddress - verifyJob.address))
         {
-            verificationStatus = BL_PASS;
+            length = verifyJob.endAddress - verifyJob.address;
         }
-        else
+
+        // The CRC of the previous chunks is the seed of the next one
+        CRC32_Calculate(verifyJob.address, length, &verifyJob.crc);
+        verifyJob.address += length;
+
+        if (verifyJob.address >= verifyJob.endAddress)
         {
-            verificationStatus = BL_ERROR_ROLLBACK_FAILURE;
+            bl_result_t verificationStatus = CRC32_Validate(verifyJob.crc, verifyJob.hashAddress);
+
+            BL_SlotVerificationResultSet(verifyJob.installLocationId, verificationStatus);
+
+            if (true == verifyJob.isRollbackCheckRequired)
+            {
+                verificationStatus = RollbackCheckApply(verificationStatus);
+            }
+            verifyJob.result = verificationStatus;
         }
     }
-#endif
-    return verificationStatus;
+
+    return verifyJob.result;
+}
+
+bl_result_t BL_ImageVerifyResultGet(void)
+{
+    return verifyJob.result;
 }
 
 bl_result_t BL_ImageVerifyById(uint8_t installLocationId)
+{
+    bl_result_t result = VerifyJobStart(installLocationId);
+
+    verifyJob.isRollbackCheckRequired = false;
+
+    while (BL_BUSY == result)
+    {
+        result = BL_ImageVerifyStep((uint32_t)BL_IMAGE_PARTITION_SIZE);
+    }
+
+    return result;
+}
+
+static bl_result_t VerifyJobStart(uint8_t installLocationId)
 {
     bl_result_t result = BL_ERROR_VERIFICATION_FAIL;
     bl_footer_data_t footerData = {
@@ -146,30 +257,75 @@ bl_result_t BL_ImageVerifyById(uint8_t installLocationId)
         .verificationData = 0U
 #endif
     };
-    
-    (void) BL_ApplicationFooterRead(installLocationId, &footerData);
-
-    uint32_t footerStartAddress = BL_ApplicationFooterStartAddressGet(installLocationId);
-
-    uint32_t hashLength = ((footerData.verificationEndAddress + 1U) - footerData.verificationStartAddress);
+    const bl_slot_descriptor_t * slotDescriptor = BL_SlotDescriptorGet(installLocationId);
 
-    if ((0U == footerData.verificationStartAddress) ||
-        (0U == hashLength) ||
-        (installLocationId > (BL_APPLICATION_IMAGE_COUNT - 1U))
-    )
+    if (slotDescriptor == NULL)
     {
         result = BL_ERROR_INVALID_ARGUMENTS;
     }
+    else if (true == slotDescriptor->isVerified)
+    {
+        // The image space has not been written since it was verified, reuse the result
+        result = slotDescriptor->verificationResult;
+    }
     else
     {
-        if (installLocationId != (uint8_t)IMAGE_0)
+        (void) BL_ApplicationFooterRead(installLocationId, &footerData);
+
+        uint32_t footerStartAddress = BL_ApplicationFooterStartAddressGet(installLocationId);
+
+        uint32_t hashLength = ((footerData.verificationEndAddress + 1U) - footerData.verificationStartAddress);
+
+        if ((0U == footerData.verificationStartAddress) ||
+            (0U == hashLength)
+        )
         {
-            // Recalculating start address to verify the staging area 
-            uint32_t offset = (uint32_t)((uint32_t)installLocationId & 0x00FFU) * (uint32_t) BL_IMAGE_PARTITION_SIZE;
-            // This mathematical relation will be consistent as long as the execution image starts at BL_APPLICATION_START_ADDRESS and the sizes of the image areas are the same
-            footerData.verificationStartAddress += offset;
+            result = BL_ERROR_INVALID_ARGUMENTS;
+            BL_SlotVerificationResultSet(installLocationId, result);
+        }
+        else
+        {
+            if (installLocationId != (uint8_t)IMAGE_0)
+            {
+                // Recalculating start address to verify the staging area
+                uint32_t offset = (uint32_t)((uint32_t)installLocationId & 0x00FFU) * (uint32_t) BL_IMAGE_PARTITION_SIZE;
+                // This mathematical relation will be consistent as long as the execution image starts at BL_APPLICATION_START_ADDRESS and the sizes of the image areas are the same
+                footerData.verificationStartAddress += offset;
+            }
+
+            // Set up the hash range, the CRC is calculated by the following steps
+            verifyJob.address = footerData.verificationStartAddress;
+            verifyJob.endAddress = footerData.verificationStartAddress + hashLength;
+            verifyJob.crc = 0xFFFFFFFFU;
+            verifyJob.hashAddress = footerStartAddress + (uint32_t)HASH_DATA_OFFSET;
+            verifyJob.installLocationId = installLocationId;
+            result = BL_BUSY;
         }
-        result = CRC32_Validate((uint32_t) footerData.verificationStartAddress, hashLength, footerStartAddress + (uint32_t)HASH_DATA_OFFSET);
     }
+
+    verifyJob.result = result;
+
     return result;
+}
+
+static bl_result_t RollbackCheckApply(bl_result_t verificationStatus)
+{
+    bl_result_t rollbackStatus = verificationStatus;
+
+    // The protocol calls for having Anti-Rollback notify the host of the failure in versions at the time of the update
+#if (BL_ANTI_ROLLBACK_ENABLED == 1)
+    if (BL_PASS == verificationStatus)
+    {
+        // Perform rollback check on the data held at the staging area
+        if (true == BL_ApplicationRollbackCheck((uint8_t) BL_STAGING_IMAGE_ID))
+        {
+            rollbackStatus = BL_PASS;
+        }
+        else
+        {
+            rollbackStatus = BL_ERROR_ROLLBACK_FAILURE;
+        }
+    }
+#endif
+    return rollbackStatus;
 }
\ No newline at end of file
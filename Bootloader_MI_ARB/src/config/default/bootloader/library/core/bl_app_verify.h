@@ -49,6 +49,36 @@
  */
 bl_result_t BL_ImageVerify(void);
 
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief Starts a verification of the staging area image memory space that is calculated in steps.
+ *
+ * The footer is checked right away. The hash range is then added to the CRC by @ref BL_ImageVerifyStep,
+ * so the caller can keep servicing the communication between the steps.
+ * @param None.
+ * @return @ref BL_BUSY - The hash range must be calculated by @ref BL_ImageVerifyStep \n
+ * @return @ref BL_PASS - Bootloader verified the application image with no errors \n
+ * @return @ref BL_ERROR_VERIFICATION_FAIL - Bootloader image verification failed \n
+ * @return @ref BL_FAIL - Bootloader encountered an error and failed unexpectedly \n
+ */
+bl_result_t BL_ImageVerifyStart(void);
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief Adds the next chunk of the hash range to the verification started by @ref BL_ImageVerifyStart.
+ * @param [in] byteBudget - Maximum number of bytes calculated by this call, rounded down to whole 32-bit words
+ * @return @ref BL_BUSY - Part of the hash range is still left \n
+ * @return Result of the verification once the hash range is complete, see @ref BL_ImageVerify \n
+ */
+bl_result_t BL_ImageVerifyStep(uint32_t byteBudget);
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief Returns the state of the verification started by @ref BL_ImageVerifyStart.
+ * @param None.
+ * @return @ref BL_BUSY - The verification is still running \n
+ * @return Result of the last verification otherwise, see @ref BL_ImageVerify \n
+ */
+bl_result_t BL_ImageVerifyResultGet(void);
+
 /**
  * @ingroup mdfu_client_32bit
  * @brief Performs a verification sequence on the given application image memory space.
@@ -48,7 +48,7 @@
  * @brief Represents the minor version of the image format that is
  * understood by the bootloader core. \n
  */
-#define BL_IMAGE_FORMAT_MINOR_VERSION (0x0)
+#define BL_IMAGE_FORMAT_MINOR_VERSION (0x3)
 /**
  * @ingroup mdfu_client_32bit
  * @def BL_IMAGE_FORMAT_PATCH_VERSION
@@ -124,6 +124,27 @@
  * @brief 32-bit pattern used to indicate that a software entry has been requested.
  */
 #define BL_SOFTWARE_ENTRY_PATTERN (0x5048434DU)
+/**
+ * @ingroup mdfu_client_32bit
+ * @def BL_BOOT_TRACE_ENABLED
+ * @brief Enables the boot time record. When set, the bootloader stores a SysTick time stamp at the end of each boot phase.
+ */
+#define BL_BOOT_TRACE_ENABLED (1)
+/**
+ * @ingroup mdfu_client_32bit
+ * @def BL_BOOT_TRACE_START
+ * @brief Start address of the boot time record.
+ *
+ * @note The record follows the software entry pattern in the 48 bytes of RAM that the bootloader linker script
+ * keeps out of its own RAM. The application must read the record before it uses this area.
+ */
+#define BL_BOOT_TRACE_START (0x20000010)
+/**
+ * @ingroup mdfu_client_32bit
+ * @def BL_BOOT_TRACE_KEY
+ * @brief 32-bit pattern that starts a boot time record written in the current boot.
+ */
+#define BL_BOOT_TRACE_KEY (0x54544C42U)
 /**
  * @ingroup mdfu_client_32bit
  * @def HASH_DATA_SIZE
@@ -214,7 +235,11 @@ typedef struct
  * @ingroup mdfu_client_32bit
  * @def ASM_VECTOR
  * @brief Macro defined to jump the program to the application reset location.
+ *
+ * It can be defined by the build instead, for example by a host build of the library that has no application to start.
  */
+#ifndef ASM_VECTOR
 #define ASM_VECTOR              asm("bx %0"::"r" (reset_vector))
+#endif
 
 #endif // BL_BOOT_CONFIG_H
\ No newline at end of file
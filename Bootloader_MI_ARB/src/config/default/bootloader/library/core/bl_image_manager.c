@@ -36,10 +36,25 @@
  * U or u.
  */
  
+#include <stddef.h>
 #include <string.h>
 #include "bl_image_manager.h"
 #include "bl_config.h"
 
+/**
+ * @ingroup bl_image_manager
+ * @brief Descriptors of the image spaces. The table is cleared at reset, so each boot starts from the Flash content.
+ */
+static bl_slot_descriptor_t slotDescriptors[BL_APPLICATION_IMAGE_COUNT];
+
+/**
+ * @ingroup bl_image_manager
+ * @brief Returns the descriptor of the image space with the footer data loaded from Flash when it is not held yet.
+ * @param [in] imageId - Identifier for the application image space
+ * @return Pointer to the descriptor of the image space
+ * @return NULL - The image ID is not configured
+ */
+static bl_slot_descriptor_t * SlotDescriptorLoad(uint8_t imageId);
 
 uint32_t BL_ApplicationStartAddressGet(uint8_t imageId)
 {
@@ -120,21 +135,12 @@ bool BL_ApplicationIsVersionValid(uint32_t imageVersion)
 
 bl_mem_result_t BL_ApplicationFooterRead(uint8_t appId, bl_footer_data_t * footerData)
 {
-    uint32_t footerAddressStart = BL_ApplicationFooterStartAddressGet(appId);
     bl_mem_result_t readResult = BL_MEM_FAIL;
 
-    bl_footer_data_t workFooterData = {
-        .applicationId = 0U,
-        .applicationVersion = 0U,
-        .verificationEndAddress = 0U,
-        .verificationStartAddress = 0U,
-        .verificationData = 0U
-    };
-    
-    bool nvmctrlReadResult = NVMCTRL_Read((uint32_t *) & workFooterData, sizeof(bl_footer_data_t), footerAddressStart);
-    
-    
-    if(nvmctrlReadResult == true)
+    // The footer is only read from Flash once, later calls get the copy held in the descriptor
+    const bl_slot_descriptor_t * slotDescriptor = SlotDescriptorLoad(appId);
+
+    if ((slotDescriptor != NULL) && (true == slotDescriptor->isFooterRead))
     {
         readResult = BL_MEM_PASS;
     }
@@ -145,11 +151,11 @@ bl_mem_result_t BL_ApplicationFooterRead(uint8_t appId, bl_footer_data_t * foote
 
     if (BL_MEM_PASS == readResult)
     {
-        footerData->applicationId = workFooterData.applicationId;
-        footerData->applicationVersion = workFooterData.applicationVersion;
-        footerData->verificationEndAddress = workFooterData.verificationEndAddress;
-        footerData->verificationStartAddress = workFooterData.verificationStartAddress;
-        footerData->verificationData = workFooterData.verificationData;
+        footerData->applicationId = slotDescriptor->footerData.applicationId;
+        footerData->applicationVersion = slotDescriptor->footerData.applicationVersion;
+        footerData->verificationEndAddress = slotDescriptor->footerData.verificationEndAddress;
+        footerData->verificationStartAddress = slotDescriptor->footerData.verificationStartAddress;
+        footerData->verificationData = slotDescriptor->footerData.verificationData;
     }
 
     return readResult;
@@ -192,3 +198,48 @@ bool BL_ApplicationRollbackCheck(uint8_t imageId)
 
     return isTargetVersionNewer;
 }
+
+static bl_slot_descriptor_t * SlotDescriptorLoad(uint8_t imageId)
+{
+    bl_slot_descriptor_t * slotDescriptor = NULL;
+
+    if (imageId < BL_APPLICATION_IMAGE_COUNT)
+    {
+        slotDescriptor = &slotDescriptors[imageId];
+
+        if (false == slotDescriptor->isFooterRead)
+        {
+            uint32_t footerAddressStart = BL_ApplicationFooterStartAddressGet(imageId);
+
+            slotDescriptor->isFooterRead = NVMCTRL_Read((uint32_t *) & slotDescriptor->footerData, sizeof(bl_footer_data_t), footerAddressStart);
+            slotDescriptor->footerReadCount++;
+        }
+    }
+
+    return slotDescriptor;
+}
+
+const bl_slot_descriptor_t * BL_SlotDescriptorGet(uint8_t imageId)
+{
+    return SlotDescriptorLoad(imageId);
+}
+
+void BL_SlotVerificationResultSet(uint8_t imageId, bl_result_t result)
+{
+    if (imageId < BL_APPLICATION_IMAGE_COUNT)
+    {
+        slotDescriptors[imageId].verificationResult = result;
+        slotDescriptors[imageId].isVerified = true;
+        slotDescriptors[imageId].verificationCount++;
+    }
+}
+
+void BL_SlotDescriptorInvalidate(uint8_t imageId)
+{
+    if (imageId < BL_APPLICATION_IMAGE_COUNT)
+    {
+        // The counters are kept so they still cover everything done since reset
+        slotDescriptors[imageId].isFooterRead = false;
+        slotDescriptors[imageId].isVerified = false;
+    }
+}
@@ -35,6 +35,35 @@
 #include "bl_config.h"
 #include "stdbool.h"
 #include "bl_memory.h"
+#include "bl_result_type.h"
+
+/**
+ * @ingroup bl_image_manager
+ * @struct bl_slot_descriptor_t
+ * @brief Holds what is known about an image space since reset, so the boot decision reads each footer
+ * and calculates each hash only once.
+ * @var bl_slot_descriptor_t::footerData
+ * Contains the footer data of the image space.
+ * @var bl_slot_descriptor_t::verificationResult
+ * Contains the result of the verification of the image space.
+ * @var bl_slot_descriptor_t::isFooterRead
+ * Indicates that footerData matches the footer stored in the image space.
+ * @var bl_slot_descriptor_t::isVerified
+ * Indicates that verificationResult matches the data stored in the image space.
+ * @var bl_slot_descriptor_t::footerReadCount
+ * Counts the footer reads from Flash since reset.
+ * @var bl_slot_descriptor_t::verificationCount
+ * Counts the hash calculations over the image space since reset.
+ */
+typedef struct
+{
+    bl_footer_data_t footerData;
+    bl_result_t verificationResult;
+    bool isFooterRead;
+    bool isVerified;
+    uint16_t footerReadCount;
+    uint16_t verificationCount;
+} bl_slot_descriptor_t;
 
 /**
 * @ingroup bl_image_manager
@@ -106,4 +135,32 @@ bl_mem_result_t BL_ApplicationFooterRead(uint8_t appId, bl_footer_data_t * foote
 */
 bool BL_ApplicationRollbackCheck(uint8_t imageId);
 
+/**
+* @ingroup bl_image_manager
+* @brief Retrieves the descriptor of the given image space. The footer is read from Flash the first time
+* the image space is requested after reset or after the image space has been written.
+* @param [in] imageId - Identifier for the application image space
+* @return Pointer to the descriptor of the image space
+* @return NULL - The image ID is not configured
+*/
+const bl_slot_descriptor_t * BL_SlotDescriptorGet(uint8_t imageId);
+
+/**
+* @ingroup bl_image_manager
+* @brief Stores the result of a verification performed over the given image space
+* @param [in] imageId - Identifier for the application image space
+* @param [in] result - Result of the verification
+* @return None
+*/
+void BL_SlotVerificationResultSet(uint8_t imageId, bl_result_t result);
+
+/**
+* @ingroup bl_image_manager
+* @brief Discards the footer data and the verification result held for the given image space.
+* Must be called whenever the image space is written.
+* @param [in] imageId - Identifier for the application image space
+* @return None
+*/
+void BL_SlotDescriptorInvalidate(uint8_t imageId);
+
 #endif	/* BL_IMAGE_MANAGER_H */
@@ -57,6 +57,34 @@
 /* SERCOM1 USART baud value for 115200 Hz baud rate */
 #define SERCOM1_USART_INT_BAUD_VALUE            (63019UL)
 
+/* SERCOM1 USART receive ring buffer */
+#define SERCOM1_USART_READ_BUFFER_SIZE      (512U)
+
+volatile static SERCOM_USART_RING_BUFFER_OBJECT sercom1USARTObj;
+
+static uint8_t SERCOM1_USART_ReadBuffer[SERCOM1_USART_READ_BUFFER_SIZE];
+
+/* SERCOM1 USART transmit ring buffer, drained by the data register empty interrupt */
+#define SERCOM1_USART_WRITE_BUFFER_SIZE     (128U)
+
+#define SERCOM1_USART_TX_INT_DISABLE()      SERCOM1_REGS->USART_INT.SERCOM_INTENCLR = (uint8_t)SERCOM_USART_INT_INTENCLR_DRE_Msk
+#define SERCOM1_USART_TX_INT_ENABLE()       SERCOM1_REGS->USART_INT.SERCOM_INTENSET = (uint8_t)SERCOM_USART_INT_INTENSET_DRE_Msk
+
+static uint8_t SERCOM1_USART_WriteBuffer[SERCOM1_USART_WRITE_BUFFER_SIZE];
+
+/* SERCOM1 USART flow control: RTS on PA18 follows the receive ring buffer, CTS on PA19 (PAD3) */
+#define SERCOM1_USART_RTS_PIN_MASK          ((uint32_t)1U << 18U)
+
+/* Free bytes left in the ring buffer when RTS holds off the host, room for what a USB bridge sends after RTS */
+#define SERCOM1_USART_RTS_STOP_LEVEL        (64U)
+
+/* Free bytes in the ring buffer before RTS lets the host send again */
+#define SERCOM1_USART_RTS_RESUME_LEVEL      (128U)
+
+volatile static bool sercom1USARTIsFlowControlEnabled = false;
+
+volatile static bool sercom1USARTIsHostHeldOff = false;
+
 
 
 // *****************************************************************************
@@ -119,6 +147,21 @@ void SERCOM1_USART_Initialize( void )
         /* Do nothing */
     }
 
+    sercom1USARTObj.rdInIndex = 0U;
+    sercom1USARTObj.rdOutIndex = 0U;
+    sercom1USARTObj.rdBufferSize = SERCOM1_USART_READ_BUFFER_SIZE;
+    sercom1USARTObj.wrInIndex = 0U;
+    sercom1USARTObj.wrOutIndex = 0U;
+    sercom1USARTObj.wrBufferSize = SERCOM1_USART_WRITE_BUFFER_SIZE;
+    sercom1USARTObj.errorStatus = USART_ERROR_NONE;
+
+    /* TXPO above has no RTS and CTS, SERCOM1_USART_FlowControlEnable() turns them on again */
+    sercom1USARTIsFlowControlEnabled = false;
+    sercom1USARTIsHostHeldOff = false;
+
+    /* Enable Receive Complete and Error interrupts, the Data Register Empty interrupt is enabled while bytes are queued */
+    SERCOM1_USART_TX_INT_DISABLE();
+    SERCOM1_REGS->USART_INT.SERCOM_INTENSET = (uint8_t)(SERCOM_USART_INT_INTENSET_ERROR_Msk | SERCOM_USART_INT_INTENSET_RXC_Msk);
 
     /* Enable the UART after the configurations */
     SERCOM1_REGS->USART_INT.SERCOM_CTRLA |= SERCOM_USART_INT_CTRLA_ENABLE_Msk;
@@ -218,15 +261,50 @@ bool SERCOM1_USART_SerialSetup( USART_SERIAL_SETUP * serialSetup, uint32_t clkFr
     return setupStatus;
 }
 
-USART_ERROR SERCOM1_USART_ErrorGet( void )
+void SERCOM1_USART_FlowControlEnable( void )
 {
-    USART_ERROR errorStatus = (USART_ERROR) (SERCOM1_REGS->USART_INT.SERCOM_STATUS & (uint16_t)(SERCOM_USART_INT_STATUS_PERR_Msk | SERCOM_USART_INT_STATUS_FERR_Msk | SERCOM_USART_INT_STATUS_BUFOVF_Msk ));
+    /* Disable the USART before configurations */
+    SERCOM1_REGS->USART_INT.SERCOM_CTRLA &= ~SERCOM_USART_INT_CTRLA_ENABLE_Msk;
 
-    if(errorStatus != USART_ERROR_NONE)
+    /* Wait for sync */
+    while((SERCOM1_REGS->USART_INT.SERCOM_SYNCBUSY) != 0U)
     {
-        SERCOM1_USART_ErrorClear();
+        /* Do nothing */
     }
 
+    /* TxD on PAD0, RTS on PAD2 and CTS on PAD3. PAD2 is not routed to a pin: the hardware RTS only covers
+     * the two byte receive FIFO, so RTS is driven on PA18 from the level of the ring buffer instead */
+    SERCOM1_REGS->USART_INT.SERCOM_CTRLA = (SERCOM1_REGS->USART_INT.SERCOM_CTRLA & ~SERCOM_USART_INT_CTRLA_TXPO_Msk) | SERCOM_USART_INT_CTRLA_TXPO(0x2UL);
+
+    /* RTS low lets the host send */
+    sercom1USARTIsHostHeldOff = false;
+    PORT_REGS->GROUP[0].PORT_OUTCLR = SERCOM1_USART_RTS_PIN_MASK;
+    PORT_REGS->GROUP[0].PORT_DIRSET = SERCOM1_USART_RTS_PIN_MASK;
+
+    /* CTS is pulled low, so a host without RTS does not stop the transmitter */
+    PORT_REGS->GROUP[0].PORT_OUTCLR = PORT_PA19C_SERCOM1_PAD3;
+    PORT_REGS->GROUP[0].PORT_PINCFG[PIN_PA19C_SERCOM1_PAD3] = (uint8_t)(PORT_PINCFG_PMUXEN_Msk | PORT_PINCFG_PULLEN_Msk);
+    PORT_REGS->GROUP[0].PORT_PMUX[PIN_PA19C_SERCOM1_PAD3 >> 1U] = (uint8_t)((PORT_REGS->GROUP[0].PORT_PMUX[PIN_PA19C_SERCOM1_PAD3 >> 1U] & (uint8_t)~PORT_PMUX_PMUXO_Msk) | PORT_PMUX_PMUXO(MUX_PA19C_SERCOM1_PAD3));
+
+    sercom1USARTIsFlowControlEnabled = true;
+
+    /* Enable the USART after the configurations */
+    SERCOM1_REGS->USART_INT.SERCOM_CTRLA |= SERCOM_USART_INT_CTRLA_ENABLE_Msk;
+
+    /* Wait for sync */
+    while((SERCOM1_REGS->USART_INT.SERCOM_SYNCBUSY) != 0U)
+    {
+        /* Do nothing */
+    }
+}
+
+USART_ERROR SERCOM1_USART_ErrorGet( void )
+{
+    USART_ERROR errorStatus = sercom1USARTObj.errorStatus;
+
+    /* Clear the error status saved by the receive interrupt */
+    sercom1USARTObj.errorStatus = USART_ERROR_NONE;
+
     return errorStatus;
 }
 
@@ -281,45 +359,110 @@ void SERCOM1_USART_TransmitterDisable( void )
     }
 }
 
-bool SERCOM1_USART_Write( void *buffer, const size_t size )
+static inline bool SERCOM1_USART_TxPullByte( uint8_t* pWrByte )
+{
+    bool isSuccess = false;
+    uint32_t wrOutIndex = sercom1USARTObj.wrOutIndex;
+    uint32_t wrInIndex = sercom1USARTObj.wrInIndex;
+
+    if (wrOutIndex != wrInIndex)
+    {
+        *pWrByte = SERCOM1_USART_WriteBuffer[wrOutIndex];
+        wrOutIndex++;
+
+        if (wrOutIndex >= sercom1USARTObj.wrBufferSize)
+        {
+            wrOutIndex = 0U;
+        }
+
+        sercom1USARTObj.wrOutIndex = wrOutIndex;
+        isSuccess = true;
+    }
+
+    return isSuccess;
+}
+
+static inline bool SERCOM1_USART_TxPushByte( uint8_t wrByte )
+{
+    uint32_t tempInIndex;
+    bool isSuccess = false;
+
+    tempInIndex = sercom1USARTObj.wrInIndex + 1U;
+
+    if (tempInIndex >= sercom1USARTObj.wrBufferSize)
+    {
+        tempInIndex = 0U;
+    }
+
+    if (tempInIndex != sercom1USARTObj.wrOutIndex)
+    {
+        uint32_t wrInIdx = sercom1USARTObj.wrInIndex;
+
+        SERCOM1_USART_WriteBuffer[wrInIdx] = wrByte;
+        sercom1USARTObj.wrInIndex = tempInIndex;
+        isSuccess = true;
+    }
+    else
+    {
+        /* Queue is full. The caller tries again once the interrupt has made room. */
+    }
+
+    return isSuccess;
+}
+
+size_t SERCOM1_USART_Write( uint8_t* pWrBuffer, const size_t size )
 {
-    bool writeStatus      = false;
-    uint8_t *pu8Data      = (uint8_t*)buffer;
-    uint16_t *pu16Data    = (uint16_t*)buffer;
-    uint32_t u32Index     = 0U;
+    size_t nBytesWritten = 0U;
 
-    if(buffer != NULL)
+    while (nBytesWritten < size)
     {
-        /* Blocks while buffer is being transferred */
-        while(u32Index < size)
+        if (SERCOM1_USART_TxPushByte(pWrBuffer[nBytesWritten]) == false)
         {
-            /* Check if USART is ready for new data */
-            while((SERCOM1_REGS->USART_INT.SERCOM_INTFLAG & (uint8_t)SERCOM_USART_INT_INTFLAG_DRE_Msk) == 0U)
-            {
-                /* Do nothing */
-            }
-
-            /* Write data to USART module */
-            if (((SERCOM1_REGS->USART_INT.SERCOM_CTRLB & SERCOM_USART_INT_CTRLB_CHSIZE_Msk) >> SERCOM_USART_INT_CTRLB_CHSIZE_Pos) != 0x01U)
-            {
-                /* 8-bit mode */
-                SERCOM1_REGS->USART_INT.SERCOM_DATA = pu8Data[u32Index];
-            }
-            else
-            {
-                /* 9-bit mode */
-                SERCOM1_REGS->USART_INT.SERCOM_DATA = pu16Data[u32Index];
-            }
-
-            /* Increment index */
-            u32Index++;
+            break;
         }
-        writeStatus = true;
+        nBytesWritten++;
     }
 
-    return writeStatus;
+    /* The interrupt starts sending right away and disables itself once the ring buffer is empty */
+    if (SERCOM1_USART_WriteCountGet() > 0U)
+    {
+        SERCOM1_USART_TX_INT_ENABLE();
+    }
+
+    return nBytesWritten;
 }
 
+size_t SERCOM1_USART_WriteCountGet( void )
+{
+    size_t nPendingTxBytes;
+    uint32_t wrInIndex;
+    uint32_t wrOutIndex;
+
+    /* Take a snapshot of indices to avoid processing in critical section */
+    wrInIndex = sercom1USARTObj.wrInIndex;
+    wrOutIndex = sercom1USARTObj.wrOutIndex;
+
+    if ( wrInIndex >= wrOutIndex)
+    {
+        nPendingTxBytes = wrInIndex - wrOutIndex;
+    }
+    else
+    {
+        nPendingTxBytes = (sercom1USARTObj.wrBufferSize - wrOutIndex) + wrInIndex;
+    }
+
+    return nPendingTxBytes;
+}
+
+size_t SERCOM1_USART_WriteFreeBufferCountGet( void )
+{
+    return (sercom1USARTObj.wrBufferSize - 1U) - SERCOM1_USART_WriteCountGet();
+}
+
+size_t SERCOM1_USART_WriteBufferSizeGet( void )
+{
+    return (sercom1USARTObj.wrBufferSize - 1U);
+}
 
 bool SERCOM1_USART_TransmitterIsReady( void )
 {
@@ -378,74 +521,186 @@ void SERCOM1_USART_ReceiverDisable( void )
     }
 }
 
-bool SERCOM1_USART_Read( void *buffer, const size_t size )
+size_t SERCOM1_USART_Read( uint8_t* pRdBuffer, const size_t size )
 {
-    bool readStatus         = false;
-    uint8_t* pu8Data        = (uint8_t*)buffer;
-    uint16_t *pu16Data      = (uint16_t*)buffer;
-    uint32_t u32Index       = 0U;
-    USART_ERROR errorStatus = USART_ERROR_NONE;
+    size_t nBytesRead = 0U;
+    uint32_t rdOutIndex;
+    uint32_t rdInIndex;
 
-    if(buffer != NULL)
-    {
+    /* Take a snapshot of indices to avoid creation of critical section */
+    rdOutIndex = sercom1USARTObj.rdOutIndex;
+    rdInIndex = sercom1USARTObj.rdInIndex;
 
-        /* Clear error flags and flush out error data that may have been received when no active request was pending */
-        SERCOM1_USART_ErrorClear();
+    while((nBytesRead < size) && (rdOutIndex != rdInIndex))
+    {
+        pRdBuffer[nBytesRead] = SERCOM1_USART_ReadBuffer[rdOutIndex];
+        nBytesRead++;
+        rdOutIndex++;
 
-        while(u32Index < size)
+        if (rdOutIndex >= sercom1USARTObj.rdBufferSize)
         {
-            /* Check if USART has new data */
-            while((SERCOM1_REGS->USART_INT.SERCOM_INTFLAG & SERCOM_USART_INT_INTFLAG_RXC_Msk) == 0U)
-            {
-                /* Do nothing */
-            }
-
-            errorStatus = (USART_ERROR) (SERCOM1_REGS->USART_INT.SERCOM_STATUS & (uint16_t)(SERCOM_USART_INT_STATUS_PERR_Msk | SERCOM_USART_INT_STATUS_FERR_Msk | SERCOM_USART_INT_STATUS_BUFOVF_Msk));
-
-            if(errorStatus != USART_ERROR_NONE)
-            {
-                break;
-            }
-
-            if (((SERCOM1_REGS->USART_INT.SERCOM_CTRLB & SERCOM_USART_INT_CTRLB_CHSIZE_Msk) >> SERCOM_USART_INT_CTRLB_CHSIZE_Pos) != 0x01U)
-            {
-                /* 8-bit mode */
-                pu8Data[u32Index] = (uint8_t)SERCOM1_REGS->USART_INT.SERCOM_DATA;
-            }
-            else
-            {
-                /* 9-bit mode */
-                pu16Data[u32Index] = (uint16_t)SERCOM1_REGS->USART_INT.SERCOM_DATA;
-            }
-
-            /* Increment index */
-            u32Index++;
+            rdOutIndex = 0U;
         }
+    }
+
+    sercom1USARTObj.rdOutIndex = rdOutIndex;
+
+    /* Let the host send again once the ring buffer has room */
+    if ((sercom1USARTIsHostHeldOff == true) && (SERCOM1_USART_ReadFreeBufferCountGet() >= SERCOM1_USART_RTS_RESUME_LEVEL))
+    {
+        sercom1USARTIsHostHeldOff = false;
+        PORT_REGS->GROUP[0].PORT_OUTCLR = SERCOM1_USART_RTS_PIN_MASK;
+    }
+
+    return nBytesRead;
+}
+
+size_t SERCOM1_USART_ReadCountGet( void )
+{
+    size_t nUnreadBytesAvailable;
+    uint32_t rdInIndex;
+    uint32_t rdOutIndex;
+
+    /* Take a snapshot of indices to avoid processing in critical section */
+    rdInIndex = sercom1USARTObj.rdInIndex;
+    rdOutIndex = sercom1USARTObj.rdOutIndex;
+
+    if ( rdInIndex >=  rdOutIndex)
+    {
+        nUnreadBytesAvailable =  rdInIndex - rdOutIndex;
+    }
+    else
+    {
+        nUnreadBytesAvailable =  (sercom1USARTObj.rdBufferSize -  rdOutIndex) + rdInIndex;
+    }
+
+    return nUnreadBytesAvailable;
+}
+
+size_t SERCOM1_USART_ReadFreeBufferCountGet( void )
+{
+    return (sercom1USARTObj.rdBufferSize - 1U) - SERCOM1_USART_ReadCountGet();
+}
+
+size_t SERCOM1_USART_ReadBufferSizeGet( void )
+{
+    return (sercom1USARTObj.rdBufferSize - 1U);
+}
+
+static inline bool SERCOM1_USART_RxPushByte( uint8_t rdByte )
+{
+    uint32_t tempInIndex;
+    bool isSuccess = false;
+
+    tempInIndex = sercom1USARTObj.rdInIndex + 1U;
+
+    if (tempInIndex >= sercom1USARTObj.rdBufferSize)
+    {
+        tempInIndex = 0U;
+    }
+
+    if (tempInIndex != sercom1USARTObj.rdOutIndex)
+    {
+        uint32_t rdInIdx = sercom1USARTObj.rdInIndex;
 
-        if(size == u32Index)
+        SERCOM1_USART_ReadBuffer[rdInIdx] = rdByte;
+        sercom1USARTObj.rdInIndex = tempInIndex;
+        isSuccess = true;
+    }
+    else
+    {
+        /* Queue is full. Data will be lost. */
+    }
+
+    return isSuccess;
+}
+
+static void SERCOM1_USART_ISR_ERR_Handler( void )
+{
+    USART_ERROR errorStatus;
+
+    errorStatus = (USART_ERROR) (SERCOM1_REGS->USART_INT.SERCOM_STATUS & (uint16_t)(SERCOM_USART_INT_STATUS_PERR_Msk | SERCOM_USART_INT_STATUS_FERR_Msk | SERCOM_USART_INT_STATUS_BUFOVF_Msk));
+
+    if(errorStatus != USART_ERROR_NONE)
+    {
+        /* Save the error so that it can be reported when application calls the SERCOM1_USART_ErrorGet() API */
+        sercom1USARTObj.errorStatus = errorStatus;
+
+        /* Clear the error flags and flush out the error bytes */
+        SERCOM1_USART_ErrorClear();
+    }
+}
+
+static void SERCOM1_USART_ISR_RX_Handler( void )
+{
+    /* Keep reading until there is a character available in the RX FIFO */
+    while((SERCOM1_REGS->USART_INT.SERCOM_INTFLAG & (uint8_t)SERCOM_USART_INT_INTFLAG_RXC_Msk) == (uint8_t)SERCOM_USART_INT_INTFLAG_RXC_Msk)
+    {
+        if (SERCOM1_USART_RxPushByte( (uint8_t)SERCOM1_REGS->USART_INT.SERCOM_DATA ) == false)
         {
-            readStatus = true;
+            /* Report the lost byte as an overflow so the frame in progress is not trusted */
+            sercom1USARTObj.errorStatus |= (USART_ERROR)SERCOM_USART_INT_STATUS_BUFOVF_Msk;
         }
     }
 
-    return readStatus;
+    /* Hold off the host while the ring buffer is nearly full */
+    if ((sercom1USARTIsFlowControlEnabled == true) && (sercom1USARTIsHostHeldOff == false) && (SERCOM1_USART_ReadFreeBufferCountGet() <= SERCOM1_USART_RTS_STOP_LEVEL))
+    {
+        sercom1USARTIsHostHeldOff = true;
+        PORT_REGS->GROUP[0].PORT_OUTSET = SERCOM1_USART_RTS_PIN_MASK;
+    }
 }
 
-bool SERCOM1_USART_ReceiverIsReady( void )
+static void SERCOM1_USART_ISR_TX_Handler( void )
 {
-    bool receiverStatus = false;
+    uint8_t wrByte;
 
-    if ((SERCOM1_REGS->USART_INT.SERCOM_INTFLAG & SERCOM_USART_INT_INTFLAG_RXC_Msk) == SERCOM_USART_INT_INTFLAG_RXC_Msk)
+    /* Keep writing to the data register as long as it is empty */
+    while((SERCOM1_REGS->USART_INT.SERCOM_INTFLAG & (uint8_t)SERCOM_USART_INT_INTFLAG_DRE_Msk) == (uint8_t)SERCOM_USART_INT_INTFLAG_DRE_Msk)
     {
-        receiverStatus = true;
+        if (SERCOM1_USART_TxPullByte(&wrByte) == true)
+        {
+            SERCOM1_REGS->USART_INT.SERCOM_DATA = wrByte;
+        }
+        else
+        {
+            /* Nothing to transmit. Disable the data register empty interrupt. */
+            SERCOM1_USART_TX_INT_DISABLE();
+            break;
+        }
     }
-
-    return receiverStatus;
 }
 
-int SERCOM1_USART_ReadByte( void )
+void __attribute__((used)) SERCOM1_USART_InterruptHandler( void )
 {
-    return (int)SERCOM1_REGS->USART_INT.SERCOM_DATA;
+    bool testCondition;
+
+    if(SERCOM1_REGS->USART_INT.SERCOM_INTENSET != 0U)
+    {
+        /* Checks for error flag */
+        testCondition = ((SERCOM1_REGS->USART_INT.SERCOM_INTFLAG & (uint8_t)SERCOM_USART_INT_INTFLAG_ERROR_Msk) == (uint8_t)SERCOM_USART_INT_INTFLAG_ERROR_Msk);
+        testCondition = ((SERCOM1_REGS->USART_INT.SERCOM_INTENSET & (uint8_t)SERCOM_USART_INT_INTENSET_ERROR_Msk) == (uint8_t)SERCOM_USART_INT_INTENSET_ERROR_Msk) && testCondition;
+        if(testCondition)
+        {
+            SERCOM1_USART_ISR_ERR_Handler();
+        }
+
+        /* Checks for receive complete empty flag */
+        testCondition = ((SERCOM1_REGS->USART_INT.SERCOM_INTFLAG & (uint8_t)SERCOM_USART_INT_INTFLAG_RXC_Msk) == (uint8_t)SERCOM_USART_INT_INTFLAG_RXC_Msk);
+        testCondition = ((SERCOM1_REGS->USART_INT.SERCOM_INTENSET & (uint8_t)SERCOM_USART_INT_INTENSET_RXC_Msk) == (uint8_t)SERCOM_USART_INT_INTENSET_RXC_Msk) && testCondition;
+        if(testCondition)
+        {
+            SERCOM1_USART_ISR_RX_Handler();
+        }
+
+        /* Checks for data register empty flag */
+        testCondition = ((SERCOM1_REGS->USART_INT.SERCOM_INTFLAG & (uint8_t)SERCOM_USART_INT_INTFLAG_DRE_Msk) == (uint8_t)SERCOM_USART_INT_INTFLAG_DRE_Msk);
+        testCondition = ((SERCOM1_REGS->USART_INT.SERCOM_INTENSET & (uint8_t)SERCOM_USART_INT_INTENSET_DRE_Msk) == (uint8_t)SERCOM_USART_INT_INTENSET_DRE_Msk) && testCondition;
+        if(testCondition)
+        {
+            SERCOM1_USART_ISR_TX_Handler();
+        }
+    }
 }
 
 
@@ -79,7 +79,13 @@ void SERCOM1_USART_TransmitterEnable( void );
 
 void SERCOM1_USART_TransmitterDisable( void );
 
-bool SERCOM1_USART_Write( void *buffer, const size_t size );
+size_t SERCOM1_USART_Write( uint8_t* pWrBuffer, const size_t size );
+
+size_t SERCOM1_USART_WriteCountGet( void );
+
+size_t SERCOM1_USART_WriteFreeBufferCountGet( void );
+
+size_t SERCOM1_USART_WriteBufferSizeGet( void );
 
 bool SERCOM1_USART_TransmitComplete( void );
 
@@ -93,16 +99,20 @@ void SERCOM1_USART_ReceiverEnable( void );
 
 void SERCOM1_USART_ReceiverDisable( void );
 
-bool SERCOM1_USART_Read( void *buffer, const size_t size );
+size_t SERCOM1_USART_Read( uint8_t* pRdBuffer, const size_t size );
 
-bool SERCOM1_USART_ReceiverIsReady( void );
+size_t SERCOM1_USART_ReadCountGet( void );
 
-int SERCOM1_USART_ReadByte( void );
+size_t SERCOM1_USART_ReadFreeBufferCountGet( void );
+
+size_t SERCOM1_USART_ReadBufferSizeGet( void );
 
 USART_ERROR SERCOM1_USART_ErrorGet( void );
 
 uint32_t SERCOM1_USART_FrequencyGet( void );
 
+void SERCOM1_USART_FlowControlEnable( void );
+
 
 // DOM-IGNORE-BEGIN
 #ifdef __cplusplus  // Provide C++ Compatibility
@@ -42,6 +42,9 @@ int main(void)
     /* Initialize all modules */
     SYS_Initialize(NULL);
 
+    // Time stamp each boot phase from here on in the boot time record
+    BL_BootTraceStart();
+
     BL_ExampleInitialize();
     
     while (true)
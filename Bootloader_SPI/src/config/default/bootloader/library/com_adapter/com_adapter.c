@@ -29,6 +29,7 @@
 #include "com_adapter.h"
 #include "peripheral/sercom/spi_slave/plib_sercom3_spi_slave.h"
 #include "peripheral/sercom/spi_slave/plib_sercom_spi_slave_common.h"
+#include "peripheral/dmac/plib_dmac.h"
 #include "peripheral/port/plib_port.h"
 #include <stdbool.h>
 
@@ -51,7 +52,7 @@
  * @def MAX_RESPONSE_DATA_FIELD
  * Holds the maximum size of a response.
  */
-#define MAX_RESPONSE_DATA_FIELD (25U)
+#define MAX_RESPONSE_DATA_FIELD (30U)
 
 /**
  * @ingroup com_adapter_spi
@@ -67,6 +68,20 @@
  */
 #define LENGTH_PACKET_SIZE (SOP_SEQUENCE_LENGTH + LENGTH_FIELD_SIZE + FRAME_CHECK_SIZE)
 
+/**
+ * @ingroup com_adapter_spi
+ * @def RECEIVE_CHANNEL
+ * DMAC channel that moves the bytes written by the host out of the SPI data register.
+ */
+#define RECEIVE_CHANNEL (DMAC_CHANNEL_0)
+
+/**
+ * @ingroup com_adapter_spi
+ * @def SEND_CHANNEL
+ * DMAC channel that moves the bytes read by the host into the SPI data register.
+ */
+#define SEND_CHANNEL (DMAC_CHANNEL_1)
+
 /* cppcheck-suppress misra-c2012-2.3 */
 typedef enum
 { /* cppcheck-suppress misra-c2012-2.4 */
@@ -78,8 +93,7 @@ typedef enum
 {
     NO_ACTION = 0x00,
     SEND_LENGTH,
-    SEND_RESPONSE,
-    READ_COMMAND
+    SEND_RESPONSE
 } com_adapter_state_t;
 
 static uint8_t sendBuffer[LENGTH_PACKET_SIZE + RESPONSE_PACKET_SIZE];
@@ -87,197 +101,192 @@ static uint16_t maxBufferLength = 0U;
 static uint16_t calculatedFrameCheck = 0x0000U;
 static uint16_t sendLength = 0U;
 static com_adapter_state_t comState = NO_ACTION;
+static uint8_t hostCommandCode = 0U;
+static bool isReceiveArmed = false;
+static bool isSendArmed = false;
 
+/**
+ * @ingroup com_adapter_spi
+ * @brief Receive descriptors for a host transaction.
+ *
+ * The first descriptor stores the host command code and links to the second descriptor
+ * which stores the rest of the transaction straight into the buffer provided by the FTP layer.
+ */
+static dmac_descriptor_registers_t __ALIGNED(8) receiveDescriptors[2];
+
+/**
+ * @ingroup com_adapter_spi
+ * @brief Calculate the frame check on the given data buffer
+ *
+ * The data is summed as little endian 16-bit words. Word aligned data is read 32 bits at a time,
+ * which keeps the check of a frame moved in by the DMAC short.
+ *
+ * @param [in] ftpData Data buffer to be used for the frame check calculation
+ * @param [in] bufferLength Length of data objects in the buffer
+ * @return Calculated frame check
+ */
 static uint16_t FrameCheckCalculate(const uint8_t * ftpData, uint16_t bufferLength);
 
+/**
+ * @ingroup com_adapter_spi
+ * @brief Arms the receive channel for the next host transaction.
+ * @param [in] receiveBufferPtr - Pointer to the buffer provided to SERCOM
+ * @return None
+ */
+static void ReceiveArm(uint8_t *receiveBufferPtr);
+
+/**
+ * @ingroup com_adapter_spi
+ * @brief Arms the send channel with the response stage expected by the host on the next read.
+ * @param None
+ * @return None
+ */
+static void SendArm(void);
+
+/**
+ * @ingroup com_adapter_spi
+ * @brief Handles a host transaction once the chip select has been released.
+ *
+ * This function stops both channels, works out how many bytes the host wrote and moves the
+ * response stages forward when the host has read from the client.
+ *
+ * @param [in] receiveBufferPtr - Pointer to the buffer provided to SERCOM
+ * @param [out] receiveIndexPtr - Pointer to the number of bytes successfully received by SERCOM
+ * @return @ref COM_PASS - A complete frame with a valid frame check has been received \n
+ * @return @ref COM_BUSY - The host read a stage of the response or polled before a response was ready \n
+ * @return @ref COM_BUFFER_ERROR - The host wrote more bytes than the buffer can hold \n
+ * @return @ref COM_TRANSPORT_FAILURE - The frame check of the received frame failed \n
+ * @return @ref COM_SEND_COMPLETE - The host has read the complete response \n
+ */
+static com_adapter_result_t TransferComplete(const uint8_t *receiveBufferPtr, uint16_t *receiveIndexPtr);
+
 static uint16_t FrameCheckCalculate(const uint8_t * ftpData, uint16_t bufferLength)
 {
-    uint16_t numBytesChecksummed = 0x0000U;
-    uint16_t checksum = 0x0000U;
+    uint32_t checksum = 0U;
+    uint16_t byteIndex = 0U;
 
-    while (numBytesChecksummed < (bufferLength))
+    // Aligned data is summed one 32-bit word, so two little endian halfwords, at a time
+    /* cppcheck-suppress misra-c2012-11.4 */
+    if ((((uint32_t)ftpData) % 4U) == 0U)
     {
-        if ((numBytesChecksummed % 2U) == 0U)
-        {
-            checksum += ((uint16_t) (ftpData[numBytesChecksummed]));
-        }
-        else
+        /* cppcheck-suppress misra-c2012-11.3 */
+        const uint32_t * wordPtr = (const uint32_t *) ftpData;
+
+        while (((uint32_t)byteIndex + 4U) <= bufferLength)
         {
-            checksum += (uint16_t)(((uint16_t)ftpData[numBytesChecksummed]) << 8);
+            uint32_t dataWord = *wordPtr;
+            checksum += (dataWord & 0xFFFFU) + (dataWord >> 16);
+            wordPtr++;
+            byteIndex += 4U;
         }
-        numBytesChecksummed++;
+    }
+
+    while (((uint32_t)byteIndex + 2U) <= bufferLength)
+    {
+        checksum += (uint32_t)ftpData[byteIndex] | ((uint32_t)ftpData[byteIndex + 1U] << 8);
+        byteIndex += 2U;
+    }
+
+    // An odd length leaves a last byte in the low half of a word
+    if (byteIndex < bufferLength)
+    {
+        checksum += (uint32_t)ftpData[byteIndex];
     }
 
     return (uint16_t)(~checksum);
 }
 
-com_adapter_result_t COM_FrameTransfer(uint8_t *receiveBufferPtr, uint16_t * receiveIndexPtr)
+static void ReceiveArm(uint8_t *receiveBufferPtr)
 {
-    uint8_t nextByte;
-    uint16_t readByteCount = 0U;
-    /* cppcheck-suppress misra-c2012-8.9 */
-    static uint16_t bytesSent = 0U;
-
-    com_adapter_result_t processResult = COM_FAIL;
+    uint32_t dataAddress = (uint32_t)SERCOM3_DataAddressGet();
+
+    // The first byte of every transaction is the host command code
+    receiveDescriptors[0].DMAC_BTCTRL = (uint16_t)(DMAC_BTCTRL_BLOCKACT_NOACT | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_VALID_Msk);
+    receiveDescriptors[0].DMAC_BTCNT = 1U;
+    receiveDescriptors[0].DMAC_SRCADDR = dataAddress;
+    receiveDescriptors[0].DMAC_DSTADDR = (uint32_t)&hostCommandCode;
+    receiveDescriptors[0].DMAC_DESCADDR = (uint32_t)&receiveDescriptors[1];
+
+    // The rest of the transaction goes into the FTP buffer, the destination is the end address of the block
+    receiveDescriptors[1].DMAC_BTCTRL = (uint16_t)(DMAC_BTCTRL_BLOCKACT_NOACT | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_DSTINC_Msk | DMAC_BTCTRL_VALID_Msk);
+    receiveDescriptors[1].DMAC_BTCNT = maxBufferLength;
+    receiveDescriptors[1].DMAC_SRCADDR = dataAddress;
+    receiveDescriptors[1].DMAC_DSTADDR = (uint32_t)&receiveBufferPtr[maxBufferLength];
+    receiveDescriptors[1].DMAC_DESCADDR = 0U;
+
+    hostCommandCode = 0U;
+    isReceiveArmed = DMAC_ChannelLinkedListTransfer(RECEIVE_CHANNEL, &receiveDescriptors[0]);
+}
 
-    if ((receiveBufferPtr == NULL) || (receiveIndexPtr == NULL))
+static void SendArm(void)
+{
+    if (SEND_LENGTH == comState)
     {
-        processResult = COM_INVALID_ARG;
+        isSendArmed = DMAC_ChannelTransfer(SEND_CHANNEL, &sendBuffer[0], SERCOM3_DataAddressGet(), (size_t)LENGTH_PACKET_SIZE);
+    }
+    else if (SEND_RESPONSE == comState)
+    {
+        isSendArmed = DMAC_ChannelTransfer(SEND_CHANNEL, &sendBuffer[LENGTH_PACKET_SIZE], SERCOM3_DataAddressGet(), (size_t)sendLength - LENGTH_PACKET_SIZE);
     }
     else
     {
-        processResult = COM_BUSY;
-
-        // Waiting for chip select to transition from low to high
-        /* cppcheck-suppress premium-misra-c-2025-17.3 */
-        while (CHIP_SELECT_Get() == 0U)
-        {
-            // Waiting
-        }
-        // Waiting for chip select to transition from high to low
-        /* cppcheck-suppress premium-misra-c-2025-17.3 */
-        while (CHIP_SELECT_Get() != 0U)
-        {
-            // Waiting
-        }
-
-        // Loading the first byte
-        SERCOM3_ByteWrite(sendBuffer[bytesSent]);
-        bytesSent += 1U;
-
-        // Waiting for the initial read to occur
-        while (false == (bool)SERCOM3_IsRxReady())
-        {
-            // Waiting
-        }
-
-        nextByte = (uint8_t)SERCOM3_ByteRead();
-
-        // Sets the state of the read command if needed
-        if (nextByte == (uint8_t) HOST_WRITE_CODE)
-        {
-            comState = READ_COMMAND;
-        }
+        // Nothing to send
+    }
+}
 
-        switch (comState)
-        {
-        case SEND_LENGTH:
-            /* cppcheck-suppress premium-misra-c-2025-17.3 */
-            while (0U == CHIP_SELECT_Get())
-            {
-                // Performs an exchange on the length packet bytes
-                if (true == (bool)SERCOM3_IsTxReady())
-                {
-                    if (bytesSent < LENGTH_PACKET_SIZE)
-                    {
-                        SERCOM3_ByteWrite(sendBuffer[bytesSent]);
-                        bytesSent += 1U;
-                    }
-                }
-            }
+static com_adapter_result_t TransferComplete(const uint8_t *receiveBufferPtr, uint16_t *receiveIndexPtr)
+{
+    com_adapter_result_t processResult = COM_BUSY;
 
-            // Sets the current state to expect a response send on the next cycle
-            comState = SEND_RESPONSE;
-            break;
-        case SEND_RESPONSE:
-            /* cppcheck-suppress premium-misra-c-2025-17.3 */
-            while (0U == CHIP_SELECT_Get())
-            {
-                // Performs an exchange on the response packet bytes
-                if (true == (bool)SERCOM3_IsTxReady())
-                {
-                    if (bytesSent != sendLength)
-                    {
-                        (void)SERCOM3_ByteWrite(sendBuffer[bytesSent]);
-                        bytesSent += 1U;
-                    }
-                }
-            }
+    // A stage is only shifted out when it was loaded before the host started the transaction
+    bool wasStageArmed = isSendArmed;
 
-            // Reset the rx buffer
-            while (true == (bool)SERCOM3_IsRxReady())
-            {
-                (void) SERCOM3_ByteRead();
-            }
+    // Stops both channels so the number of bytes moved can be read back
+    DMAC_ChannelDisable(RECEIVE_CHANNEL);
+    DMAC_ChannelDisable(SEND_CHANNEL);
+    isReceiveArmed = false;
+    isSendArmed = false;
 
-            // Sets the state to expect the length packet again
-            comState = SEND_LENGTH;
-            bytesSent = 0U;
+    uint16_t readByteCount = DMAC_ChannelLinkedListTransferredCountGet(RECEIVE_CHANNEL, &receiveDescriptors[0]);
 
-            // Sets the completed status to notify the FTP code.
-            processResult = COM_SEND_COMPLETE;
-            break;
-        case READ_COMMAND:
-            /* cppcheck-suppress premium-misra-c-2025-17.3 */
-            while (0U == CHIP_SELECT_Get())
-            {
-                // Puts a byte into the receive buffer if there is space left
-                if (true == (bool)SERCOM3_IsRxReady())
-                {
-                    nextByte = SERCOM3_ByteRead();
-
-                    if (readByteCount < maxBufferLength)
-                    {
-                        receiveBufferPtr[readByteCount] = nextByte;
-                        readByteCount += 1U;
-                    }
-                    else
-                    {
-                        processResult = COM_BUFFER_ERROR;
-                        comState = NO_ACTION;
-                    }
-                }
-            }
+    // Drops the command code from the count of the frame bytes
+    readByteCount = (readByteCount > 0U) ? (readByteCount - 1U) : 0U;
 
-            // Performs one additional read if needed due to CS de-assertion occurring too quickly
-            if (true == (bool)SERCOM3_IsRxReady())
-            {
-                nextByte = SERCOM3_ByteRead();
-
-                if (readByteCount < maxBufferLength)
-                {
-                    receiveBufferPtr[readByteCount] = nextByte;
-                    readByteCount += 1U;
-                }
-                else
-                {
-                    processResult = COM_BUFFER_ERROR;
-                    comState = NO_ACTION;
-                }
-            }
+    // Bytes left in the SERCOM after the buffer was filled mean the host wrote too many bytes
+    bool isBufferOverrun = ((readByteCount == maxBufferLength) && (true == (bool)SERCOM3_IsRxReady()));
 
-            // Reset the rx buffer
-            while (true == (bool)SERCOM3_IsRxReady())
-            {
-                (void) SERCOM3_ByteRead();
-            }
+    // Resets the SERCOM for the next transaction
+    SERCOM3_TransferStartClear();
+    SERCOM3_BufferFlush();
 
-            // Resets the sending logic
-            sendLength = 0U;
-            bytesSent = 0U;
-            break;
-        default:
-            //Do Nothing
-            break;
-        }
+    if (hostCommandCode == (uint8_t) HOST_WRITE_CODE)
+    {
+        // A new command cancels any response that has not been read
+        comState = NO_ACTION;
+        sendLength = 0U;
 
         // Sets the new read index for the FTP code.
         *receiveIndexPtr = readByteCount;
 
-        // Validates a received command
-        if (READ_COMMAND == comState)
+        if (true == isBufferOverrun)
+        {
+            processResult = COM_BUFFER_ERROR;
+        }
+        else if (readByteCount < FRAME_CHECK_SIZE)
+        {
+            processResult = COM_TRANSPORT_FAILURE;
+        }
+        else
         {
             calculatedFrameCheck = FrameCheckCalculate(&(receiveBufferPtr[0U]), (readByteCount - FRAME_CHECK_SIZE));
 
             // Reads FCS from the receive buffer
-            uint8_t *startOfWord = &receiveBufferPtr[readByteCount - FRAME_CHECK_SIZE];
-            uint16_t frameCheckSequence = 0x0000U;
-
-            const uint8_t * workPtr = startOfWord;
+            const uint8_t * workPtr = &receiveBufferPtr[readByteCount - FRAME_CHECK_SIZE];
             uint8_t lowByte = *workPtr;
             workPtr++;
             uint8_t highByte = *workPtr;
-            frameCheckSequence = (uint16_t)((uint16_t)((uint16_t)highByte << 8) | lowByte);
+            uint16_t frameCheckSequence = (uint16_t)((uint16_t)((uint16_t)highByte << 8) | lowByte);
+
             if (calculatedFrameCheck == frameCheckSequence)
             {
                 // Set the status to execute the command
@@ -288,7 +297,58 @@ com_adapter_result_t COM_FrameTransfer(uint8_t *receiveBufferPtr, uint16_t * rec
                 // Set the error status to craft a retry response
                 processResult = COM_TRANSPORT_FAILURE;
             }
-            comState = NO_ACTION;
+        }
+    }
+    else if ((true == wasStageArmed) && (SEND_LENGTH == comState))
+    {
+        // Sets the current state to expect a response send on the next cycle
+        comState = SEND_RESPONSE;
+    }
+    else if ((true == wasStageArmed) && (SEND_RESPONSE == comState))
+    {
+        // Sets the state to expect the length packet again
+        comState = SEND_LENGTH;
+
+        // Sets the completed status to notify the FTP code.
+        processResult = COM_SEND_COMPLETE;
+    }
+    else
+    {
+        // The host polled before a response was ready or before its stage was loaded, it reads the same stage again
+    }
+
+    return processResult;
+}
+
+com_adapter_result_t COM_FrameTransfer(uint8_t *receiveBufferPtr, uint16_t * receiveIndexPtr)
+{
+    com_adapter_result_t processResult = COM_FAIL;
+
+    if ((receiveBufferPtr == NULL) || (receiveIndexPtr == NULL))
+    {
+        processResult = COM_INVALID_ARG;
+    }
+    else
+    {
+        processResult = COM_BUSY;
+
+        if (false == isReceiveArmed)
+        {
+            ReceiveArm(receiveBufferPtr);
+        }
+
+        // The transaction is over once the chip select has been asserted and released again
+        /* cppcheck-suppress premium-misra-c-2025-17.3 */
+        if ((1U == SERCOM3_IsTransferStarted()) && (0U != CHIP_SELECT_Get()))
+        {
+            processResult = TransferComplete(receiveBufferPtr, receiveIndexPtr);
+            ReceiveArm(receiveBufferPtr);
+        }
+
+        // Loads the next response stage only while the host is not in a transaction
+        if ((false == isSendArmed) && (NO_ACTION != comState) && (0U == SERCOM3_IsTransferStarted()))
+        {
+            SendArm();
         }
     }
 
@@ -309,6 +369,10 @@ com_adapter_result_t COM_FrameSet(const uint8_t *responseBufferPtr, uint16_t res
     }
     else
     {
+        // Drops any stage still waiting to be read before the send buffer is overwritten
+        DMAC_ChannelDisable(SEND_CHANNEL);
+        isSendArmed = false;
+
         // Initializes the transfer logic
         sendLength = 0U;
 
@@ -365,6 +429,8 @@ com_adapter_result_t COM_Initialize(uint16_t maximumBufferLength)
 {
     com_adapter_result_t result = COM_FAIL;
     comState = NO_ACTION;
+    isReceiveArmed = false;
+    isSendArmed = false;
 
     if (maximumBufferLength != 0U)
     {
@@ -106,12 +106,16 @@ typedef enum
 /**
  @ingroup com_adapter_spi
  @brief Receives or sends bytes over SERCOM and pushes data bytes into the provided buffer until a complete frame is received.
+ @note The bytes of a transaction are moved by the DMAC, so this function does not block. It arms the channels,
+ checks if the host has released the chip select and handles the finished transaction.
  @param [in/out] receiveBufferPtr - Pointer to the buffer provided to SERCOM
  @param [in/out] receiveIndexPtr - Pointer to the number of bytes successfully received by SERCOM
  @return @ref COM_PASS - SERCOM has received a complete frame and is ready for further processing \n
  @return @ref COM_BUSY - SERCOM still loading the buffer \n
  @return @ref COM_BUFFER_ERROR - SERCOM received too many bytes \n
- @return @ref COM_FAIL - An error occurred in SERCOM \n
+ @return @ref COM_TRANSPORT_FAILURE - The frame check of the received frame failed \n
+ @return @ref COM_SEND_COMPLETE - The host has read the complete response \n
+ @return @ref COM_INVALID_ARG - An invalid argument was provided \n
  */
 com_adapter_result_t COM_FrameTransfer(uint8_t *receiveBufferPtr, uint16_t *receiveIndexPtr);
 
@@ -30,6 +30,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include "bl_app_verify.h"
 #include "bl_config.h"
 #include "../../../peripheral/nvmctrl/plib_nvmctrl.h"
@@ -53,20 +54,109 @@
 static void CRC32_Calculate(uint32_t startAddress, uint32_t length, uint32_t *crc);
 /**
  * @ingroup mdfu_client_32bit
- * @brief Validates the CRC32 checksum for a specified memory region.
+ * @brief Validates the CRC32 checksum calculated over a memory region.
  *
  * This function checks the CRC32 checksum of a memory block against a
  * stored CRC value to verify data integrity and then returns a value indicating
  * whether the validation was successful or not.
  *
- * @param [in] startAddress - The starting address of the memory block to validate
- * @param [in] length - The length of the memory block in bytes
+ * @param [in] crc - The CRC32 checksum calculated over the memory block
  * @param [in] crcAddress - The address where the expected CRC32 checksum is stored
  * @return @ref BL_PASS - Bootloader verified the application image with no errors \n
  * @return @ref BL_FAIL - Bootloader encountered an error and failed unexpectedly \n
  * @return @ref BL_ERROR_VERIFICATION_FAIL - Bootloader image verification failed \n
  */
-static bl_result_t CRC32_Validate(uint32_t startAddress, uint32_t length, uint32_t crcAddress);
+static bl_result_t CRC32_Validate(uint32_t crc, uint32_t crcAddress);
+
+/**
+ * @ingroup mdfu_client_32bit
+ * @struct bl_verify_job_t
+ * @brief Holds the progress of a verification that is calculated in steps.
+ * @var bl_verify_job_t::address
+ * Contains the next address to be added to the CRC.
+ * @var bl_verify_job_t::endAddress
+ * Contains the first address after the hash range.
+ * @var bl_verify_job_t::crc
+ * Contains the CRC32 checksum of the bytes calculated so far.
+ * @var bl_verify_job_t::footerData
+ * Contains the footer of the image being verified.
+ * @var bl_verify_job_t::result
+ * Contains the result of the verification, @ref BL_BUSY while it is running.
+ */
+typedef struct
+{
+    uint32_t address;
+    uint32_t endAddress;
+    uint32_t crc;
+    bl_footer_data_t footerData;
+    bl_result_t result;
+} bl_verify_job_t;
+
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief State of the verification that is calculated in steps.
+ */
+static bl_verify_job_t verifyJob = {0U, 0U, 0U, {0U, 0U, 0U, 0U, 0U}, BL_FAIL};
+
+#if (BL_VERIFIED_MARKER_ENABLED == 1)
+/**
+ * @ingroup mdfu_client_32bit
+ * @struct bl_verified_marker_t
+ * @brief Record stored in the Data Flash once the application passed a full verification.
+ * @var bl_verified_marker_t::markerKey
+ * Contains @ref BL_VERIFIED_MARKER_KEY when the record is valid.
+ * @var bl_verified_marker_t::footerData
+ * Contains a copy of the footer of the verified application, including its hash.
+ * @var bl_verified_marker_t::spotCheckData
+ * Contains the CRC32 of the bytes that are checked on the boots that use the record.
+ * @var bl_verified_marker_t::markerCheck
+ * Contains the inverted XOR of all the other words of the record.
+ */
+typedef struct
+{
+    uint32_t markerKey;
+    bl_footer_data_t footerData;
+    uint32_t spotCheckData;
+    uint32_t markerCheck;
+} bl_verified_marker_t;
+
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief Calculates the check word of a verified image record.
+ *
+ * @param [in] marker - Pointer to the record
+ * @return Inverted XOR of all the words of the record that precede the check word
+ */
+static uint32_t MarkerCheckCalculate(const bl_verified_marker_t * marker);
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief Calculates the CRC32 checksum of the bounded part of the image that is checked when the record matches.
+ *
+ * The first and the last @ref BL_VERIFY_SPOT_CHECK_SIZE bytes of the hash range are covered. This holds the
+ * vector table the bootloader jumps through and the end of the image.
+ *
+ * @param [in] footerData - Pointer to the footer that gives the hash range
+ * @return CRC32 checksum of the spot check bytes
+ */
+static uint32_t SpotCheckCalculate(const bl_footer_data_t * footerData);
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief Checks if the stored verified image record belongs to the image described by the footer.
+ *
+ * @param [in] footerData - Pointer to the footer read from the application space
+ * @return true - The record matches the footer and the spot check passed \n
+ * @return false - The full verification must run \n
+ */
+static bool VerifiedMarkerMatch(const bl_footer_data_t * footerData);
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief Stores the verified image record of the image described by the footer.
+ *
+ * @param [in] footerData - Pointer to the footer of the image that passed the full verification
+ * @return None
+ */
+static void VerifiedMarkerWrite(const bl_footer_data_t * footerData);
+#endif
 
 static void CRC32_Calculate(uint32_t startAddress, uint32_t length, uint32_t *crc)
 {
@@ -83,13 +173,11 @@ static void CRC32_Calculate(uint32_t startAddress, uint32_t length, uint32_t *cr
     *crc = workCrc;
 }
 
-static bl_result_t CRC32_Validate(uint32_t startAddress, uint32_t length, uint32_t crcAddress)
+static bl_result_t CRC32_Validate(uint32_t crc, uint32_t crcAddress)
 {
     bl_result_t result = BL_FAIL;
-    uint32_t crc = 0xFFFFFFFFU;
     uint32_t refCRC = 0x00U;
 
-    CRC32_Calculate(startAddress, length, &crc);
     bool status = NVMCTRL_Read(&refCRC, HASH_DATA_SIZE, crcAddress);
     
     if (status == true)
@@ -112,8 +200,200 @@ static bl_result_t CRC32_Validate(uint32_t startAddress, uint32_t length, uint32
 
 bl_result_t BL_ImageVerify(void)
 {
-    // Verify the app area
-    bl_result_t verificationStatus = CRC32_Validate(BL_APPLICATION_START_ADDRESS, BL_IMAGE_PARTITION_SIZE - BL_HASH_DATA_SIZE, BL_VERIFICATION_START_ADDRESS);
+    // Calculate the whole hash range in a single step
+    bl_result_t verificationStatus = BL_ImageVerifyStart();
+
+    while (verificationStatus == BL_BUSY)
+    {
+        verificationStatus = BL_ImageVerifyStep((uint32_t)BL_IMAGE_PARTITION_SIZE);
+    }
+
+    return verificationStatus;
+}
+
+bl_result_t BL_ImageVerifyStart(void)
+{
+    bl_result_t verificationStatus = BL_ERROR_VERIFICATION_FAIL;
+
+    // The footer gives the range covered by the hash, so only the Flash used by the application is checked
+    bool status = NVMCTRL_Read((uint32_t *) & verifyJob.footerData, sizeof(bl_footer_data_t), BL_FOOTER_START_ADDRESS);
+
+    if (status == false)
+    {
+        verificationStatus = BL_FAIL;
+    }
+    else if ((verifyJob.footerData.verificationStartAddress != (uint32_t)BL_APPLICATION_START_ADDRESS)
+            || (verifyJob.footerData.verificationEndAddress < verifyJob.footerData.verificationStartAddress)
+            || (verifyJob.footerData.verificationEndAddress >= (BL_FOOTER_START_ADDRESS + (uint32_t)HASH_DATA_OFFSET))
+            || (((verifyJob.footerData.verificationEndAddress + 1U) % 4U) != 0U))
+    {
+        // An erased or corrupted footer cannot describe a valid image
+        verificationStatus = BL_ERROR_VERIFICATION_FAIL;
+    }
+#if (BL_VERIFIED_MARKER_ENABLED == 1)
+    else if (VerifiedMarkerMatch(&verifyJob.footerData) == true)
+    {
+        // An image that passed the full verification before and has not been written since only needs the spot check
+        verificationStatus = BL_PASS;
+    }
+#endif
+    else
+    {
+        // Set up the hash range, the CRC is calculated by the following steps
+        verifyJob.address = verifyJob.footerData.verificationStartAddress;
+        verifyJob.endAddress = verifyJob.footerData.verificationEndAddress + 1U;
+        verifyJob.crc = 0xFFFFFFFFU;
+        verificationStatus = BL_BUSY;
+    }
+
+    verifyJob.result = verificationStatus;
 
     return verificationStatus;
-}
\ No newline at end of file
+}
+
+bl_result_t BL_ImageVerifyStep(uint32_t byteBudget)
+{
+    if (verifyJob.result == BL_BUSY)
+    {
+        // The DSU works on whole 32-bit words
+        uint32_t length = (byteBudget < 4U) ? 4U : (byteBudget - (byteBudget % 4U));
+
+        if (length > (verifyJob.endAddress - verifyJob.address))
+        {
+            length = verifyJob.endAddress - verifyJob.address;
+        }
+
+        // The CRC of the previous chunks is the seed of the next one
+        CRC32_Calculate(verifyJob.address, length, &verifyJob.crc);
+        verifyJob.address += length;
+
+        if (verifyJob.address >= verifyJob.endAddress)
+        {
+            verifyJob.result = CRC32_Validate(verifyJob.crc, BL_FOOTER_START_ADDRESS + (uint32_t)HASH_DATA_OFFSET);
+#if (BL_VERIFIED_MARKER_ENABLED == 1)
+            if (verifyJob.result == BL_PASS)
+            {
+                VerifiedMarkerWrite(&verifyJob.footerData);
+            }
+#endif
+        }
+    }
+
+    return verifyJob.result;
+}
+
+bl_result_t BL_ImageVerifyResultGet(void)
+{
+    return verifyJob.result;
+}
+
+void BL_VerifiedMarkerClear(void)
+{
+#if (BL_VERIFIED_MARKER_ENABLED == 1)
+    uint32_t markerKey = 0xFFFFFFFFU;
+
+    (void) NVMCTRL_DATA_FLASH_Read(&markerKey, 4U, BL_VERIFIED_MARKER_ADDRESS);
+
+    // Only erase when a record is stored, so transfers do not wear the Data Flash row
+    if (markerKey != 0xFFFFFFFFU)
+    {
+        while (true == NVMCTRL_IsBusy())
+        {
+
+        }
+
+        (void) NVMCTRL_DATA_FLASH_RowErase(BL_VERIFIED_MARKER_ADDRESS);
+
+        while (true == NVMCTRL_IsBusy())
+        {
+
+        }
+    }
+#endif
+}
+
+#if (BL_VERIFIED_MARKER_ENABLED == 1)
+static uint32_t MarkerCheckCalculate(const bl_verified_marker_t * marker)
+{
+    return ~(marker->markerKey
+            ^ marker->footerData.applicationId
+            ^ marker->footerData.applicationVersion
+            ^ marker->footerData.verificationEndAddress
+            ^ marker->footerData.verificationStartAddress
+            ^ marker->footerData.verificationData
+            ^ marker->spotCheckData);
+}
+
+static uint32_t SpotCheckCalculate(const bl_footer_data_t * footerData)
+{
+    uint32_t crc = 0xFFFFFFFFU;
+    uint32_t length = (footerData->verificationEndAddress + 1U) - footerData->verificationStartAddress;
+
+    if (length <= (2U * (uint32_t)BL_VERIFY_SPOT_CHECK_SIZE))
+    {
+        CRC32_Calculate(footerData->verificationStartAddress, length, &crc);
+    }
+    else
+    {
+        // The DSU keeps going from the seed, so both ends are chained into one checksum
+        CRC32_Calculate(footerData->verificationStartAddress, BL_VERIFY_SPOT_CHECK_SIZE, &crc);
+        CRC32_Calculate((footerData->verificationEndAddress + 1U) - (uint32_t)BL_VERIFY_SPOT_CHECK_SIZE, BL_VERIFY_SPOT_CHECK_SIZE, &crc);
+    }
+
+    return crc;
+}
+
+static bool VerifiedMarkerMatch(const bl_footer_data_t * footerData)
+{
+    bl_verified_marker_t marker;
+
+    (void) NVMCTRL_DATA_FLASH_Read((uint32_t *) &marker, sizeof(bl_verified_marker_t), BL_VERIFIED_MARKER_ADDRESS);
+
+    // The footer holds the hash and the range of the image, so a different image cannot match the record
+    bool isMatch = (marker.markerKey == BL_VERIFIED_MARKER_KEY)
+            && (marker.markerCheck == MarkerCheckCalculate(&marker))
+            && (memcmp((const void *) &marker.footerData, (const void *) footerData, sizeof(bl_footer_data_t)) == 0);
+
+    if (isMatch == true)
+    {
+        isMatch = (marker.spotCheckData == SpotCheckCalculate(footerData));
+    }
+
+    return isMatch;
+}
+
+static void VerifiedMarkerWrite(const bl_footer_data_t * footerData)
+{
+    uint32_t markerPage[NVMCTRL_DATAFLASH_PAGESIZE / 4U];
+    bl_verified_marker_t marker = {
+        .markerKey = BL_VERIFIED_MARKER_KEY,
+        .footerData = *footerData,
+        .spotCheckData = SpotCheckCalculate(footerData),
+        .markerCheck = 0U
+    };
+
+    marker.markerCheck = MarkerCheckCalculate(&marker);
+
+    (void) memset((void *) &markerPage[0], 0xFF, sizeof(markerPage));
+    (void) memcpy((void *) &markerPage[0], (const void *) &marker, sizeof(bl_verified_marker_t));
+
+    while (true == NVMCTRL_IsBusy())
+    {
+
+    }
+
+    (void) NVMCTRL_DATA_FLASH_RowErase(BL_VERIFIED_MARKER_ADDRESS);
+
+    while (true == NVMCTRL_IsBusy())
+    {
+
+    }
+
+    (void) NVMCTRL_DATA_FLASH_PageWrite(&markerPage[0], BL_VERIFIED_MARKER_ADDRESS);
+
+    while (true == NVMCTRL_IsBusy())
+    {
+
+    }
+}
+#endif
\ No newline at end of file
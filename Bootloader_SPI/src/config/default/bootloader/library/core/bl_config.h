@@ -45,7 +45,7 @@
  * @brief Represents the minor version of the image format that is
  * understood by the bootloader core. \n
  */
-#define BL_IMAGE_FORMAT_MINOR_VERSION (0x0)
+#define BL_IMAGE_FORMAT_MINOR_VERSION (0x2)
 /**
  * @ingroup mdfu_client_32bit
  * @def BL_IMAGE_FORMAT_PATCH_VERSION
@@ -139,17 +139,128 @@
  * @brief 32-bit pattern used to indicate that a software entry has been requested.
  */
 #define BL_SOFTWARE_ENTRY_PATTERN (0x5048434DU)
+/**
+ * @ingroup mdfu_client_32bit
+ * @def BL_BOOT_TRACE_ENABLED
+ * @brief Enables the boot time record. When set, the bootloader stores a SysTick time stamp at the end of each boot phase.
+ */
+#define BL_BOOT_TRACE_ENABLED (1)
+/**
+ * @ingroup mdfu_client_32bit
+ * @def BL_BOOT_TRACE_START
+ * @brief Start address of the boot time record.
+ *
+ * @note The record follows the software entry pattern in the 48 bytes of RAM that the bootloader linker script
+ * keeps out of its own RAM. The application must read the record before it uses this area.
+ */
+#define BL_BOOT_TRACE_START (0x20000010)
+/**
+ * @ingroup mdfu_client_32bit
+ * @def BL_BOOT_TRACE_KEY
+ * @brief 32-bit pattern that starts a boot time record written in the current boot.
+ */
+#define BL_BOOT_TRACE_KEY (0x54544C42U)
 /**
  * @ingroup mdfu_client_32bit
  * @def HASH_DATA_SIZE
  * @brief Size of the verification hash data in bytes.
  */
 #define BL_HASH_DATA_SIZE (4U)
+/**
+ * @ingroup mdfu_client_32bit
+ * @def APPLICATION_SLOT_ID_DATA_SIZE
+ * @brief Size of the application ID data in bytes.
+ */
+#define APPLICATION_SLOT_ID_DATA_SIZE (4U)
+/**
+* @ingroup mdfu_client_32bit
+* @def APPLICATION_VERSION_DATA_SIZE
+* @brief Size of the version data in bytes.
+*/
+#define APPLICATION_VERSION_DATA_SIZE (4U)
+/**
+* @ingroup mdfu_client_32bit
+* @def VERIFY_END_ADDRESS_SIZE
+* @brief Size of the verify end address data in bytes.
+*/
+#define VERIFY_END_ADDRESS_SIZE (4U)
+/**
+* @ingroup mdfu_client_32bit
+* @def VERIFY_START_ADDRESS_SIZE
+* @brief Size of the verify start address data in bytes.
+*/
+#define VERIFY_START_ADDRESS_SIZE (4U)
+/**
+* @ingroup mdfu_client_32bit
+* @def HASH_DATA_OFFSET
+* @brief Offset of the hash data in bytes, calculated as the sum of verify start address size, verify end address size, version data size, and partition ID data size.
+*/
+#define HASH_DATA_OFFSET (VERIFY_START_ADDRESS_SIZE + VERIFY_END_ADDRESS_SIZE + APPLICATION_VERSION_DATA_SIZE + APPLICATION_SLOT_ID_DATA_SIZE)
+/**
+ * @ingroup mdfu_client_32bit
+ * @struct bl_footer_data_t
+ * @brief Contains metadata for the bootloader footer.
+ * @var bl_footer_data_t::applicationId
+ * Contains the identifier for the application. Only one image space is used, so it is 0x00.
+ * @var bl_footer_data_t::applicationVersion
+ * Contains the version of the application.
+ * @var bl_footer_data_t::verificationEndAddress
+ * Contains the end address for verification. The application build sets it to the last address used by the image.
+ * @var bl_footer_data_t::verificationStartAddress
+ * Contains the start address for verification.
+ * @var bl_footer_data_t::verificationData
+ * Contains the verification hash value for verification.
+ */
+typedef struct
+{
+    uint32_t applicationId;
+    uint32_t applicationVersion;
+    uint32_t verificationEndAddress;
+    uint32_t verificationStartAddress;
+    uint32_t verificationData;
+} bl_footer_data_t;
+/**
+ * @ingroup mdfu_client_32bit
+ * @def BL_FOOTER_START_ADDRESS
+ * @brief Start address of the footer placed at the end of the application memory space.
+ */
+#define BL_FOOTER_START_ADDRESS (((uint32_t)BL_APPLICATION_END_ADDRESS + 1U) - (uint32_t)sizeof(bl_footer_data_t))
+/**
+ * @ingroup mdfu_client_32bit
+ * @def BL_VERIFIED_MARKER_ENABLED
+ * @brief Enables the verified image record. When set, a boot that finds a record matching the footer
+ * of the application only checks a bounded part of the image instead of the full hash range.
+ */
+#define BL_VERIFIED_MARKER_ENABLED (1)
+/**
+ * @ingroup mdfu_client_32bit
+ * @def BL_VERIFIED_MARKER_ADDRESS
+ * @brief Start address of the Data Flash row that holds the verified image record.
+ *
+ * @note This is the last row of the Data Flash. The application must not use this row.
+ */
+#define BL_VERIFIED_MARKER_ADDRESS (0x00400F00U)
+/**
+ * @ingroup mdfu_client_32bit
+ * @def BL_VERIFIED_MARKER_KEY
+ * @brief 32-bit pattern that starts a valid verified image record.
+ */
+#define BL_VERIFIED_MARKER_KEY (0x4B524D56U)
+/**
+ * @ingroup mdfu_client_32bit
+ * @def BL_VERIFY_SPOT_CHECK_SIZE
+ * @brief Number of bytes checked at the start and at the end of the hash range when the verified image record matches.
+ */
+#define BL_VERIFY_SPOT_CHECK_SIZE (256U)
 /**
  * @ingroup mdfu_client_32bit
  * @def ASM_VECTOR
  * @brief Macro defined to jump the program to the application reset location.
+ *
+ * It can be defined by the build instead, for example by a host build of the library that has no application to start.
  */
+#ifndef ASM_VECTOR
 #define ASM_VECTOR              asm("bx %0"::"r" (reset_vector))
+#endif
 
 #endif // BL_BOOT_CONFIG_H
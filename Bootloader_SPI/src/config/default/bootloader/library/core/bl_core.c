@@ -33,7 +33,9 @@
 
 #include "bl_core.h"
 #include "bl_config.h"
+#include "bl_app_verify.h"
 #include "ftp/bl_ftp.h"
+#include "../../../peripheral/systick/plib_systick.h"
 
 /**
  * @ingroup mdfu_client_32bit
@@ -72,6 +74,13 @@ typedef struct
     bl_command_header_t commandHeader;
 } bl_unlock_boot_metadata_t;
 
+/**
+ * @ingroup mdfu_client_32bit
+ * @def BL_METADATA_BLOCK_SIZE
+ * @brief Total size of the metadata block, including its block header.
+ */
+#define BL_METADATA_BLOCK_SIZE  (16U)
+
 /**
  * @ingroup mdfu_client_32bit
  * @brief Buffer used for write operations.
@@ -82,11 +91,146 @@ typedef struct
  */
 static uint32_t writeBuffer[BL_WRITE_BYTE_LENGTH / 4U];
 
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief Maximum number of data bytes in each write block, as given by the metadata block.
+ */
+static uint16_t writeBlockSize = 0U;
+
+/**
+ * @ingroup mdfu_client_32bit
+ * @def BL_FLASH_REGION_SIZE
+ * @brief Size of each Flash lock region. The NVMCTRL splits the Flash into 16 regions.
+ */
+#define BL_FLASH_REGION_SIZE    (FLASH_SIZE / 16U)
+
+/**
+ * @ingroup mdfu_client_32bit
+ * @def BL_STAGING_ROW_COUNT
+ * @brief Number of Flash rows in the area used to download the image data.
+ */
+#define BL_STAGING_ROW_COUNT    ((((uint32_t)BL_STAGING_IMAGE_END + 1U) - (uint32_t)BL_STAGING_IMAGE_START) / NVMCTRL_FLASH_ROWSIZE)
+
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief One bit per row of the download area, set once the row has been erased in the current update.
+ *
+ * Rows are erased on demand before their first page is programmed, so the time spent erasing
+ * follows the size of the image instead of the size of the download area.
+ */
+static uint32_t erasedRowMap[(BL_STAGING_ROW_COUNT + 31U) / 32U];
+
+/**
+ * @ingroup mdfu_client_32bit
+ * @enum bl_flash_operation_t
+ * @brief Flash operations that the bootloader core can queue.
+ */
+typedef enum
+{
+    FLASH_ROW_ERASE = 0U, /**< Erases every row of the range that has not been erased yet */
+    FLASH_PAGE_WRITE = 1U, /**< Programs every page of the range from the write buffer */
+    FLASH_PAGE_FILL = 2U, /**< Programs the first page of the write buffer into every page of the range */
+} bl_flash_operation_t;
+
+/**
+ * @ingroup mdfu_client_32bit
+ * @enum bl_flash_state_t
+ * @brief States of the Flash operation engine.
+ */
+typedef enum
+{
+    FLASH_STATE_IDLE = 0U, /**< No operation is queued */
+    FLASH_STATE_UNLOCK = 1U, /**< The region of the next address must be unlocked */
+    FLASH_STATE_EXECUTE = 2U, /**< Rows or pages of the unlocked region are being processed */
+    FLASH_STATE_LOCK = 3U, /**< The region that was just processed is being locked */
+} bl_flash_state_t;
+
+/**
+ * @ingroup mdfu_client_32bit
+ * @struct bl_flash_job_t
+ * @brief Progress of the Flash operation queued by the bootloader core.
+ * @var bl_flash_job_t::state
+ *   Current state of the engine.
+ * @var bl_flash_job_t::operation
+ *   Operation applied to each row or page of the range.
+ * @var bl_flash_job_t::address
+ *   Address of the next row or page to be processed.
+ * @var bl_flash_job_t::endAddress
+ *   First address after the range.
+ * @var bl_flash_job_t::regionAddress
+ *   Address used to unlock the region that is being processed.
+ * @var bl_flash_job_t::bufferIndex
+ *   Index of the next page in the write buffer.
+ * @var bl_flash_job_t::status
+ *   Result of the queued operations. An error is held until the bootloader is initialized again.
+ */
+typedef struct
+{
+    bl_flash_state_t state;
+    bl_flash_operation_t operation;
+    uint32_t address;
+    uint32_t endAddress;
+    uint32_t regionAddress;
+    uint32_t bufferIndex;
+    bl_result_t status;
+} bl_flash_job_t;
+
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief Flash operation that is advanced by @ref BL_FlashTask.
+ */
+static bl_flash_job_t flashJob = {FLASH_STATE_IDLE, FLASH_ROW_ERASE, 0U, 0U, 0U, 0U, BL_PASS};
+
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief Counters of the Flash operations run by @ref BL_FlashTask.
+ */
+static bl_flash_statistics_t flashStatistics = {0U, 0U, 0U};
+
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief SysTick count read when the last erase or write command was issued.
+ */
+static uint32_t flashCommandCount = 0U;
+
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief Flag for indicating that the busy time of the last erase or write command has not been added yet.
+ */
+static bool isFlashCommandTimed = false;
+
 /**
  * @ingroup mdfu_client_32bit
  * @brief Flag for indicating if the meta data has been validated in the update process.
  */
 static bool bootloaderCoreUnlocked = false;
+
+/**
+ * @ingroup mdfu_client_32bit
+ * @def BL_SYSTICK_PERIOD
+ * @brief Number of SysTick ticks in one period of the free running counter used by the boot time record and the Flash statistics.
+ */
+#define BL_SYSTICK_PERIOD (0x01000000U)
+
+#if BL_BOOT_TRACE_ENABLED == 1
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief SysTick count at the last reading for the boot time record.
+ */
+static uint32_t bootTraceCount = 0U;
+
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief SysTick ticks elapsed from @ref BL_BootTraceStart to the last reading of the counter.
+ */
+static uint32_t bootTraceElapsed = 0U;
+
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief Flag for indicating that the SysTick counts for the boot time record, until the last boot phase is stamped.
+ */
+static bool isBootTraceRunning = false;
+#endif
 /**
  * @ingroup mdfu_client_32bit
  * @brief Unlocks the bootloader processor using the provided buffer.
@@ -102,75 +246,197 @@ static bool bootloaderCoreUnlocked = false;
 static bl_result_t BootloaderProcessorUnlock(uint8_t * bufferPtr);
 /**
  * @ingroup mdfu_client_32bit
- * @brief Erases the entire area used to download the image data.
+ * @brief Prepares the area used to download the image data for a new update.
+ *
+ * This function marks every row of the download area as not erased. Nothing is erased here,
+ * each row is erased by @ref BL_FlashTask right before the first page of the row is programmed.
+ *
+ * @param None
+ * @return None
+ */
+static void DownloadAreaReset(void);
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief Queues the Flash operation described by a fill block.
+ *
+ * A range filled with the erased value is only erased. Any other value is programmed page by page
+ * from a single page of the write buffer.
+ *
+ * @param[in] commandBuffer - Pointer to the start of the fill block
+ * @param[in] commandLength - Length of the fill block
+ * @return @ref BL_PASS - The fill operation has been queued
+ * @return @ref BL_ERROR_COMMAND_PROCESSING - The block is too short or the range is not aligned to the Flash pages
+ * @return @ref BL_ERROR_ADDRESS_OUT_OF_RANGE - The range does not fit into the download area
+ */
+static bl_result_t FillBlockProcess(const uint8_t * commandBuffer, uint16_t commandLength);
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief Decodes a compressed block straight into the write buffer and queues the page writes.
+ *
+ * The data is a stream of LZSS groups. Each group starts with a flag byte whose bits, from the LSB,
+ * select a literal byte (0) or a two byte match (1). A match holds the distance minus one in its
+ * lower 12 bits and the length minus three in its upper 4 bits, both little endian.
+ *
+ * @param[in] commandBuffer - Pointer to the start of the compressed block
+ * @param[in] commandLength - Length of the compressed block
+ * @return @ref BL_PASS - The block has been decoded and its page writes have been queued
+ * @return @ref BL_ERROR_COMMAND_PROCESSING - The block is malformed or decodes to more data than a write block holds
+ * @return @ref BL_ERROR_ADDRESS_OUT_OF_RANGE - The decoded data or a match does not fit into the download area
+ */
+static bl_result_t CompressedBlockProcess(const uint8_t * commandBuffer, uint16_t commandLength);
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief Queues a Flash operation over the given range.
  *
- * This function will erase the entire image area if there is only one image.
- * In build configurations where there is a staging area this function will erase the staging area only.
+ * The operation is carried out one row or page at a time by @ref BL_FlashTask. Each lock region
+ * of the range is unlocked once, processed back-to-back and locked again.
  *
- * @param[in] startAddress - Start address of the area used to download the image data
+ * @param[in] operation - Operation applied to each row or page of the range
+ * @param[in] startAddress - Flash address of the first row or page
+ * @param[in] length - Length of the range in bytes
  * @return None
  */
-static void DownloadAreaErase(uint32_t startAddress);
+static void FlashJobStart(bl_flash_operation_t operation, uint32_t startAddress, uint32_t length);
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief Checks if every word of a Flash row holds the erased value.
+ *
+ * @param[in] rowAddress - Start address of the row
+ * @return True - The row is erased
+ * @return False - The row holds programmed data
+ */
+static bool RowIsBlank(uint32_t rowAddress);
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief Checks if the row holding the given address has been erased or written in the current update.
+ *
+ * @param[in] address - Address inside the row
+ * @return True - The row holds the data of the current update
+ * @return False - The row is outside of the download area or still holds the data of a previous image
+ */
+static bool RowIsUpdated(uint32_t address);
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief Reads the free running SysTick counter.
+ *
+ * The counter is started over its full 24-bit range if it is not running, for example after the boot time record has stopped it.
+ *
+ * @return Current count of the SysTick, counting down
+ */
+static uint32_t SysTickCountGet(void);
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief Starts timing the erase or write command that was just issued to the NVMCTRL.
+ */
+static void FlashCommandTimerStart(void);
+
+#if BL_BOOT_TRACE_ENABLED == 1
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief Adds the SysTick ticks elapsed since the last reading to the boot time record.
+ *
+ * A single wrap flag is kept by the SysTick, so the counter must be read at least once per period.
+ */
+static void BootTraceElapsedUpdate(void);
+#endif
 
 bl_result_t BL_BootCommandProcess(uint8_t * commandBuffer, uint16_t commandLength)
 {
     bl_result_t bootCommandStatus = BL_ERROR_UNKNOWN_COMMAND;
 
-    bl_block_header_t blockHeader;
-    (void) memcpy((void *)&blockHeader.blockLength, (const void *) & commandBuffer[0], (size_t)2U);
-    (void) memcpy((void *)&blockHeader.blockType, (const void *) & commandBuffer[2U], (size_t)1U);
-
-    // Switch on the bootloader command and execute the logic needed
-    switch (blockHeader.blockType)
+    if (flashJob.state != FLASH_STATE_IDLE)
+    {
+        // The write buffer and the Flash are in use until the queued operation is finished
+        bootCommandStatus = BL_BUSY;
+    }
+    else if (flashJob.status != BL_PASS)
+    {
+        // Report the failure of an operation queued by an earlier block
+        bootCommandStatus = flashJob.status;
+    }
+    else if (commandLength < BL_BLOCK_HEADER_SIZE)
     {
-    case UNLOCK_BOOTLOADER:
-        bootCommandStatus = BootloaderProcessorUnlock(commandBuffer);
-        break;
-    case WRITE_FLASH:
-        if (bootloaderCoreUnlocked)
+        // The receive buffer is not cleared between frames, the bytes after the block are left over from earlier ones
+        bootCommandStatus = BL_ERROR_COMMAND_PROCESSING;
+    }
+    else
+    {
+        // The block type is a single byte, the enumeration is wider
+        bl_block_header_t blockHeader;
+        (void) memcpy((void *)&blockHeader.blockLength, (const void *) & commandBuffer[0], (size_t)2U);
+        blockHeader.blockType = (bl_block_type_t) commandBuffer[2U];
+
+        // Switch on the bootloader command and execute the logic needed
+        switch (blockHeader.blockType)
         {
-            // Copy out the data buffer into a defined packet structure
-            bl_command_header_t commandHeader;
-            (void) memcpy((void *)&commandHeader.startAddress, (const void *) & commandBuffer[BL_BLOCK_HEADER_SIZE], (size_t)4U);
-            /*
-            Calculate the offset needed for the download location. *Valuable when multiple image locations are defined*
-            This mathematical corelation is consistent as long as the execution image is located at the lower addresses
-            and all image spaces are the same size.
-             */
-            uint32_t stagingAreaOffset = (uint32_t) (BL_STAGING_IMAGE_START - BL_APPLICATION_START_ADDRESS);
-
-            if ((uint32_t) (commandHeader.startAddress + stagingAreaOffset) >= (uint32_t) BL_STAGING_IMAGE_START)
+        case UNLOCK_BOOTLOADER:
+            if (commandLength >= BL_METADATA_BLOCK_SIZE)
+            {
+                bootCommandStatus = BootloaderProcessorUnlock(commandBuffer);
+            }
+            else
             {
-                (void) memcpy((void *)&writeBuffer[0], (const void *)&commandBuffer[BL_COMMAND_HEADER_SIZE + BL_BLOCK_HEADER_SIZE], (size_t)((size_t)commandLength - (size_t)BL_COMMAND_HEADER_SIZE - (size_t)BL_BLOCK_HEADER_SIZE));
+                bootCommandStatus = BL_ERROR_COMMAND_PROCESSING;
+            }
+            break;
+        case WRITE_FLASH:
+            if (bootloaderCoreUnlocked)
+            {
+                // Copy out the data buffer into a defined packet structure
+                bl_command_header_t commandHeader;
+                (void) memcpy((void *)&commandHeader.startAddress, (const void *) & commandBuffer[BL_BLOCK_HEADER_SIZE], (size_t)4U);
+                /*
+                Calculate the offset needed for the download location. *Valuable when multiple image locations are defined*
+                This mathematical corelation is consistent as long as the execution image is located at the lower addresses
+                and all image spaces are the same size.
+                 */
+                uint32_t stagingAreaOffset = (uint32_t) (BL_STAGING_IMAGE_START - BL_APPLICATION_START_ADDRESS);
+                uint32_t writeAddress = commandHeader.startAddress + stagingAreaOffset;
+                uint16_t payloadLength = (commandLength > (BL_COMMAND_HEADER_SIZE + BL_BLOCK_HEADER_SIZE)) ? (uint16_t)(commandLength - BL_COMMAND_HEADER_SIZE - BL_BLOCK_HEADER_SIZE) : 0U;
+                uint16_t pageCount = (uint16_t)((payloadLength + (NVMCTRL_FLASH_PAGESIZE - 1U)) / NVMCTRL_FLASH_PAGESIZE);
 
-                NVMCTRL_RegionUnlock(commandHeader.startAddress + stagingAreaOffset);
-                while (NVMCTRL_IsBusy() == true)
+                if ((payloadLength == 0U) || (payloadLength > writeBlockSize) || ((writeAddress % NVMCTRL_FLASH_PAGESIZE) != 0U))
                 {
+                    bootCommandStatus = BL_ERROR_COMMAND_PROCESSING;
                 }
-
-                // Write all pages of the row size
-                bool writeStatus = NVMCTRL_PageWrite(&writeBuffer[0], commandHeader.startAddress + stagingAreaOffset);
-
-                while (NVMCTRL_IsBusy() == true)
+                else if ((writeAddress < (uint32_t) BL_STAGING_IMAGE_START)
+                        || (writeAddress > (uint32_t) BL_STAGING_IMAGE_END)
+                        || (((uint32_t)pageCount * NVMCTRL_FLASH_PAGESIZE) > (((uint32_t) BL_STAGING_IMAGE_END + 1U) - writeAddress)))
                 {
+                    bootCommandStatus = BL_ERROR_ADDRESS_OUT_OF_RANGE;
                 }
-
-                NVMCTRL_RegionLock(commandHeader.startAddress + stagingAreaOffset);
-                while (NVMCTRL_IsBusy())
+                else
                 {
-                }
+                    // Pad a partial last page with the erased value
+                    if ((payloadLength % NVMCTRL_FLASH_PAGESIZE) != 0U)
+                    {
+                        (void) memset((void *)&writeBuffer[0], 0xFF, sizeof(writeBuffer));
+                    }
 
-                bootCommandStatus = (writeStatus == true) ? BL_PASS : BL_ERROR_COMMAND_PROCESSING;
+                    (void) memcpy((void *)&writeBuffer[0], (const void *)&commandBuffer[BL_COMMAND_HEADER_SIZE + BL_BLOCK_HEADER_SIZE], (size_t)payloadLength);
+
+                    // The block is acknowledged as soon as the page writes are queued
+                    FlashJobStart(FLASH_PAGE_WRITE, writeAddress, (uint32_t)pageCount * NVMCTRL_FLASH_PAGESIZE);
+                    bootCommandStatus = BL_PASS;
+                }
             }
-            else
+            break;
+        case FILL_FLASH:
+            if (bootloaderCoreUnlocked)
+            {
+                bootCommandStatus = FillBlockProcess(commandBuffer, commandLength);
+            }
+            break;
+        case COMPRESSED_FLASH:
+            if (bootloaderCoreUnlocked)
             {
-                bootCommandStatus = BL_ERROR_ADDRESS_OUT_OF_RANGE;
+                bootCommandStatus = CompressedBlockProcess(commandBuffer, commandLength);
             }
+            break;
+        default:
+            bootCommandStatus = BL_ERROR_UNKNOWN_COMMAND;
+            break;
         }
-        break;
-    default:
-        bootCommandStatus = BL_ERROR_UNKNOWN_COMMAND;
-        break;
     }
 
     return bootCommandStatus;
@@ -188,6 +454,8 @@ void BL_ApplicationStart(void)
 
     /* Do custom deinitialize sequence to free any resources acquired by Bootloader */
 
+    BL_BootTraceMark(BL_BOOT_PHASE_APPLICATION_START);
+
     __set_MSP(msp);
     ASM_VECTOR;
 }
@@ -198,6 +466,9 @@ bl_result_t BL_Initialize(void)
 
     // Prevent the core memory functions from executing until the meta-data has been validated
     bootloaderCoreUnlocked = false;
+    writeBlockSize = 0U;
+    flashJob.state = FLASH_STATE_IDLE;
+    flashJob.status = BL_PASS;
 
     return initResult;
 }
@@ -261,8 +532,10 @@ static bl_result_t BootloaderProcessorUnlock(uint8_t * bufferPtr)
     {
         commandStatus = BL_ERROR_VERIFICATION_FAIL;
     }
-    // Read and compare write size
-    if (metadataPacket.maxPayloadSize != BL_WRITE_BYTE_LENGTH)
+    // Read and compare write size, any whole number of pages that fits in the write buffer is accepted
+    if ((metadataPacket.maxPayloadSize == 0U)
+            || (metadataPacket.maxPayloadSize > (uint16_t) BL_WRITE_BYTE_LENGTH)
+            || ((metadataPacket.maxPayloadSize % NVMCTRL_FLASH_PAGESIZE) != 0U))
     {
         commandStatus = BL_ERROR_VERIFICATION_FAIL;
     }
@@ -275,37 +548,377 @@ static bl_result_t BootloaderProcessorUnlock(uint8_t * bufferPtr)
     if (commandStatus != BL_ERROR_VERIFICATION_FAIL)
     {
         bootloaderCoreUnlocked = true;
+        writeBlockSize = metadataPacket.maxPayloadSize;
         commandStatus = BL_PASS;
-        DownloadAreaErase(BL_STAGING_IMAGE_START);
+        DownloadAreaReset();
+
+        // Every write to the application space is preceded by the unlock, so the old record cannot outlive the image
+        BL_VerifiedMarkerClear();
     }
 
     return commandStatus;
 }
 
-static void DownloadAreaErase(uint32_t startAddress)
+static bl_result_t FillBlockProcess(const uint8_t * commandBuffer, uint16_t commandLength)
 {
-    uint32_t address;
-    address = (uint32_t) startAddress;
+    bl_result_t fillStatus = BL_ERROR_COMMAND_PROCESSING;
+    bl_fill_header_t fillHeader = {0U, 0U, 0U};
+
+    if (commandLength >= (BL_BLOCK_HEADER_SIZE + BL_FILL_HEADER_SIZE))
+    {
+        (void) memcpy((void *)&fillHeader.startAddress, (const void *) &commandBuffer[BL_BLOCK_HEADER_SIZE], (size_t)4U);
+        (void) memcpy((void *)&fillHeader.fillLength, (const void *) &commandBuffer[BL_BLOCK_HEADER_SIZE + 4U], (size_t)4U);
+        (void) memcpy((void *)&fillHeader.fillValue, (const void *) &commandBuffer[BL_BLOCK_HEADER_SIZE + 8U], (size_t)4U);
+    }
+
+    // The fill range is mapped into the download area the same way as the write blocks
+    uint32_t fillAddress = fillHeader.startAddress + (uint32_t) (BL_STAGING_IMAGE_START - BL_APPLICATION_START_ADDRESS);
+
+    if ((fillHeader.fillLength == 0U)
+            || ((fillAddress % NVMCTRL_FLASH_PAGESIZE) != 0U)
+            || ((fillHeader.fillLength % NVMCTRL_FLASH_PAGESIZE) != 0U))
+    {
+        fillStatus = BL_ERROR_COMMAND_PROCESSING;
+    }
+    else if ((fillAddress < (uint32_t) BL_STAGING_IMAGE_START)
+            || (fillAddress > (uint32_t) BL_STAGING_IMAGE_END)
+            || (fillHeader.fillLength > (((uint32_t) BL_STAGING_IMAGE_END + 1U) - fillAddress)))
+    {
+        fillStatus = BL_ERROR_ADDRESS_OUT_OF_RANGE;
+    }
+    else if (fillHeader.fillValue == 0xFFFFFFFFU)
+    {
+        // Erased content only needs the rows of the range to be erased
+        FlashJobStart(FLASH_ROW_ERASE, fillAddress, fillHeader.fillLength);
+        fillStatus = BL_PASS;
+    }
+    else
+    {
+        for (uint32_t wordIndex = 0U; wordIndex < (NVMCTRL_FLASH_PAGESIZE / 4U); wordIndex++)
+        {
+            writeBuffer[wordIndex] = fillHeader.fillValue;
+        }
+
+        FlashJobStart(FLASH_PAGE_FILL, fillAddress, fillHeader.fillLength);
+        fillStatus = BL_PASS;
+    }
+
+    return fillStatus;
+}
+
+static bl_result_t CompressedBlockProcess(const uint8_t * commandBuffer, uint16_t commandLength)
+{
+    bl_result_t decodeStatus = BL_PASS;
+    uint32_t startAddress = 0U;
+    uint16_t outputLength = 0U;
+    uint16_t inputIndex = BL_BLOCK_HEADER_SIZE + BL_COMPRESSED_HEADER_SIZE;
+    uint16_t outputIndex = 0U;
+    uint8_t flags = 0U;
+    uint8_t flagCount = 0U;
+    /* cppcheck-suppress misra-c2012-11.3 */
+    uint8_t * outputPtr = (uint8_t *) &writeBuffer[0];
+
+    if (commandLength > inputIndex)
+    {
+        (void) memcpy((void *)&startAddress, (const void *) &commandBuffer[BL_BLOCK_HEADER_SIZE], (size_t)4U);
+        (void) memcpy((void *)&outputLength, (const void *) &commandBuffer[BL_BLOCK_HEADER_SIZE + 4U], (size_t)2U);
+    }
 
-    while (address < BL_STAGING_IMAGE_END)
+    // The block is mapped into the download area the same way as the write blocks
+    uint32_t writeAddress = startAddress + (uint32_t) (BL_STAGING_IMAGE_START - BL_APPLICATION_START_ADDRESS);
+    uint16_t pageCount = (uint16_t)((outputLength + (NVMCTRL_FLASH_PAGESIZE - 1U)) / NVMCTRL_FLASH_PAGESIZE);
+
+    if ((outputLength == 0U) || (outputLength > writeBlockSize) || ((writeAddress % NVMCTRL_FLASH_PAGESIZE) != 0U))
+    {
+        decodeStatus = BL_ERROR_COMMAND_PROCESSING;
+    }
+    else if ((writeAddress < (uint32_t) BL_STAGING_IMAGE_START)
+            || (writeAddress > (uint32_t) BL_STAGING_IMAGE_END)
+            || (((uint32_t)pageCount * NVMCTRL_FLASH_PAGESIZE) > (((uint32_t) BL_STAGING_IMAGE_END + 1U) - writeAddress)))
+    {
+        decodeStatus = BL_ERROR_ADDRESS_OUT_OF_RANGE;
+    }
+    else if ((outputLength % NVMCTRL_FLASH_PAGESIZE) != 0U)
+    {
+        // Pad a partial last page with the erased value
+        (void) memset((void *)&writeBuffer[0], 0xFF, sizeof(writeBuffer));
+    }
+    else
+    {
+        // Do nothing
+    }
+
+    while ((decodeStatus == BL_PASS) && (outputIndex < outputLength))
     {
-        NVMCTRL_RegionUnlock(address);
-        while (NVMCTRL_IsBusy() == true)
+        if (flagCount == 0U)
         {
+            // Load the flags of the next group
+            if (inputIndex >= commandLength)
+            {
+                decodeStatus = BL_ERROR_COMMAND_PROCESSING;
+                break;
+            }
+            flags = commandBuffer[inputIndex];
+            inputIndex++;
+            flagCount = 8U;
         }
 
-        (void)NVMCTRL_RowErase(address);
-        while (NVMCTRL_IsBusy() == true)
+        if ((flags & 0x01U) == 0U)
+        {
+            if (inputIndex >= commandLength)
+            {
+                decodeStatus = BL_ERROR_COMMAND_PROCESSING;
+            }
+            else
+            {
+                outputPtr[outputIndex] = commandBuffer[inputIndex];
+                inputIndex++;
+                outputIndex++;
+            }
+        }
+        else if ((uint16_t)(inputIndex + 1U) >= commandLength)
         {
+            decodeStatus = BL_ERROR_COMMAND_PROCESSING;
         }
+        else
+        {
+            uint16_t matchToken = (uint16_t)((uint16_t)commandBuffer[inputIndex] | ((uint16_t)commandBuffer[inputIndex + 1U] << 8));
+            uint32_t distance = ((uint32_t)matchToken & 0x0FFFU) + 1U;
+            uint16_t matchLength = (uint16_t)((matchToken >> 12) + 3U);
+            uint32_t sourceAddress = (writeAddress + outputIndex) - distance;
+            // Last byte of the match that is read from the Flash instead of the write buffer
+            uint32_t sourceEndAddress = ((distance - outputIndex) < matchLength) ? (writeAddress - 1U) : (sourceAddress + matchLength - 1U);
+            inputIndex += 2U;
+
+            if ((uint32_t)(outputIndex + matchLength) > outputLength)
+            {
+                decodeStatus = BL_ERROR_COMMAND_PROCESSING;
+            }
+            else if ((distance > outputIndex)
+                    && ((RowIsUpdated(sourceAddress) == false) || (RowIsUpdated(sourceEndAddress) == false)))
+            {
+                // Only rows written in the current update hold data that the encoder could have referenced
+                decodeStatus = BL_ERROR_ADDRESS_OUT_OF_RANGE;
+            }
+            else
+            {
+                uint16_t matchIndex = 0U;
+
+                if (distance > outputIndex)
+                {
+                    // The start of the match is in the Flash written by an earlier block
+                    uint16_t flashLength = (uint16_t)(((distance - outputIndex) < matchLength) ? (distance - outputIndex) : matchLength);
+                    /* cppcheck-suppress misra-c2012-11.3 */
+                    (void) NVMCTRL_Read((uint32_t *) &outputPtr[outputIndex], flashLength, sourceAddress);
+                    outputIndex += flashLength;
+                    matchIndex = flashLength;
+                }
+
+                // The rest of the match repeats bytes already decoded into the write buffer
+                for (; matchIndex < matchLength; matchIndex++)
+                {
+                    outputPtr[outputIndex] = outputPtr[outputIndex - distance];
+                    outputIndex++;
+                }
+            }
+        }
+
+        flags >>= 1U;
+        flagCount--;
+    }
+
+    if (decodeStatus == BL_PASS)
+    {
+        // The block is acknowledged as soon as the page writes are queued
+        FlashJobStart(FLASH_PAGE_WRITE, writeAddress, (uint32_t)pageCount * NVMCTRL_FLASH_PAGESIZE);
+    }
+
+    return decodeStatus;
+}
+
+static void DownloadAreaReset(void)
+{
+    (void) memset((void *)&erasedRowMap[0], 0x00, sizeof(erasedRowMap));
+}
+
+static bool RowIsBlank(uint32_t rowAddress)
+{
+    bool isBlank = true;
+    uint32_t pageData[NVMCTRL_FLASH_PAGESIZE / 4U];
+
+    for (uint32_t pageOffset = 0U; (pageOffset < NVMCTRL_FLASH_ROWSIZE) && (isBlank == true); pageOffset += NVMCTRL_FLASH_PAGESIZE)
+    {
+        (void) NVMCTRL_Read(&pageData[0], NVMCTRL_FLASH_PAGESIZE, rowAddress + pageOffset);
 
-        NVMCTRL_RegionLock(address);
-        while (NVMCTRL_IsBusy() == true)
+        for (uint32_t wordIndex = 0U; (wordIndex < (NVMCTRL_FLASH_PAGESIZE / 4U)) && (isBlank == true); wordIndex++)
         {
+            isBlank = (pageData[wordIndex] == 0xFFFFFFFFU);
         }
+    }
+
+    return isBlank;
+}
+
+static bool RowIsUpdated(uint32_t address)
+{
+    bool isUpdated = false;
+
+    if ((address >= (uint32_t)BL_STAGING_IMAGE_START) && (address <= (uint32_t)BL_STAGING_IMAGE_END))
+    {
+        uint32_t rowIndex = (address - (uint32_t)BL_STAGING_IMAGE_START) / NVMCTRL_FLASH_ROWSIZE;
+        isUpdated = ((erasedRowMap[rowIndex / 32U] & ((uint32_t)1U << (rowIndex % 32U))) != 0U);
+    }
+
+    return isUpdated;
+}
+
+bl_result_t BL_DownloadAreaComplete(void)
+{
+    bl_result_t completeStatus = BL_PASS;
+
+    if (flashJob.state != FLASH_STATE_IDLE)
+    {
+        completeStatus = BL_BUSY;
+    }
+    else if (bootloaderCoreUnlocked)
+    {
+        // Rows written in this update are skipped by the erase
+        FlashJobStart(FLASH_ROW_ERASE, BL_STAGING_IMAGE_START, ((uint32_t)BL_STAGING_IMAGE_END + 1U) - (uint32_t)BL_STAGING_IMAGE_START);
+    }
+    else
+    {
+        // Do nothing, no update is in progress
+    }
+
+    return completeStatus;
+}
+
+static void FlashJobStart(bl_flash_operation_t operation, uint32_t startAddress, uint32_t length)
+{
+    flashJob.operation = operation;
+    flashJob.address = startAddress;
+    flashJob.endAddress = startAddress + length;
+    flashJob.bufferIndex = 0U;
+    flashJob.state = FLASH_STATE_UNLOCK;
+}
+
+static uint32_t SysTickCountGet(void)
+{
+    if ((SysTick->CTRL & SysTick_CTRL_ENABLE_Msk) == 0U)
+    {
+        SYSTICK_TimerPeriodSet(BL_SYSTICK_PERIOD);
+        SYSTICK_TimerStart();
+    }
 
-        address += NVMCTRL_FLASH_ROWSIZE;
+    return SYSTICK_TimerCounterGet();
+}
+
+static void FlashCommandTimerStart(void)
+{
+    flashCommandCount = SysTickCountGet();
+    isFlashCommandTimed = true;
+}
+
+const bl_flash_statistics_t * BL_FlashStatisticsGet(void)
+{
+    return &flashStatistics;
+}
+
+bl_result_t BL_FlashTask(void)
+{
+    // Sample the controller once, so a command is timed before the next one can be started
+    bool isNvmctrlBusy = NVMCTRL_IsBusy();
+
+    // Add the busy time of the last erase or write command once the NVMCTRL has finished it
+    if ((true == isFlashCommandTimed) && (isNvmctrlBusy == false))
+    {
+        uint32_t elapsed = (flashCommandCount - SysTickCountGet()) & (BL_SYSTICK_PERIOD - 1U);
+
+        // Scaled in 64 bits, the SysTick can run slower than 1 MHz and a long erase overflows 32 bits
+        flashStatistics.busyTime += (uint32_t)(((uint64_t) elapsed * 1000000U) / SYSTICK_TimerFrequencyGet());
+        isFlashCommandTimed = false;
+    }
+
+    if ((flashJob.state != FLASH_STATE_IDLE) && (isNvmctrlBusy == false))
+    {
+        switch (flashJob.state)
+        {
+        case FLASH_STATE_UNLOCK:
+            // Clear any error left over from an earlier operation
+            (void) NVMCTRL_ErrorGet();
+            flashJob.regionAddress = flashJob.address;
+            NVMCTRL_RegionUnlock(flashJob.regionAddress);
+            flashJob.state = FLASH_STATE_EXECUTE;
+            break;
+        case FLASH_STATE_EXECUTE:
+        {
+            uint32_t rowIndex = (flashJob.address - (uint32_t)BL_STAGING_IMAGE_START) / NVMCTRL_FLASH_ROWSIZE;
+            uint32_t rowMask = (uint32_t)1U << (rowIndex % 32U);
+
+            // Drop the rest of the range at the first row or page the Flash controller failed to process
+            if (NVMCTRL_ErrorGet() != NVMCTRL_ERROR_NONE)
+            {
+                flashJob.status = BL_ERROR_COMMAND_PROCESSING;
+                flashJob.endAddress = flashJob.address;
+            }
+
+            // The row map only covers the download area, stop before a row outside of it is touched
+            if ((flashJob.address < flashJob.endAddress) && (rowIndex >= BL_STAGING_ROW_COUNT))
+            {
+                flashJob.status = BL_ERROR_ADDRESS_OUT_OF_RANGE;
+                flashJob.endAddress = flashJob.address;
+            }
+
+            if ((flashJob.address >= flashJob.endAddress)
+                    || ((flashJob.address / BL_FLASH_REGION_SIZE) != (flashJob.regionAddress / BL_FLASH_REGION_SIZE)))
+            {
+                NVMCTRL_RegionLock(flashJob.regionAddress);
+                flashJob.state = FLASH_STATE_LOCK;
+            }
+            else if ((erasedRowMap[rowIndex / 32U] & rowMask) == 0U)
+            {
+                uint32_t rowAddress = flashJob.address - (flashJob.address % NVMCTRL_FLASH_ROWSIZE);
+
+                // Erase the row the first time it is touched in this update, unless it is blank already
+                if (RowIsBlank(rowAddress) == false)
+                {
+                    (void) NVMCTRL_RowErase(rowAddress);
+                    FlashCommandTimerStart();
+                    flashStatistics.rowsErased++;
+                }
+                erasedRowMap[rowIndex / 32U] |= rowMask;
+            }
+            else if (flashJob.operation == FLASH_ROW_ERASE)
+            {
+                // The row is erased, move on to the start of the next row
+                flashJob.address = (flashJob.address - (flashJob.address % NVMCTRL_FLASH_ROWSIZE)) + NVMCTRL_FLASH_ROWSIZE;
+            }
+            else
+            {
+                (void) NVMCTRL_PageWrite(&writeBuffer[flashJob.bufferIndex], flashJob.address);
+                FlashCommandTimerStart();
+                flashStatistics.bytesProgrammed += NVMCTRL_FLASH_PAGESIZE;
+
+                // A fill programs the same page of the write buffer over the whole range
+                if (flashJob.operation == FLASH_PAGE_WRITE)
+                {
+                    flashJob.bufferIndex += NVMCTRL_FLASH_PAGESIZE / 4U;
+                }
+                flashJob.address += NVMCTRL_FLASH_PAGESIZE;
+            }
+            break;
+        }
+        case FLASH_STATE_LOCK:
+            // Move on to the next region of the range or finish the operation
+            flashJob.state = (flashJob.address < flashJob.endAddress) ? FLASH_STATE_UNLOCK : FLASH_STATE_IDLE;
+            break;
+        default:
+            flashJob.state = FLASH_STATE_IDLE;
+            break;
+        }
     }
+
+    return (flashJob.state != FLASH_STATE_IDLE) ? BL_BUSY : flashJob.status;
 }
 
 bool BL_CheckForcedEntry(void)
@@ -324,4 +937,91 @@ bool BL_CheckForcedEntry(void)
     }
 
     return false;
-}
\ No newline at end of file
+}
+
+void BL_BootTraceStart(void)
+{
+#if BL_BOOT_TRACE_ENABLED == 1
+    bl_boot_trace_t * bootTrace = (bl_boot_trace_t *) (BL_BOOT_TRACE_START);
+
+    bootTrace->traceKey = BL_BOOT_TRACE_KEY;
+    bootTrace->tickFrequency = SYSTICK_TimerFrequencyGet();
+    bootTrace->phaseMask = 0U;
+    for (uint32_t phase = 0U; phase < (uint32_t) BL_BOOT_PHASE_COUNT; phase++)
+    {
+        bootTrace->timeStamp[phase] = 0U;
+    }
+
+    // Count down over the full 24-bit range instead of the 1 ms period set by SYS_Initialize
+    SYSTICK_TimerPeriodSet(BL_SYSTICK_PERIOD);
+    SYSTICK_TimerStart();
+    bootTraceCount = SYSTICK_TimerCounterGet();
+    bootTraceElapsed = 0U;
+    isBootTraceRunning = true;
+
+    BL_BootTraceMark(BL_BOOT_PHASE_SYS_INITIALIZE);
+#endif
+}
+
+void BL_BootTraceMark(bl_boot_phase_t phase)
+{
+#if BL_BOOT_TRACE_ENABLED == 1
+    bl_boot_trace_t * bootTrace = (bl_boot_trace_t *) (BL_BOOT_TRACE_START);
+
+    if (true == isBootTraceRunning)
+    {
+        BootTraceElapsedUpdate();
+    }
+
+    if (((uint32_t) phase < (uint32_t) BL_BOOT_PHASE_COUNT) && (bootTrace->traceKey == BL_BOOT_TRACE_KEY))
+    {
+        bootTrace->timeStamp[phase] = bootTraceElapsed;
+        bootTrace->phaseMask |= (1UL << (uint32_t) phase);
+    }
+
+    if ((BL_BOOT_PHASE_APPLICATION_START == phase) || (BL_BOOT_PHASE_FTP_START == phase))
+    {
+        isBootTraceRunning = false;
+        SYSTICK_TimerStop();
+        SYSTICK_TimerPeriodSet(SYSTICK_TimerFrequencyGet() / 1000U);
+    }
+#else
+    (void) phase;
+#endif
+}
+
+void BL_BootTraceUpdate(void)
+{
+#if BL_BOOT_TRACE_ENABLED == 1
+    if (true == isBootTraceRunning)
+    {
+        BootTraceElapsedUpdate();
+    }
+#endif
+}
+
+#if BL_BOOT_TRACE_ENABLED == 1
+static void BootTraceElapsedUpdate(void)
+{
+    // Read the wrap flag first so that a wrap between both reads shows up in the count
+    bool periodHasExpired = SYSTICK_TimerPeriodHasExpired();
+    uint32_t count = SYSTICK_TimerCounterGet();
+    uint32_t elapsed = bootTraceCount - count;
+
+    if (count > bootTraceCount)
+    {
+        elapsed = BL_SYSTICK_PERIOD - count + bootTraceCount;
+    }
+    else if (true == periodHasExpired)
+    {
+        // The counter has come back below the last count, so a whole period has passed
+        elapsed += BL_SYSTICK_PERIOD;
+    }
+    else
+    {
+        // No wrap since the last reading
+    }
+    bootTraceCount = count;
+    bootTraceElapsed += elapsed;
+}
+#endif
\ No newline at end of file
@@ -73,7 +73,13 @@
  * @def MAX_RESPONSE_SIZE
  * @brief Length of the largest possible response in bytes.
  */
-#define MAX_RESPONSE_SIZE       (25U)
+#define MAX_RESPONSE_SIZE       (30U)
+/**
+ * @ingroup mdfu_client_ftp
+ * @def STATISTICS_WORD_COUNT
+ * @brief Number of 32-bit counters in the Get Statistics response.
+ */
+#define STATISTICS_WORD_COUNT   (7U)
 /**
  * @ingroup mdfu_client_ftp
  * @def TLV_HEADER_SIZE
@@ -98,6 +104,12 @@
  * @brief Number of buffers supported for reception.
  */
 #define PACKET_BUFFER_COUNT     (1U)
+/**
+ * @ingroup mdfu_client_ftp
+ * @def VERIFY_STEP_SIZE
+ * @brief Maximum number of bytes added to the image CRC on each call of the FTP task.
+ */
+#define VERIFY_STEP_SIZE        (1024U)
 /**
  * @ingroup mdfu_client_ftp
  * @def RETRY_TRANSFER_bm
@@ -153,7 +165,8 @@ typedef enum
     FTP_START_TRANSFER = 0x02U,
     FTP_WRITE_CHUNK = 0x03U,
     FTP_GET_IMAGE_STATE = 0x04U,
-    FTP_END_TRANSFER = 0x05U
+    FTP_END_TRANSFER = 0x05U,
+    FTP_GET_STATISTICS = 0x80U /**< Vendor command that is not defined by the MDFU protocol */
 } ftp_command_t;
 
 /**
@@ -211,6 +224,18 @@ typedef enum
     FTP_IMAGE_INVALID = 0x02U
 } ftp_image_state_t;
 
+/**
+ * @ingroup mdfu_client_ftp
+ * @enum ftp_image_state_step_t
+ * @brief Enumeration of the steps of a Get Image State command that run across several calls of the FTP task.
+ */
+typedef enum
+{
+    IMAGE_STATE_IDLE = 0U, /**< No Get Image State command is waiting for its response */
+    IMAGE_STATE_FLASH = 1U, /**< The rows skipped by the image are being erased */
+    IMAGE_STATE_VERIFY = 2U /**< The hash range of the image is being calculated */
+} ftp_image_state_step_t;
+
 /**
  * @ingroup mdfu_client_ftp
  * @enum tlv_type_code_t
@@ -258,6 +283,21 @@ typedef struct
     uint8_t * valueBuffer; /**< The data buffer to be transferred to the host */
 } ftp_tlv_t;
 
+/**
+ * @ingroup mdfu_client_ftp
+ * @struct ftp_statistics_t
+ * @brief A structure holding the transfer counters reported by the Get Statistics command.
+ *
+ * The counters are cleared when the device is reset and keep counting across updates.
+ */
+typedef struct
+{
+    uint32_t framesReceived; /**< The number of complete frames received from the host */
+    uint32_t frameCheckFailures; /**< The number of received frames that failed the frame check */
+    uint32_t resends; /**< The number of retry responses that asked the host to send a command again */
+    uint32_t duplicateSequences; /**< The number of commands received again with the last sequence number */
+} ftp_statistics_t;
+
 /**
  * @ingroup mdfu_client_ftp
  * @brief Buffer for receiving FTP data.
@@ -290,6 +330,12 @@ static uint8_t FTP_RETRY_BUFFER[MAX_RESPONSE_SIZE];
 static bool resetPending = false;
 static bool isComBusy = false;
 
+/**
+ * @ingroup mdfu_client_ftp
+ * @brief Step of the Get Image State command that is in progress.
+ */
+static ftp_image_state_step_t imageStateStep = IMAGE_STATE_IDLE;
+
 /**
  * @ingroup mdfu_client_ftp
  * @brief Structure manages the FTP parser data.
@@ -303,6 +349,11 @@ static ftp_parser_helper_t ftpHelper = {
 };
 static uint16_t ftpReceiveCount = 0U;
 static uint16_t ftpResponseLength = 0U;
+/**
+ * @ingroup mdfu_client_ftp
+ * @brief Transfer counters reported by the Get Statistics command.
+ */
+static ftp_statistics_t ftpStatistics = {0U, 0U, 0U, 0U};
 
 /**
  * @ingroup mdfu_client_ftp
@@ -348,6 +399,19 @@ static bool SequenceNumberValidate(void);
  * @return None
  */
 static void ClientInfoResponseSet(void);
+/**
+ * @ingroup mdfu_client_ftp
+ * @brief Sets the Get Statistics data in the response buffer.
+ *
+ * The response holds the transfer counters followed by the Flash counters of the bootloader core,
+ * each as a 32-bit little endian value:
+ * frames received, frame check failures, resends, duplicate sequences, bytes programmed, rows erased
+ * and Flash busy time in microseconds.
+ *
+ * @param None
+ * @return None
+ */
+static void StatisticsResponseSet(void);
 
 /**
  * @ingroup mdfu_client_ftp
@@ -415,6 +479,17 @@ static uint8_t TLVAppend(uint8_t * dataBufferStart, ftp_tlv_t * tlvData);
  * @return @ref FTP_GENERIC_ERROR - The bootloader code received has not been mapped to a specific FTP abort code
  */
 static ftp_abort_code_t AbortCodeGet(bl_result_t targetStatus);
+/**
+ * @ingroup mdfu_client_ftp
+ * @brief Runs the next step of the Get Image State command and sets its response once the image state is known.
+ *
+ * The image is verified in chunks of @ref VERIFY_STEP_SIZE bytes, so the communication is serviced between the chunks.
+ *
+ * @param None
+ * @return @ref BL_BUSY - The image state is not known yet
+ * @return Result of the image verification otherwise
+ */
+static bl_result_t ImageStateTask(void);
 
 bl_result_t FTP_Task(void)
 {
@@ -426,11 +501,15 @@ bl_result_t FTP_Task(void)
     ftp_transport_failure_code_t transportStatusResult = FTP_INTEGRITY_CHECK_ERROR;
     com_adapter_result_t comResult = COM_FAIL;
 
+    // Advance the queued Flash operation while the next frame is being received
+    (void) BL_FlashTask();
+
     // Call the command to load the buffer up with the current receive count
     comResult = COM_FrameTransfer((uint8_t *) & FTP_RECEIVE_BUFFER, &ftpReceiveCount);
     /* cppcheck-suppress misra-c2012-10.1; false Positive */
     if ((com_adapter_result_t)COM_BUFFER_ERROR == comResult)
     {
+        ftpStatistics.framesReceived++;
         processResult = BL_ERROR_BUFFER_OVERLOAD;
         ftpHelper.resendRequired = true;
         transportStatusResult = FTP_COMMAND_TOO_LONG_ERROR;
@@ -440,6 +519,7 @@ bl_result_t FTP_Task(void)
     /* cppcheck-suppress misra-c2012-10.1; false Positive */
     else if ((com_adapter_result_t)COM_PASS == comResult)
     {
+        ftpStatistics.framesReceived++;
 
         if (ftpReceiveCount < MIN_TRANSFER_SIZE)
         {
@@ -450,9 +530,17 @@ bl_result_t FTP_Task(void)
         }
         else if (SequenceNumberValidate())
         {
+            // The receive buffer is shared with the transport so the queued Flash operation is finished first
+            while (BL_FlashTask() == BL_BUSY)
+            {
+            }
+
+            // A new command from the host replaces a Get Image State command that has not been answered
+            imageStateStep = IMAGE_STATE_IDLE;
+
             // Call execution to handle the rest of the command processes
             processResult = OperationalBlockExecute();
-            ftpHelper.responseRequired = true;
+            ftpHelper.responseRequired = (imageStateStep == IMAGE_STATE_IDLE);
         }
         else
         {
@@ -463,6 +551,8 @@ bl_result_t FTP_Task(void)
     /* cppcheck-suppress misra-c2012-10.1; false Positive */
     else if ((com_adapter_result_t)COM_TRANSPORT_FAILURE == comResult)
     {
+        ftpStatistics.framesReceived++;
+        ftpStatistics.frameCheckFailures++;
         processResult = BL_ERROR_FRAME_VALIDATION_FAIL;
         ftpHelper.resendRequired = true;
         ResponseSet((uint8_t *) & FTP_RETRY_BUFFER, (uint8_t *) & transportStatusResult, FTP_COMMAND_NOT_EXECUTED, ftpHelper.nextSequenceNumber ^ RETRY_TRANSFER_bm, 1U);
@@ -487,6 +577,12 @@ bl_result_t FTP_Task(void)
         processResult = BL_ERROR_COMMUNICATION_FAIL;
     }
 
+    if (imageStateStep != IMAGE_STATE_IDLE)
+    {
+        // Verify the next chunk of the image, the host polls for the response in between
+        processResult = ImageStateTask();
+    }
+
     if (ftpHelper.resendRequired)
     {
         comResult = COM_FrameSet((uint8_t *) & FTP_RETRY_BUFFER, ftpResponseLength);
@@ -495,6 +591,7 @@ bl_result_t FTP_Task(void)
         {
             processResult = BL_ERROR_COMMUNICATION_FAIL;
         }
+        ftpStatistics.resends++;
         ftpHelper.resendRequired = false;
     }
     else if (ftpHelper.responseRequired)
@@ -541,6 +638,7 @@ static bool SequenceNumberValidate(void)
     else if (ftpHelper.currentSequenceNumber == ftpHelper.lastSequenceNumber)
     {
         // Don't execute the command but resend the response that is already in the buffer
+        ftpStatistics.duplicateSequences++;
         isValidSequenceNum = false;
         ftpHelper.responseRequired = true;
     }
@@ -569,11 +667,18 @@ static bl_result_t OperationalBlockExecute(void)
     }
     case FTP_GET_IMAGE_STATE:
     {
-        processResult = BL_ImageVerify();
-        ftp_image_state_t isImageValid = (processResult == (bl_result_t)BL_PASS) ? FTP_IMAGE_VALID : FTP_IMAGE_INVALID;
-        ResponseSet((uint8_t *) & FTP_RESPONSE_BUFFER, (uint8_t *) & isImageValid, FTP_COMMAND_SUCCESS, ftpHelper.currentSequenceNumber, 1U);
+        // Erase the rows skipped by the image before the download area is verified, the response is set by ImageStateTask
+        (void) BL_DownloadAreaComplete();
+        imageStateStep = IMAGE_STATE_FLASH;
+        processResult = BL_BUSY;
         break;
     }    
+    case FTP_GET_STATISTICS:
+    {
+        StatisticsResponseSet();
+        processResult = BL_PASS;
+        break;
+    }
     case FTP_START_TRANSFER:
     {
         processResult = BL_PASS;
@@ -598,13 +703,27 @@ static bl_result_t OperationalBlockExecute(void)
     }
     case FTP_END_TRANSFER:
     {
-        ResponseSet((uint8_t *) & FTP_RESPONSE_BUFFER, NULL, FTP_COMMAND_SUCCESS, ftpHelper.currentSequenceNumber, 0U);
-        resetPending = true;
+        // Erase the rows skipped by the image and report a queued write that failed after its block was acknowledged
+        (void) BL_DownloadAreaComplete();
+        do
+        {
+            processResult = BL_FlashTask();
+        } while (processResult == BL_BUSY);
+
+        if (processResult == BL_PASS)
+        {
+            ResponseSet((uint8_t *) & FTP_RESPONSE_BUFFER, NULL, FTP_COMMAND_SUCCESS, ftpHelper.currentSequenceNumber, 0U);
+            resetPending = true;
 #ifdef MULTI_STAGE_RESPONSE
-        // Prevent any reset from occurring until the communication layer is working.
-        isComBusy = true;
+            // Prevent any reset from occurring until the communication layer is working.
+            isComBusy = true;
 #endif
-        processResult = BL_PASS;
+        }
+        else
+        {
+            ftp_abort_code_t abortCode = AbortCodeGet(processResult);
+            ResponseSet((uint8_t *) & FTP_RESPONSE_BUFFER, (uint8_t *) & abortCode, FTP_ABORT_TRANSFER, ftpHelper.currentSequenceNumber, 1U);
+        }
         break;
     }
     default:
@@ -618,6 +737,41 @@ static bl_result_t OperationalBlockExecute(void)
     return processResult;
 }
 
+static bl_result_t ImageStateTask(void)
+{
+    bl_result_t verifyStatus = BL_BUSY;
+
+    if (imageStateStep == IMAGE_STATE_FLASH)
+    {
+        bl_result_t flashStatus = BL_FlashTask();
+
+        if (flashStatus == BL_PASS)
+        {
+            verifyStatus = BL_ImageVerifyStart();
+            imageStateStep = IMAGE_STATE_VERIFY;
+        }
+        else
+        {
+            // A failed erase reports the image as invalid
+            verifyStatus = flashStatus;
+        }
+    }
+    else
+    {
+        verifyStatus = BL_ImageVerifyStep(VERIFY_STEP_SIZE);
+    }
+
+    if (verifyStatus != BL_BUSY)
+    {
+        ftp_image_state_t isImageValid = (verifyStatus == (bl_result_t)BL_PASS) ? FTP_IMAGE_VALID : FTP_IMAGE_INVALID;
+        ResponseSet((uint8_t *) & FTP_RESPONSE_BUFFER, (uint8_t *) & isImageValid, FTP_COMMAND_SUCCESS, ftpHelper.currentSequenceNumber, 1U);
+        ftpHelper.responseRequired = true;
+        imageStateStep = IMAGE_STATE_IDLE;
+    }
+
+    return verifyStatus;
+}
+
 static ftp_abort_code_t AbortCodeGet(bl_result_t targetStatus)
 {
     ftp_abort_code_t abortCode = FTP_GENERIC_ERROR;
@@ -645,9 +799,6 @@ static ftp_abort_code_t AbortCodeGet(bl_result_t targetStatus)
 static void ParserDataReset(void)
 {
     ftpReceiveCount = 0x00U;
-    // Clear the transfer buffer
-    const void* result = memset(&FTP_RECEIVE_BUFFER, 0x00, MAX_TRANSFER_SIZE);
-    (void)result; // Explicitly cast to void to indicate the return value is intentionally unused
 }
 
 static void DeviceResetCheck(void)
@@ -774,12 +925,29 @@ static void ClientInfoResponseSet(void)
     (void) TLVAppend(&(FTP_RESPONSE_BUFFER[fileDataOffset]), &ftpMinInterMessageDelayTLVData);
 }
 
+static void StatisticsResponseSet(void)
+{
+    const bl_flash_statistics_t * flashStatistics = BL_FlashStatisticsGet();
+    uint32_t statisticsData[STATISTICS_WORD_COUNT] = {
+        ftpStatistics.framesReceived,
+        ftpStatistics.frameCheckFailures,
+        ftpStatistics.resends,
+        ftpStatistics.duplicateSequences,
+        flashStatistics->bytesProgrammed,
+        flashStatistics->rowsErased,
+        flashStatistics->busyTime,
+    };
+
+    ResponseSet((uint8_t *) & FTP_RESPONSE_BUFFER, (uint8_t *) & statisticsData[0], FTP_COMMAND_SUCCESS, ftpHelper.currentSequenceNumber, (uint16_t) sizeof(statisticsData));
+}
+
 bl_result_t FTP_Initialize(void)
 {
     // Tell com layer the max size of the buffer it can use
     com_adapter_result_t comInitStatus = COM_Initialize((uint16_t)MAX_TRANSFER_SIZE);
     isComBusy = false;
     resetPending = false;
+    imageStateStep = IMAGE_STATE_IDLE;
     /* cppcheck-suppress misra-c2012-10.1; false Positive */
     return ((comInitStatus == (com_adapter_result_t)COM_PASS) ? (bl_result_t)BL_PASS : (bl_result_t)BL_FAIL);
 }
\ No newline at end of file
@@ -138,6 +138,8 @@ void SYS_Initialize ( void* data )
 
     SERCOM3_Initialize();
 
+    DMAC_Initialize();
+
     NVMCTRL_Initialize( );
 
     EVSYS_Initialize();
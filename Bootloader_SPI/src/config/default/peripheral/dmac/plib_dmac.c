@@ -0,0 +1,235 @@
+/*******************************************************************************
+  Direct Memory Access Controller (DMAC) PLIB
+
+  Company
+    Microchip Technology Inc.
+
+  File Name
+    plib_dmac.c
+
+  Summary
+    DMAC PLIB Implementation File.
+
+  Description
+    This file defines the interface to the DMAC peripheral library. The channels
+    are used in polled mode to move the SERCOM3 SPI slave data without CPU involvement.
+
+  Remarks:
+    None.
+
+*******************************************************************************/
+
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2025 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+#include "interrupts.h"
+#include "plib_dmac.h"
+#include <string.h>
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Global Data
+// *****************************************************************************
+// *****************************************************************************
+
+/* Channel descriptors fetched by the DMAC when a channel is enabled */
+static dmac_descriptor_registers_t __ALIGNED(8) descriptor_section[DMAC_CHANNELS_NUMBER] SECTION_DMAC_DESCRIPTOR;
+
+/* Channel descriptors written back by the DMAC when a channel is suspended or disabled */
+static dmac_descriptor_registers_t __ALIGNED(8) write_back_section[DMAC_CHANNELS_NUMBER] SECTION_DMAC_DESCRIPTOR;
+
+/* Block transfer control used by each channel for single block transfers */
+static const uint16_t dmacChannelBlockControl[DMAC_CHANNELS_NUMBER] = {
+    /* Channel 0 - SERCOM3 DATA to memory */
+    (uint16_t)(DMAC_BTCTRL_BLOCKACT_NOACT | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_DSTINC_Msk | DMAC_BTCTRL_VALID_Msk),
+    /* Channel 1 - memory to SERCOM3 DATA */
+    (uint16_t)(DMAC_BTCTRL_BLOCKACT_NOACT | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_SRCINC_Msk | DMAC_BTCTRL_VALID_Msk),
+};
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: DMAC Implementation
+// *****************************************************************************
+// *****************************************************************************
+
+static void DMAC_ChannelEnable(DMAC_CHANNEL channel)
+{
+    /* Clear the write-back section so a transfer that never started reports no data */
+    (void) memset(&write_back_section[channel], 0, sizeof(dmac_descriptor_registers_t));
+
+    DMAC_REGS->DMAC_CHID = (uint8_t)channel;
+
+    /* Clear any flag left over by the previous transfer */
+    DMAC_REGS->DMAC_CHINTFLAG = (uint8_t)(DMAC_CHINTFLAG_TERR_Msk | DMAC_CHINTFLAG_TCMPL_Msk | DMAC_CHINTFLAG_SUSP_Msk);
+
+    DMAC_REGS->DMAC_CHCTRLA |= (uint8_t)DMAC_CHCTRLA_ENABLE_Msk;
+}
+
+void DMAC_Initialize(void)
+{
+    /* Disable the DMAC module and the CRC module */
+    DMAC_REGS->DMAC_CTRL &= (uint16_t)(~DMAC_CTRL_DMAENABLE_Msk);
+    DMAC_REGS->DMAC_CRCCTRL = 0U;
+
+    /* Reset the DMAC module */
+    DMAC_REGS->DMAC_CTRL = (uint16_t)DMAC_CTRL_SWRST_Msk;
+
+    while ((DMAC_REGS->DMAC_CTRL & DMAC_CTRL_SWRST_Msk) == DMAC_CTRL_SWRST_Msk)
+    {
+        // Wait for the reset to complete
+    }
+
+    /* Update the Base address and Write Back address registers */
+    DMAC_REGS->DMAC_BASEADDR = (uint32_t)descriptor_section;
+    DMAC_REGS->DMAC_WRBADDR = (uint32_t)write_back_section;
+
+    /***************** Configure DMA channel 0 - SERCOM3 RX ********************/
+    DMAC_REGS->DMAC_CHID = (uint8_t)DMAC_CHANNEL_0;
+    DMAC_REGS->DMAC_CHCTRLB = DMAC_CHCTRLB_TRIGACT_BEAT | DMAC_CHCTRLB_TRIGSRC_SERCOM3_RX | DMAC_CHCTRLB_LVL(0UL);
+    descriptor_section[DMAC_CHANNEL_0].DMAC_BTCTRL = dmacChannelBlockControl[DMAC_CHANNEL_0];
+
+    /***************** Configure DMA channel 1 - SERCOM3 TX ********************/
+    DMAC_REGS->DMAC_CHID = (uint8_t)DMAC_CHANNEL_1;
+    DMAC_REGS->DMAC_CHCTRLB = DMAC_CHCTRLB_TRIGACT_BEAT | DMAC_CHCTRLB_TRIGSRC_SERCOM3_TX | DMAC_CHCTRLB_LVL(0UL);
+    descriptor_section[DMAC_CHANNEL_1].DMAC_BTCTRL = dmacChannelBlockControl[DMAC_CHANNEL_1];
+
+    /* Enable the DMAC module & Priority Level 0 */
+    DMAC_REGS->DMAC_CTRL = (uint16_t)(DMAC_CTRL_DMAENABLE_Msk | DMAC_CTRL_LVLEN0_Msk);
+}
+
+bool DMAC_ChannelTransfer(DMAC_CHANNEL channel, const void *srcAddr, const void *destAddr, size_t blockSize)
+{
+    bool returnStatus = false;
+
+    if ((false == DMAC_ChannelIsBusy(channel)) && (blockSize != 0U) && (blockSize <= 0xFFFFU))
+    {
+        dmac_descriptor_registers_t *const dmacDescReg = &descriptor_section[channel];
+
+        dmacDescReg->DMAC_BTCTRL = dmacChannelBlockControl[channel];
+        dmacDescReg->DMAC_DESCADDR = 0U;
+
+        /* The DMAC expects the end address of an incrementing source or destination */
+        if ((dmacDescReg->DMAC_BTCTRL & DMAC_BTCTRL_SRCINC_Msk) == DMAC_BTCTRL_SRCINC_Msk)
+        {
+            dmacDescReg->DMAC_SRCADDR = (uint32_t)((uintptr_t)srcAddr + blockSize);
+        }
+        else
+        {
+            dmacDescReg->DMAC_SRCADDR = (uint32_t)((uintptr_t)srcAddr);
+        }
+
+        if ((dmacDescReg->DMAC_BTCTRL & DMAC_BTCTRL_DSTINC_Msk) == DMAC_BTCTRL_DSTINC_Msk)
+        {
+            dmacDescReg->DMAC_DSTADDR = (uint32_t)((uintptr_t)destAddr + blockSize);
+        }
+        else
+        {
+            dmacDescReg->DMAC_DSTADDR = (uint32_t)((uintptr_t)destAddr);
+        }
+
+        /* Byte beats are used, so the block count is the number of bytes */
+        dmacDescReg->DMAC_BTCNT = (uint16_t)blockSize;
+
+        DMAC_ChannelEnable(channel);
+
+        returnStatus = true;
+    }
+
+    return returnStatus;
+}
+
+bool DMAC_ChannelLinkedListTransfer(DMAC_CHANNEL channel, const dmac_descriptor_registers_t *channelDesc)
+{
+    bool returnStatus = false;
+
+    if ((channelDesc != NULL) && (false == DMAC_ChannelIsBusy(channel)))
+    {
+        (void) memcpy(&descriptor_section[channel], channelDesc, sizeof(dmac_descriptor_registers_t));
+
+        DMAC_ChannelEnable(channel);
+
+        returnStatus = true;
+    }
+
+    return returnStatus;
+}
+
+bool DMAC_ChannelIsBusy(DMAC_CHANNEL channel)
+{
+    DMAC_REGS->DMAC_CHID = (uint8_t)channel;
+
+    return ((DMAC_REGS->DMAC_CHCTRLA & DMAC_CHCTRLA_ENABLE_Msk) != 0U);
+}
+
+void DMAC_ChannelDisable(DMAC_CHANNEL channel)
+{
+    DMAC_REGS->DMAC_CHID = (uint8_t)channel;
+
+    DMAC_REGS->DMAC_CHCTRLA &= (uint8_t)(~DMAC_CHCTRLA_ENABLE_Msk);
+
+    while ((DMAC_REGS->DMAC_CHCTRLA & DMAC_CHCTRLA_ENABLE_Msk) != 0U)
+    {
+        // Wait for the channel to stop and the write-back descriptor to be updated
+    }
+}
+
+uint16_t DMAC_ChannelGetTransferredCount(DMAC_CHANNEL channel)
+{
+    uint16_t transferredCount = 0U;
+
+    /* A cleared write-back descriptor means the transfer never started */
+    if (write_back_section[channel].DMAC_BTCTRL != 0U)
+    {
+        transferredCount = descriptor_section[channel].DMAC_BTCNT - write_back_section[channel].DMAC_BTCNT;
+    }
+
+    return transferredCount;
+}
+
+uint16_t DMAC_ChannelLinkedListTransferredCountGet(DMAC_CHANNEL channel, const dmac_descriptor_registers_t *channelDesc)
+{
+    uint16_t transferredCount = 0U;
+    uint16_t completedCount = 0U;
+    const dmac_descriptor_registers_t *workDesc = channelDesc;
+    const dmac_descriptor_registers_t *const writeBackDesc = &write_back_section[channel];
+
+    /* The write-back section holds the descriptor that was active when the channel stopped */
+    while (workDesc != NULL)
+    {
+        if ((writeBackDesc->DMAC_SRCADDR == workDesc->DMAC_SRCADDR) && (writeBackDesc->DMAC_DSTADDR == workDesc->DMAC_DSTADDR))
+        {
+            transferredCount = completedCount + (workDesc->DMAC_BTCNT - writeBackDesc->DMAC_BTCNT);
+            workDesc = NULL;
+        }
+        else
+        {
+            completedCount += workDesc->DMAC_BTCNT;
+            /* cppcheck-suppress misra-c2012-11.4 */
+            workDesc = (const dmac_descriptor_registers_t *)workDesc->DMAC_DESCADDR;
+        }
+    }
+
+    return transferredCount;
+}
@@ -0,0 +1,159 @@
+/*******************************************************************************
+  Direct Memory Access Controller (DMAC) PLIB
+
+  Company
+    Microchip Technology Inc.
+
+  File Name
+    plib_dmac.h
+
+  Summary
+    DMAC PLIB Header File.
+
+  Description
+    This file provides the API declarations for moving SERCOM3 SPI slave data with the DMAC.
+
+  Remarks:
+    None.
+
+*******************************************************************************/
+
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2025 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+#ifndef PLIB_DMAC_H
+#define PLIB_DMAC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <device.h>
+
+// DOM-IGNORE-BEGIN
+#ifdef __cplusplus // Provide C++ Compatibility
+
+extern "C" {
+
+#endif
+
+// DOM-IGNORE-END
+
+/**
+ * @brief Number of DMAC channels used by the application.
+ */
+#define DMAC_CHANNELS_NUMBER        (2U)
+
+/**
+ * @brief DMAC channels used by the application.
+ *
+ * Channel 0 is triggered by the SERCOM3 receive complete flag and moves bytes out of the SPI data register.
+ * Channel 1 is triggered by the SERCOM3 data register empty flag and moves bytes into the SPI data register.
+ */
+typedef enum
+{
+    DMAC_CHANNEL_0 = 0U,
+    DMAC_CHANNEL_1 = 1U,
+} DMAC_CHANNEL;
+
+/**
+ * @brief This function configures the DMAC module and the channels used by the application.
+ *
+ * @return None.
+ */
+void DMAC_Initialize(void);
+
+/**
+ * @brief Starts a single block transfer on the given channel.
+ *
+ * The source and destination addresses are the start addresses of the transfer. The end
+ * addresses required by the DMAC are computed from the address increment settings of the channel.
+ *
+ * @param channel DMAC channel to be used.
+ * @param srcAddr Start address of the source.
+ * @param destAddr Start address of the destination.
+ * @param blockSize Number of bytes to be transferred.
+ * @return true if the transfer was started, false if the channel is busy.
+ */
+bool DMAC_ChannelTransfer(DMAC_CHANNEL channel, const void *srcAddr, const void *destAddr, size_t blockSize);
+
+/**
+ * @brief Starts a linked list transfer on the given channel.
+ *
+ * The first descriptor is copied into the channel descriptor section. The following descriptors are
+ * fetched by the DMAC through the next descriptor address and must remain valid until the transfer ends.
+ * The source and destination addresses in the descriptors must be the end addresses of each block.
+ *
+ * @param channel DMAC channel to be used.
+ * @param channelDesc Pointer to the first descriptor of the list.
+ * @return true if the transfer was started, false if the channel is busy.
+ */
+bool DMAC_ChannelLinkedListTransfer(DMAC_CHANNEL channel, const dmac_descriptor_registers_t *channelDesc);
+
+/**
+ * @brief Checks if a transfer is in progress on the given channel.
+ *
+ * @param channel DMAC channel to be checked.
+ * @return true if the channel is enabled, false otherwise.
+ */
+bool DMAC_ChannelIsBusy(DMAC_CHANNEL channel);
+
+/**
+ * @brief Stops the transfer on the given channel.
+ *
+ * This function blocks until the channel has stopped and the write-back descriptor has been updated.
+ *
+ * @param channel DMAC channel to be stopped.
+ * @return None.
+ */
+void DMAC_ChannelDisable(DMAC_CHANNEL channel);
+
+/**
+ * @brief Gets the number of bytes moved by the last single block transfer.
+ *
+ * @note The channel must be stopped before calling this function.
+ *
+ * @param channel DMAC channel to be checked.
+ * @return Number of bytes transferred.
+ */
+uint16_t DMAC_ChannelGetTransferredCount(DMAC_CHANNEL channel);
+
+/**
+ * @brief Gets the number of bytes moved by the last linked list transfer.
+ *
+ * @note The channel must be stopped before calling this function.
+ *
+ * @param channel DMAC channel to be checked.
+ * @param channelDesc Pointer to the first descriptor of the list used to start the transfer.
+ * @return Number of bytes transferred over all of the descriptors.
+ */
+uint16_t DMAC_ChannelLinkedListTransferredCountGet(DMAC_CHANNEL channel, const dmac_descriptor_registers_t *channelDesc);
+
+// DOM-IGNORE-BEGIN
+#ifdef __cplusplus
+}
+#endif
+// DOM-IGNORE-END
+
+#endif /* PLIB_DMAC_H */
@@ -68,10 +68,11 @@
 
 void SERCOM3_Initialize(void)
 {
-    // CHSIZE - 8_BIT, PLOADEN - 1, RXEN - 1
+    // CHSIZE - 8_BIT, PLOADEN - 1, SSDE - 1, RXEN - 1
     SERCOM3_REGS->SPIS.SERCOM_CTRLB = 
         SERCOM_SPIS_CTRLB_CHSIZE_8_BIT
         | SERCOM_SPIS_CTRLB_PLOADEN_Msk
+        | SERCOM_SPIS_CTRLB_SSDE_Msk
         | SERCOM_SPIS_CTRLB_RXEN_Msk;
 
     // Wait for synchronization
@@ -142,5 +143,49 @@ uint8_t SERCOM3_IsRxReady(void)
     return ((SERCOM3_REGS->SPIS.SERCOM_INTFLAG & SERCOM_SPIS_INTFLAG_RXC_Msk) != 0U) ? 1 : 0;
 }
 
+// Returns 1 if the chip select has been asserted since the flag was last cleared, 0 if not
+uint8_t SERCOM3_IsTransferStarted(void)
+{
+    return ((SERCOM3_REGS->SPIS.SERCOM_INTFLAG & SERCOM_SPIS_INTFLAG_SSL_Msk) != 0U) ? 1 : 0;
+}
+
+// Clears the chip select asserted flag
+void SERCOM3_TransferStartClear(void)
+{
+    SERCOM3_REGS->SPIS.SERCOM_INTFLAG = (uint8_t)SERCOM_SPIS_INTFLAG_SSL_Msk;
+}
 
+// Returns the address of the data register used as the DMAC source and destination
+void * SERCOM3_DataAddressGet(void)
+{
+    /* cppcheck-suppress misra-c2012-11.8 */
+    return (void *)&SERCOM3_REGS->SPIS.SERCOM_DATA;
+}
 
+// Drops any data left in the receive and transmit buffers once a transaction has ended
+void SERCOM3_BufferFlush(void)
+{
+    while ((SERCOM3_REGS->SPIS.SERCOM_INTFLAG & SERCOM_SPIS_INTFLAG_RXC_Msk) != 0U)
+    {
+        (void) SERCOM3_REGS->SPIS.SERCOM_DATA;
+    }
+
+    // Clear the overflow raised by bytes that could not be received
+    SERCOM3_REGS->SPIS.SERCOM_STATUS = (uint16_t)SERCOM_SPIS_STATUS_BUFOVF_Msk;
+    SERCOM3_REGS->SPIS.SERCOM_INTFLAG = (uint8_t)SERCOM_SPIS_INTFLAG_ERROR_Msk;
+
+    // A byte still waiting in the data register would be shifted out at the start of the next transaction
+    if ((SERCOM3_REGS->SPIS.SERCOM_INTFLAG & SERCOM_SPIS_INTFLAG_DRE_Msk) == 0U)
+    {
+        SERCOM3_REGS->SPIS.SERCOM_CTRLA &= ~SERCOM_SPIS_CTRLA_ENABLE_Msk;
+        while (SERCOM3_REGS->SPIS.SERCOM_SYNCBUSY != 0U)
+        {
+            // Do nothing
+        }
+        SERCOM3_REGS->SPIS.SERCOM_CTRLA |= SERCOM_SPIS_CTRLA_ENABLE_Msk;
+        while (SERCOM3_REGS->SPIS.SERCOM_SYNCBUSY != 0U)
+        {
+            // Do nothing
+        }
+    }
+}
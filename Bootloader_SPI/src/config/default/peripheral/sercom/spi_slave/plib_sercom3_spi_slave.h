@@ -108,6 +108,38 @@ uint8_t SERCOM3_IsTxReady(void);
  */
 uint8_t SERCOM3_IsRxReady(void);
 
+/**
+ * @brief Checks if the chip select has been asserted since the flag was last cleared.
+ *
+ * @return 1 if a transaction has started, 0 otherwise.
+ */
+uint8_t SERCOM3_IsTransferStarted(void);
+
+/**
+ * @brief Clears the flag set when the chip select is asserted.
+ *
+ * @return None.
+ */
+void SERCOM3_TransferStartClear(void);
+
+/**
+ * @brief Gets the address of the SPI data register.
+ *
+ * This address is used as the fixed source or destination of the DMAC transfers.
+ *
+ * @return Address of the SPI data register.
+ */
+void * SERCOM3_DataAddressGet(void);
+
+/**
+ * @brief Drops any data left in the SPI receive and transmit buffers.
+ *
+ * This function must only be called while the chip select is de-asserted.
+ *
+ * @return None.
+ */
+void SERCOM3_BufferFlush(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -36,6 +36,7 @@
 
 #include "com_adapter.h"
 #include "peripheral/sercom/usart/plib_sercom1_usart.h"
+#include "peripheral/systick/plib_systick.h"
 #include <stdbool.h>
 
 /**
@@ -60,6 +61,13 @@
  */
 #define ESCAPE_BYTE             (0xCCU)
 
+/**
+ * @ingroup com_adapter_uart
+ * @def COM_SYSTICK_PERIOD
+ * @brief Number of SysTick ticks in one period of the free running counter, the same period as used by the bootloader core.
+ */
+#define COM_SYSTICK_PERIOD      (0x01000000U)
+
 typedef struct
 {
     uint8_t EscapeCharacter;
@@ -95,120 +103,230 @@ static bool isReceiveWindowOpen = false;
 static bool isEscapedByte = false;
 /**
  * @ingroup com_adapter_uart
- * @brief Abstracted UART write function for sending a single byte.
+ * @brief Running sum of the bytes loaded into the buffer since the start of packet, including the frame check bytes.
+ */
+static uint32_t frameCheckSum = 0U;
+/**
+ * @ingroup com_adapter_uart
+ * @brief Flag indicating that the link runs at a new baud rate that has not been confirmed by a valid frame yet.
+ */
+static bool isBaudRateUnconfirmed = false;
+/**
+ * @ingroup com_adapter_uart
+ * @brief SysTick count read by the last check of the baud rate timeout.
+ */
+static uint32_t baudRateTickCount = 0U;
+/**
+ * @ingroup com_adapter_uart
+ * @brief SysTick ticks elapsed since the switch to the new baud rate.
+ */
+static uint32_t baudRateElapsedTicks = 0U;
+/**
+ * @ingroup com_adapter_uart
+ * @brief Flag indicating that a frame has been queued for transmission and its completion has not been reported yet.
+ */
+static bool isFrameSending = false;
+/**
+ * @ingroup com_adapter_uart
+ * @brief Queues a single byte into the transmit ring buffer of the PLIB.
+ *
+ * The byte is sent by the data register empty interrupt. This function only waits while the ring buffer is full.
  *
  * @param [in] data - Data byte to be transferred over UART
- * @return @ref COM_PASS - Data transfer did not encounter any errors \n
- * @return @ref COM_FAIL - Data transfer encounter an errors. The peripheral returned an error after attempting to transmit data \n
+ * @return None
+ */
+static void DataQueue(uint8_t data);
+
+/**
+ * @ingroup com_adapter_uart
+ * @brief Checks if the last queued byte has been shifted out on the TX line.
+ *
+ * @param None
+ * @return True - The transmit ring buffer is empty and the transmission is complete
+ * @return False - Bytes are still waiting in the ring buffer or on the line
  */
-static com_adapter_result_t DataSend(uint8_t data);
+static bool FrameSendIsFinished(void);
 
 /**
  * @ingroup com_adapter_uart
  * @brief Calculate the frame check on the given data buffer
  *
+ * The data is summed as little endian 16-bit words. Word aligned data is read 32 bits at a time.
+ *
  * @note For more information on the frame check used by the FTP refer to the MDFU protocol document version 1.0.0.
  *
  * @param [in] ftpData Data buffer to be used for the frame check calculation
  * @param [in] bufferLength Length of data objects in the buffer
  * @return Calculated frame check
  */
-static uint16_t FrameCheckCalculate(uint8_t * ftpData, uint16_t bufferLength);
+static uint16_t FrameCheckCalculate(const uint8_t * ftpData, uint16_t bufferLength);
+
+/**
+ * @ingroup com_adapter_uart
+ * @brief Gets the value a frame byte adds to the frame check sum.
+ *
+ * Bytes at even offsets of the frame are the low byte of a little endian word and bytes at odd offsets the high byte.
+ *
+ * @param [in] data - Byte of the frame
+ * @param [in] byteIndex - Offset of the byte from the start of the frame
+ * @return Value to be added to the frame check sum
+ */
+static uint32_t FrameCheckTermGet(uint8_t data, uint16_t byteIndex);
+
+/**
+ * @ingroup com_adapter_uart
+ * @brief Runs a single received byte through the frame decoder.
+ *
+ * This function handles the start of packet, end of packet and escape characters and routes
+ * the data bytes into the given buffer. The frame check is summed as the bytes are stored, so it is
+ * validated in constant time once the end of packet is seen.
+ *
+ * @param [in] nextByte - Byte read out of the receive ring buffer
+ * @param [in,out] receiveBufferPtr - Pointer to the buffer the frame is loaded into
+ * @param [in,out] receiveIndexPtr - Pointer to the number of bytes loaded into the buffer
+ * @return @ref COM_PASS - A complete frame with a valid frame check has been received \n
+ * @return @ref COM_BUSY - The frame is still being loaded \n
+ * @return @ref COM_BUFFER_ERROR - The frame is longer than the buffer \n
+ * @return @ref COM_TRANSPORT_FAILURE - A complete frame has been received but the frame check failed \n
+ * @return @ref COM_FAIL - The byte was received outside of a frame \n
+ */
+static com_adapter_result_t FrameByteDecode(uint8_t nextByte, uint8_t *receiveBufferPtr, uint16_t *receiveIndexPtr);
+
+/**
+ * @ingroup com_adapter_uart
+ * @brief Adds the time since the last call to the time at the new baud rate.
+ *
+ * The SysTick counter runs freely, so this function must be called more often than once per period of the counter.
+ *
+ * @param None
+ * @return True - No valid frame has been received within @ref COM_BAUD_RATE_TIMEOUT \n
+ * @return False - The timeout has not elapsed yet \n
+ */
+static bool BaudRateTimeoutCheck(void);
+
+/**
+ * @ingroup com_adapter_uart
+ * @brief Sets SERCOM1 up at the default baud rate with an empty receive ring buffer.
+ *
+ * When @ref COM_FLOW_CONTROL_ENABLED is set, RTS and CTS are turned on again after the PLIB initialization.
+ *
+ * @param None
+ * @return None
+ */
+static void SerialInitialize(void);
 
-static uint16_t FrameCheckCalculate(uint8_t * ftpData, uint16_t bufferLength)
+static void SerialInitialize(void)
 {
-    uint16_t numBytesChecksummed = 0x0000U;
-    uint16_t checksum = 0x0000U;
+    SERCOM1_USART_Initialize();
+#if (COM_FLOW_CONTROL_ENABLED == 1)
+    SERCOM1_USART_FlowControlEnable();
+#endif
+}
 
-    while (numBytesChecksummed < (bufferLength))
-    {
-        if ((numBytesChecksummed % 2U) == 0U)
-        {
-            checksum += ((uint16_t) (ftpData[numBytesChecksummed]));
-        }
-        else
-        {
-            checksum += (uint16_t)(((uint16_t)ftpData[numBytesChecksummed]) << 8);
-        }
-        numBytesChecksummed++;
-    }
+static bool BaudRateTimeoutCheck(void)
+{
+    uint32_t tickCount = SYSTICK_TimerCounterGet();
 
-    return ~checksum;
+    // The SysTick counts down
+    baudRateElapsedTicks += (baudRateTickCount - tickCount) & (COM_SYSTICK_PERIOD - 1U);
+    baudRateTickCount = tickCount;
+
+    return (baudRateElapsedTicks >= (COM_BAUD_RATE_TIMEOUT * (SYSTICK_TimerFrequencyGet() / 1000U)));
 }
 
-static com_adapter_result_t DataSend(uint8_t data)
+static uint16_t FrameCheckCalculate(const uint8_t * ftpData, uint16_t bufferLength)
 {
-    com_adapter_result_t status = COM_PASS;
+    uint32_t checksum = 0U;
+    uint16_t byteIndex = 0U;
 
-    while (!SERCOM1_USART_TransmitterIsReady())
+    // Aligned data is summed one 32-bit word, so two little endian halfwords, at a time
+    /* cppcheck-suppress misra-c2012-11.4 */
+    if ((((uint32_t)ftpData) % 4U) == 0U)
     {
-        // Wait for TX to be ready
-    };
-    // Call to send the next byte
-    SERCOM1_USART_WriteByte((int)data);
-    if (0U != SERCOM1_USART_ErrorGet())
+        /* cppcheck-suppress misra-c2012-11.3 */
+        const uint32_t * wordPtr = (const uint32_t *) ftpData;
+
+        while (((uint32_t)byteIndex + 4U) <= bufferLength)
+        {
+            uint32_t dataWord = *wordPtr;
+            checksum += (dataWord & 0xFFFFU) + (dataWord >> 16);
+            wordPtr++;
+            byteIndex += 4U;
+        }
+    }
+
+    while (((uint32_t)byteIndex + 2U) <= bufferLength)
     {
-        status = COM_FAIL;
+        checksum += (uint32_t)ftpData[byteIndex] | ((uint32_t)ftpData[byteIndex + 1U] << 8);
+        byteIndex += 2U;
     }
 
-    while (!SERCOM1_USART_TransmitComplete())
+    // An odd length leaves a last byte in the low half of a word
+    if (byteIndex < bufferLength)
     {
-        // Block until last byte shifts out
+        checksum += (uint32_t)ftpData[byteIndex];
     }
 
-    return status;
+    return (uint16_t)(~checksum);
 }
 
-com_adapter_result_t COM_FrameTransfer(uint8_t *receiveBufferPtr, uint16_t *receiveIndexPtr)
+static uint32_t FrameCheckTermGet(uint8_t data, uint16_t byteIndex)
 {
-    uint8_t nextByte = 0U;
-    com_adapter_result_t processResult = COM_FAIL;
+    return ((uint32_t)data << (((uint32_t)byteIndex & 1U) * 8U));
+}
 
-    if ((NULL == receiveBufferPtr) || (NULL == receiveIndexPtr))
+static void DataQueue(uint8_t data)
+{
+    while (0U == SERCOM1_USART_Write(&data, 1U))
     {
-        processResult = COM_INVALID_ARG;
+        // Wait for the interrupt to make room in the ring buffer
     }
-    else
+}
+
+static bool FrameSendIsFinished(void)
+{
+    // The TXC flag is only set once the last byte has left the shift register
+    return ((0U == SERCOM1_USART_WriteCountGet()) && SERCOM1_USART_TransmitComplete());
+}
+
+static com_adapter_result_t FrameByteDecode(uint8_t nextByte, uint8_t *receiveBufferPtr, uint16_t *receiveIndexPtr)
+{
+    com_adapter_result_t processResult = COM_FAIL;
+
+    if (nextByte == ftpSpecialCharacters.StartOfPacketCharacter)
     {
-        if (true == SERCOM1_USART_ReceiverIsReady())
-        {
-            nextByte = (uint8_t)SERCOM1_USART_ReadByte();
+        // Open the buffer window
+        isReceiveWindowOpen = true;
+        isEscapedByte = false;
+        // Reset the buffer index
+        *receiveIndexPtr = 0U;
+        frameCheckSum = 0U;
 
-            processResult = (0U == SERCOM1_USART_ErrorGet()) ? COM_PASS : COM_FAIL;
-        }
+        processResult = COM_BUSY;
     }
-
-    if (COM_PASS == processResult)
+    else if (isReceiveWindowOpen)
     {
-    	if (nextByte == ftpSpecialCharacters.StartOfPacketCharacter)
+        if (nextByte == ftpSpecialCharacters.EndOfPacketCharacter)
         {
-            // Open the buffer window
-            isReceiveWindowOpen = true;
-            isEscapedByte = false;
-            // Reset the buffer index
-            *receiveIndexPtr = 0U;
+            // Close the buffer window
+            isReceiveWindowOpen = false;
 
-            processResult = COM_BUSY;
-        }
-        else if (isReceiveWindowOpen)
-        {
-        	if (nextByte == ftpSpecialCharacters.EndOfPacketCharacter)
+            if (*receiveIndexPtr < FRAME_CHECK_SIZE)
+            {
+                // The frame is too short to hold a frame check
+                processResult = COM_TRANSPORT_FAILURE;
+            }
+            else
             {
-                // Close the buffer window
-                isReceiveWindowOpen = false;
-
-                // Calculate the frame check here
-                uint16_t fcs = FrameCheckCalculate(receiveBufferPtr, *receiveIndexPtr - FRAME_CHECK_SIZE);
-
                 // Read FCS from the transfer buffer
-                uint8_t *startOfWord = &receiveBufferPtr[*receiveIndexPtr - FRAME_CHECK_SIZE];
-                uint16_t frameCheckSequence = 0x0000U;
-                uint8_t * workPtr = startOfWord;
-                uint8_t lowByte = *workPtr;
-                workPtr++;
-                uint8_t highByte = *workPtr;
-                frameCheckSequence = (uint16_t)((uint16_t)((uint16_t)highByte << 8) | lowByte);
+                uint16_t frameCheckIndex = *receiveIndexPtr - FRAME_CHECK_SIZE;
+                uint8_t lowByte = receiveBufferPtr[frameCheckIndex];
+                uint8_t highByte = receiveBufferPtr[frameCheckIndex + 1U];
+                uint16_t frameCheckSequence = (uint16_t)((uint16_t)((uint16_t)highByte << 8) | lowByte);
 
+                // The running sum also holds the frame check bytes, take them back out before the compare
+                uint32_t dataCheckSum = frameCheckSum - FrameCheckTermGet(lowByte, frameCheckIndex) - FrameCheckTermGet(highByte, frameCheckIndex + 1U);
+                uint16_t fcs = (uint16_t)(~dataCheckSum);
 
                 if (fcs == frameCheckSequence)
                 {
@@ -221,39 +339,36 @@ com_adapter_result_t COM_FrameTransfer(uint8_t *receiveBufferPtr, uint16_t *rece
                     processResult = COM_TRANSPORT_FAILURE;
                 }
             }
-            else if (nextByte == ftpSpecialCharacters.EscapeCharacter)
+        }
+        else if (nextByte == ftpSpecialCharacters.EscapeCharacter)
+        {
+            isEscapedByte = true;
+            processResult = COM_BUSY;
+        }
+        else
+        {
+            // If escape was flagged perform the bit flip to correct the byte
+            if (isEscapedByte)
+            {
+                nextByte = ~nextByte;
+                isEscapedByte = false;
+            }
+
+            // Route the byte into the transfer buffer
+            if (*receiveIndexPtr < MaxBufferLength)
             {
-                isEscapedByte = true;
+                receiveBufferPtr[*receiveIndexPtr] = nextByte;
+                frameCheckSum += FrameCheckTermGet(nextByte, *receiveIndexPtr);
+                (*receiveIndexPtr)++;
                 processResult = COM_BUSY;
             }
             else
             {
-                // If escape was flagged perform the bit flip to correct the byte
-                if (isEscapedByte)
-                {
-                    nextByte = ~nextByte;
-                    isEscapedByte = false;
-                }
-
-                // Route the byte into the transfer buffer
-                if (*receiveIndexPtr < MaxBufferLength)
-                {
-                    receiveBufferPtr[*receiveIndexPtr] = nextByte;
-                    (*receiveIndexPtr)++;
-                    processResult = COM_BUSY;
-                }
-                else
-                {
-                    // Close the buffer window
-                    isReceiveWindowOpen = false;
-                    processResult = COM_BUFFER_ERROR;
-                }
+                // Close the buffer window
+                isReceiveWindowOpen = false;
+                processResult = COM_BUFFER_ERROR;
             }
         }
-        else
-        {
-            processResult = COM_FAIL;
-        }
     }
     else
     {
@@ -263,6 +378,69 @@ com_adapter_result_t COM_FrameTransfer(uint8_t *receiveBufferPtr, uint16_t *rece
     return processResult;
 }
 
+com_adapter_result_t COM_FrameTransfer(uint8_t *receiveBufferPtr, uint16_t *receiveIndexPtr)
+{
+    uint8_t nextByte = 0U;
+    com_adapter_result_t processResult = COM_FAIL;
+    bool isFrameClosed = false;
+
+    if ((NULL == receiveBufferPtr) || (NULL == receiveIndexPtr))
+    {
+        processResult = COM_INVALID_ARG;
+    }
+    else
+    {
+        // Drain the bytes collected by the receive interrupt until the ring buffer is empty or a frame is closed
+        while ((false == isFrameClosed) && (1U == SERCOM1_USART_Read(&nextByte, 1U)))
+        {
+            // The receive interrupt keeps parity, framing and overrun errors, the frame they hit is not trusted
+            if ((USART_ERROR_NONE != SERCOM1_USART_ErrorGet()) && isReceiveWindowOpen)
+            {
+                isReceiveWindowOpen = false;
+                isEscapedByte = false;
+                processResult = COM_TRANSPORT_FAILURE;
+            }
+            else
+            {
+                processResult = FrameByteDecode(nextByte, receiveBufferPtr, receiveIndexPtr);
+            }
+
+            // Leave the bytes of the next frame in the ring buffer until the FTP layer provides a new buffer
+            isFrameClosed = ((COM_BUSY != processResult) && (COM_FAIL != processResult));
+        }
+
+        // A received frame is reported first, the completion of the response stays pending until the next call
+        if ((false == isFrameClosed) && isFrameSending && FrameSendIsFinished())
+        {
+            isFrameSending = false;
+            processResult = COM_SEND_COMPLETE;
+        }
+
+        if (isBaudRateUnconfirmed)
+        {
+            if (COM_PASS == processResult)
+            {
+                // The host talks at the new baud rate
+                isBaudRateUnconfirmed = false;
+            }
+            else if (BaudRateTimeoutCheck())
+            {
+                // The host has not switched, restore the configured baud rate and drop the bytes received so far
+                SerialInitialize();
+                isReceiveWindowOpen = false;
+                isEscapedByte = false;
+                isBaudRateUnconfirmed = false;
+            }
+            else
+            {
+                // Keep waiting for a valid frame
+            }
+        }
+    }
+
+    return processResult;
+}
+
 com_adapter_result_t COM_FrameSet(uint8_t *responseBufferPtr, uint16_t responseLength)
 {
     com_adapter_result_t processResult = COM_FAIL;
@@ -275,61 +453,90 @@ com_adapter_result_t COM_FrameSet(uint8_t *responseBufferPtr, uint16_t responseL
     {
         // Integrity Check
         uint16_t frameCheck = FrameCheckCalculate(responseBufferPtr, responseLength);
+        uint8_t nextByte;
+        uint16_t sentByteCount = 0x00U;
 
-        processResult = DataSend(ftpSpecialCharacters.StartOfPacketCharacter);
+        // The frame is escaped once into the transmit ring buffer, the interrupt sends it while the next frame is received
+        DataQueue(ftpSpecialCharacters.StartOfPacketCharacter);
 
-        if (COM_PASS == processResult)
+        while (sentByteCount < (responseLength + FRAME_CHECK_SIZE))
         {
-            uint8_t nextByte;
-            uint16_t sentByteCount = 0x00U;
+            if (sentByteCount == responseLength)
+            {
+                // send the low byte first
+                nextByte = (uint8_t) (frameCheck & 0x00FFU);
+            }
+            else if (sentByteCount == (responseLength + 1U))
+            {
+                // send the high byte first
+                nextByte = (uint8_t) (frameCheck >> 8);
+            }
+            else
+            {
+                nextByte = responseBufferPtr[sentByteCount];
+            }
 
-            while (sentByteCount < (responseLength + FRAME_CHECK_SIZE))
+            if ((START_OF_PACKET_BYTE == nextByte) || (END_OF_PACKET_BYTE == nextByte) || (ESCAPE_BYTE == nextByte))
             {
-                if (sentByteCount == responseLength)
-                {
-                    // send the low byte first
-                    nextByte = (uint8_t) (frameCheck & 0x00FFU);
-                }
-                else if (sentByteCount == (responseLength + 1U))
-                {
-                    // send the high byte first
-                    nextByte = (uint8_t) (frameCheck >> 8);
-                }
-                else
-                {
-                    nextByte = responseBufferPtr[sentByteCount];
-                }
+                DataQueue(ftpSpecialCharacters.EscapeCharacter);
+                nextByte = ~nextByte;
+            }
 
-                if ((START_OF_PACKET_BYTE == nextByte) || (END_OF_PACKET_BYTE == nextByte) || (ESCAPE_BYTE == nextByte))
-                {
-                    processResult = DataSend(ftpSpecialCharacters.EscapeCharacter);
-                    if (COM_PASS != processResult)
-                    {
-                        // fail and stop sending
-                        break;
-                    }
-                    nextByte = ~nextByte;
-                }
+            DataQueue(nextByte);
+            sentByteCount++;
+        }
 
-                processResult = DataSend(nextByte);
-                if (COM_PASS != processResult)
-                {
-                    // fail and stop sending
-                    break;
-                }
+        DataQueue(ftpSpecialCharacters.EndOfPacketCharacter);
+        isFrameSending = true;
+        processResult = COM_PASS;
+    }
 
-                sentByteCount++;
-            }
+    return processResult;
+}
+
+com_adapter_result_t COM_BaudRateSet(uint32_t baudRate)
+{
+    com_adapter_result_t result = COM_INVALID_ARG;
+    USART_SERIAL_SETUP serialSetup = {
+        .baudRate = baudRate,
+        .parity = USART_PARITY_NONE,
+        .dataWidth = USART_DATA_8_BIT,
+        .stopBits = USART_STOP_0_BIT
+    };
 
-            processResult = DataSend(ftpSpecialCharacters.EndOfPacketCharacter);
+    if ((baudRate >= COM_MIN_BAUD_RATE) && (baudRate <= COM_MAX_BAUD_RATE))
+    {
+        // A frame started at the old baud rate cannot be completed
+        isReceiveWindowOpen = false;
+        isEscapedByte = false;
+
+        // The response confirming the new baud rate must leave at the old one
+        while (isFrameSending && !FrameSendIsFinished())
+        {
+            // Wait for the interrupt to send the rest of the frame
+        }
+
+        // Passing 0 uses the SERCOM1 clock frequency
+        if (SERCOM1_USART_SerialSetup(&serialSetup, 0U))
+        {
+            // Start the free running SysTick counter the same way as the bootloader core if it has not run yet
+            if ((SysTick->CTRL & SysTick_CTRL_ENABLE_Msk) == 0U)
+            {
+                SYSTICK_TimerPeriodSet(COM_SYSTICK_PERIOD);
+                SYSTICK_TimerStart();
+            }
+            baudRateTickCount = SYSTICK_TimerCounterGet();
+            baudRateElapsedTicks = 0U;
+            isBaudRateUnconfirmed = true;
+            result = COM_PASS;
         }
         else
         {
-            // fail with no other actions
+            result = COM_FAIL;
         }
     }
 
-    return processResult;
+    return result;
 }
 
 com_adapter_result_t COM_Initialize(uint16_t maximumBufferLength)
@@ -340,7 +547,10 @@ com_adapter_result_t COM_Initialize(uint16_t maximumBufferLength)
         MaxBufferLength = maximumBufferLength;
         isReceiveWindowOpen = false;
         isEscapedByte = false;
-        SERCOM1_USART_Initialize();
+        frameCheckSum = 0U;
+        isBaudRateUnconfirmed = false;
+        isFrameSending = false;
+        SerialInitialize();
         result = COM_PASS;
     }
     else
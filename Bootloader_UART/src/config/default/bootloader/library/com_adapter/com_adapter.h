@@ -95,6 +95,9 @@ typedef enum
  *
  * @note For UART, this function does not send data out because it is asynchronous, but for other host driven
  * protocols this function controls the transfer in both directions.
+ * @note For UART, the bytes are collected in the background by the SERCOM receive interrupt. Each call decodes
+ * every byte that is available and stops as soon as a frame is closed. Once the frame queued by @ref COM_FrameSet
+ * has left the TX line, a call that does not close a frame reports it with @ref COM_SEND_COMPLETE.
  *
  * @param [in,out] receiveBufferPtr - Pointer to the buffer provided to SERCOM
  * @param [in,out] receiveIndexPtr - Pointer to the number of bytes successfully received by SERCOM
@@ -102,6 +105,7 @@ typedef enum
  * @return @ref COM_BUSY - SERCOM still loading the buffer \n
  * @return @ref COM_BUFFER_ERROR - SERCOM received too many or encountered a data error \n
  * @return @ref COM_FAIL - An error occurred in the SERCOM \n
+ * @return @ref COM_SEND_COMPLETE - The last frame queued for sending has been transmitted \n
  */
 com_adapter_result_t COM_FrameTransfer(uint8_t *receiveBufferPtr, uint16_t *receiveIndexPtr);
 
@@ -109,14 +113,14 @@ com_adapter_result_t COM_FrameTransfer(uint8_t *receiveBufferPtr, uint16_t *rece
  * @ingroup com_adapter_uart
  * @brief Copy and format bytes from the given buffer into the static send buffer using the defined framing format.
  *
- * @note For UART, this function will simply send the bytes out of the peripheral because the communication layer does
- * not need to wait for the host to initiate any transfer. Doing this makes it so we do not need to define a static
- * buffer in the communication code.
+ * @note For UART, this function escapes the bytes into the transmit ring buffer of the PLIB and returns, the SERCOM
+ * data register empty interrupt sends them out. It only waits while the ring buffer is full, so the caller's buffer
+ * can be reused as soon as it returns. @ref COM_FrameTransfer reports @ref COM_SEND_COMPLETE when the frame is out.
  *
  * @param [in] responseBufferPtr - Pointer to the buffer that needs to be sent
  * @param [in] responseLength - Length of the response that needs to be sent
- * @return @ref COM_PASS - Buffer was transferred without error \n
- * @return @ref COM_FAIL - An error occurred in the SERCOM while transferring the buffer \n
+ * @return @ref COM_PASS - Buffer was queued for sending \n
+ * @return @ref COM_INVALID_ARG - The buffer is NULL or empty \n
  */
 com_adapter_result_t COM_FrameSet(uint8_t *responseBufferPtr, uint16_t responseLength);
 
@@ -134,4 +138,62 @@ com_adapter_result_t COM_FrameSet(uint8_t *responseBufferPtr, uint16_t responseL
  */
 com_adapter_result_t COM_Initialize(uint16_t maximumBufferLength);
 
+/* cppcheck-suppress misra-c2012-2.5 */
+/**
+ * @ingroup com_adapter_uart
+ * @def COM_DEFAULT_BAUD_RATE
+ * @brief Baud rate SERCOM1 is configured for at start up.
+ * The link falls back to it when no valid frame is received after a switch to another baud rate.
+ */
+#define COM_DEFAULT_BAUD_RATE   (115200U)
+
+/* cppcheck-suppress misra-c2012-2.5 */
+/**
+ * @ingroup com_adapter_uart
+ * @def COM_MIN_BAUD_RATE
+ * @brief Lowest baud rate the link can be switched to.
+ */
+#define COM_MIN_BAUD_RATE       (9600U)
+
+/* cppcheck-suppress misra-c2012-2.5 */
+/**
+ * @ingroup com_adapter_uart
+ * @def COM_MAX_BAUD_RATE
+ * @brief Highest baud rate the link can be switched to, the receiver still samples each bit 16 times at the 48 MHz SERCOM1 clock.
+ */
+#define COM_MAX_BAUD_RATE       (3000000U)
+
+/* cppcheck-suppress misra-c2012-2.5 */
+/**
+ * @ingroup com_adapter_uart
+ * @def COM_BAUD_RATE_TIMEOUT
+ * @brief Time in milliseconds the link waits for a valid frame at a new baud rate before it falls back to the default baud rate.
+ */
+#define COM_BAUD_RATE_TIMEOUT   (1000U)
+
+/* cppcheck-suppress misra-c2012-2.5 */
+/**
+ * @ingroup com_adapter_uart
+ * @def COM_FLOW_CONTROL_ENABLED
+ * @brief Enables RTS/CTS flow control. When set, RTS on PA18 holds off the host while the receive ring buffer of SERCOM1
+ * is nearly full, and the host stops the responses with CTS on PA19. Both lines must be wired to the host.
+ */
+#ifndef COM_FLOW_CONTROL_ENABLED
+#define COM_FLOW_CONTROL_ENABLED (0)
+#endif
+
+/**
+ * @ingroup com_adapter_uart
+ * @brief Switches SERCOM1 to a new baud rate, 8 data bits, no parity and one stop bit.
+ * The new baud rate is kept once a frame with a valid frame check has been received. When no such frame
+ * arrives within @ref COM_BAUD_RATE_TIMEOUT, the link falls back to @ref COM_DEFAULT_BAUD_RATE.
+ * @note Call this function after the response that confirms the baud rate has been queued. It waits until the
+ * response has left the TX line at the old baud rate.
+ * @param [in] baudRate - New baud rate, from @ref COM_MIN_BAUD_RATE to @ref COM_MAX_BAUD_RATE
+ * @return @ref COM_PASS - SERCOM1 runs at the new baud rate \n
+ * @return @ref COM_INVALID_ARG - The baud rate is out of range \n
+ * @return @ref COM_FAIL - SERCOM1 could not be set up for the baud rate \n
+ */
+com_adapter_result_t COM_BaudRateSet(uint32_t baudRate);
+
 #endif //COM_ADAPTER_H
\ No newline at end of file
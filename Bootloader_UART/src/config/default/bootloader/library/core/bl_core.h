@@ -51,11 +51,19 @@
  * @var bl_block_type_t:: WRITE_FLASH
  * 0x02U - Flash Data Block - Identifies operational blocks
  * that need to be written into the Flash section of the memory
+ * @var bl_block_type_t:: FILL_FLASH
+ * 0x04U - Fill Block - Identifies operational blocks
+ * that describe a range of the Flash section holding a single repeated value
+ * @var bl_block_type_t:: COMPRESSED_FLASH
+ * 0x05U - Compressed Flash Data Block - Identifies operational blocks
+ * that hold LZSS compressed data to be written into the Flash section of the memory
  */
 typedef enum
 {
     UNLOCK_BOOTLOADER = 0x01U,
     WRITE_FLASH = 0x02U,
+    FILL_FLASH = 0x04U,
+    COMPRESSED_FLASH = 0x05U,
 } bl_block_type_t;
 
 /**
@@ -77,6 +85,47 @@ typedef struct
  */
 #define BL_COMMAND_HEADER_SIZE  (4U)
 
+/**
+ * @ingroup mdfu_client_32bit
+ * @struct bl_fill_header_t
+ * @brief Data orientation of a fill block.
+ * @var bl_fill_header_t:: startAddress
+ * Member 'startAddress' contains the start address of the filled range.
+ * @var bl_fill_header_t:: fillLength
+ * Member 'fillLength' contains the length of the filled range in bytes.
+ * @var bl_fill_header_t:: fillValue
+ * Member 'fillValue' contains the 32-bit value repeated over the filled range.
+ */
+typedef struct
+{
+    uint32_t startAddress;
+    uint32_t fillLength;
+    uint32_t fillValue;
+} bl_fill_header_t;
+
+/**
+ * @ingroup mdfu_client_32bit
+ * @def BL_FILL_HEADER_SIZE
+ * @brief Total size of the fill block data following the basic block header.
+ */
+#define BL_FILL_HEADER_SIZE     (12U)
+
+/**
+ * @ingroup mdfu_client_32bit
+ * @def BL_COMPRESSED_HEADER_SIZE
+ * @brief Total size of the start address and the decoded length that follow the basic block header of a compressed block.
+ */
+#define BL_COMPRESSED_HEADER_SIZE   (6U)
+
+/**
+ * @ingroup mdfu_client_32bit
+ * @def BL_COMPRESSED_WINDOW_SIZE
+ * @brief Largest distance in bytes that a match of a compressed block can reach back.
+ *
+ * Matches that reach back past the start of the block are read from the rows already written in the current update.
+ */
+#define BL_COMPRESSED_WINDOW_SIZE   (4096U)
+
 /**
  * @ingroup mdfu_client_32bit
  * @struct bl_block_header_t
@@ -100,12 +149,19 @@ typedef struct
  */
 #define BL_BLOCK_HEADER_SIZE    (3U)
 
+/**
+ * @ingroup mdfu_client_32bit
+ * @def BL_WRITE_PAGE_COUNT
+ * @brief Maximum number of Flash pages that the bootloader can program from a single write block.
+ */
+#define BL_WRITE_PAGE_COUNT     (NVMCTRL_FLASH_ROWSIZE / NVMCTRL_FLASH_PAGESIZE)
+
 /**
  * @ingroup mdfu_client_32bit
  * @def BL_WRITE_BYTE_LENGTH
  * @brief Maximum number of bytes that the bootloader can hold inside of its process buffer.
  */
-#define BL_WRITE_BYTE_LENGTH    (NVMCTRL_FLASH_PAGESIZE)
+#define BL_WRITE_BYTE_LENGTH    (NVMCTRL_FLASH_PAGESIZE * BL_WRITE_PAGE_COUNT)
 
 /**
  * @ingroup mdfu_client_32bit
@@ -114,6 +170,79 @@ typedef struct
  */
 #define BL_MAX_BUFFER_SIZE      (BL_BLOCK_HEADER_SIZE + BL_COMMAND_HEADER_SIZE + BL_WRITE_BYTE_LENGTH)
 
+/**
+ * @ingroup mdfu_client_32bit
+ * @enum bl_boot_phase_t
+ * @brief Contains the IDs of the boot phases that are time stamped in the boot time record.
+ * Each time stamp is taken at the end of its phase.
+ * @var bl_boot_phase_t:: BL_BOOT_PHASE_SYS_INITIALIZE
+ * 0x00U - End of SYS_Initialize. The SysTick is set up by SYS_Initialize, so this is the time origin of the record
+ * @var bl_boot_phase_t:: BL_BOOT_PHASE_FORCED_ENTRY_CHECK
+ * 0x01U - End of the forced entry checks
+ * @var bl_boot_phase_t:: BL_BOOT_PHASE_LOAD_NEW_IMAGE
+ * 0x02U - End of the check and copy of the staging image
+ * @var bl_boot_phase_t:: BL_BOOT_PHASE_IMAGE_VERIFY
+ * 0x03U - End of the verification of the application image
+ * @var bl_boot_phase_t:: BL_BOOT_PHASE_LOAD_IMAGE_BACKUP
+ * 0x04U - End of the restoration of the backup image
+ * @var bl_boot_phase_t:: BL_BOOT_PHASE_APPLICATION_START
+ * 0x05U - Jump to the application
+ * @var bl_boot_phase_t:: BL_BOOT_PHASE_FTP_START
+ * 0x06U - Start of the FTP task when the device stays in Boot mode
+ * @var bl_boot_phase_t:: BL_BOOT_PHASE_COUNT
+ * 0x07U - Number of boot phases
+ */
+typedef enum
+{
+    BL_BOOT_PHASE_SYS_INITIALIZE = 0x00U,
+    BL_BOOT_PHASE_FORCED_ENTRY_CHECK = 0x01U,
+    BL_BOOT_PHASE_LOAD_NEW_IMAGE = 0x02U,
+    BL_BOOT_PHASE_IMAGE_VERIFY = 0x03U,
+    BL_BOOT_PHASE_LOAD_IMAGE_BACKUP = 0x04U,
+    BL_BOOT_PHASE_APPLICATION_START = 0x05U,
+    BL_BOOT_PHASE_FTP_START = 0x06U,
+    BL_BOOT_PHASE_COUNT = 0x07U,
+} bl_boot_phase_t;
+
+/**
+ * @ingroup mdfu_client_32bit
+ * @struct bl_boot_trace_t
+ * @brief Data orientation of the boot time record stored at @ref BL_BOOT_TRACE_START.
+ * @var bl_boot_trace_t:: traceKey
+ * Member 'traceKey' contains @ref BL_BOOT_TRACE_KEY when the record was written in the current boot
+ * @var bl_boot_trace_t:: tickFrequency
+ * Member 'tickFrequency' contains the number of SysTick ticks per second
+ * @var bl_boot_trace_t:: phaseMask
+ * Member 'phaseMask' contains one bit per @ref bl_boot_phase_t, set when the phase has been time stamped
+ * @var bl_boot_trace_t:: timeStamp
+ * Member 'timeStamp' contains the SysTick ticks elapsed from @ref BL_BOOT_PHASE_SYS_INITIALIZE to the end of each phase
+ */
+typedef struct
+{
+    uint32_t traceKey;
+    uint32_t tickFrequency;
+    uint32_t phaseMask;
+    uint32_t timeStamp[BL_BOOT_PHASE_COUNT];
+} bl_boot_trace_t;
+
+/**
+ * @ingroup mdfu_client_32bit
+ * @struct bl_flash_statistics_t
+ * @brief Counters of the Flash operations run by @ref BL_FlashTask since the device started.
+ * @var bl_flash_statistics_t:: bytesProgrammed
+ * Member 'bytesProgrammed' contains the number of bytes programmed into the download area
+ * @var bl_flash_statistics_t:: rowsErased
+ * Member 'rowsErased' contains the number of rows erased in the download area. Rows that were blank already are not counted
+ * @var bl_flash_statistics_t:: busyTime
+ * Member 'busyTime' contains the time in microseconds from each erase or write command until @ref BL_FlashTask found it finished
+ */
+typedef struct
+{
+    uint32_t bytesProgrammed;
+    uint32_t rowsErased;
+    uint32_t busyTime;
+} bl_flash_statistics_t;
+
 /**
  * @ingroup mdfu_client_32bit
  * @brief Performs the initialization steps required to configure the bootloader peripherals.
@@ -127,10 +256,14 @@ bl_result_t BL_Initialize(void);
 /**
  * @ingroup mdfu_client_32bit
  * @brief Executes the required action based on the block type received in the bootloader data buffer.
- * 
+ *
+ * A write block of whole pages whose data starts on a word boundary is programmed straight from the
+ * command buffer, so the buffer must be left unchanged until @ref BL_FlashTask stops returning @ref BL_BUSY.
+ *
  * @param [in] commandBuffer - Pointer to the start of the bootloader operational data
  * @param [in] commandLength - Length of the new data received by the FTP
- * @return @ref BL_PASS - Process cycle finished successfully
+ * @return @ref BL_PASS - Process cycle finished successfully, Flash writes are queued and reported by @ref BL_FlashTask
+ * @return @ref BL_BUSY - A queued Flash operation must finish before the block can be processed
  * @return @ref BL_FAIL - Process cycle failed unexpectedly
  * @return @ref BL_ERROR_UNKNOWN_COMMAND - Process cycle encountered an unknown command
  * @return @ref BL_ERROR_VERIFICATION_FAIL - Process cycle failed to verify the application image
@@ -139,6 +272,39 @@ bl_result_t BL_Initialize(void);
  */
 bl_result_t BL_BootCommandProcess(uint8_t * commandBuffer, uint16_t commandLength);
 
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief Advances the queued Flash erase or write operation by one step.
+ *
+ * Each call issues at most one command to the NVMCTRL and never waits for it to finish,
+ * so this function must be called periodically until it stops returning @ref BL_BUSY.
+ *
+ * @return @ref BL_PASS - No operation is queued and all queued operations finished successfully
+ * @return @ref BL_BUSY - A queued operation is still in progress
+ * @return @ref BL_ERROR_COMMAND_PROCESSING - A queued operation failed. The error is held until @ref BL_Initialize is called
+ */
+bl_result_t BL_FlashTask(void);
+
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief Gets the counters of the Flash operations run by @ref BL_FlashTask.
+ *
+ * @return Pointer to the counters. They keep counting across updates until the device is reset.
+ */
+const bl_flash_statistics_t * BL_FlashStatisticsGet(void);
+
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief Queues the erase of every row of the download area that has not been written in the current update.
+ *
+ * Rows are only erased when they are written, so the rows skipped by the image still hold the previous
+ * content until this erase is finished through @ref BL_FlashTask. Rows that are already blank are not erased again.
+ *
+ * @return @ref BL_PASS - The erase was queued, or no update is in progress
+ * @return @ref BL_BUSY - Another Flash operation is still queued
+ */
+bl_result_t BL_DownloadAreaComplete(void);
+
 /**
  * @ingroup mdfu_client_32bit
  * @brief Performs actions to jump the MCU program counter to
@@ -157,4 +323,35 @@ void BL_ApplicationStart(void);
  */
 bool BL_CheckForcedEntry(void);
 
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief Clears the boot time record and starts the SysTick as a free running counter.
+ *
+ * Must be called right after SYS_Initialize. The record stays untouched when @ref BL_BOOT_TRACE_ENABLED is cleared.
+ */
+void BL_BootTraceStart(void);
+
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief Stores the SysTick ticks elapsed since @ref BL_BootTraceStart as the time stamp of the given boot phase.
+ *
+ * The SysTick is stopped and set back to its 1 ms period after @ref BL_BOOT_PHASE_APPLICATION_START
+ * or @ref BL_BOOT_PHASE_FTP_START, so these must be the last phases stamped.
+ *
+ * @param [in] phase - ID of the boot phase that just ended
+ *
+ * @note The SysTick wraps about every 350 ms. A phase that can run longer must call @ref BL_BootTraceUpdate
+ * at least once per wrap.
+ */
+void BL_BootTraceMark(bl_boot_phase_t phase);
+
+/**
+ * @ingroup mdfu_client_32bit
+ * @brief Adds the SysTick ticks elapsed since the last call or time stamp to the boot time record.
+ *
+ * Only one SysTick wrap can be seen between two readings, so a boot phase that runs for more than
+ * one period must call this at least once per period. Nothing is done after the last boot phase has been stamped.
+ */
+void BL_BootTraceUpdate(void);
+
 #endif // BL_CORE_H
\ No newline at end of file
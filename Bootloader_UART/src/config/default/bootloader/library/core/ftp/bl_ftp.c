@@ -55,7 +55,13 @@
  * @def MAX_RESPONSE_SIZE
  * @brief Length of the largest possible response in bytes.
  */
-#define MAX_RESPONSE_SIZE       (25U)
+#define MAX_RESPONSE_SIZE       (30U)
+/**
+ * @ingroup mdfu_client_ftp
+ * @def STATISTICS_WORD_COUNT
+ * @brief Number of 32-bit counters in the Get Statistics response.
+ */
+#define STATISTICS_WORD_COUNT   (7U)
 /**
  * @ingroup mdfu_client_ftp
  * @def TLV_HEADER_SIZE
@@ -79,7 +85,20 @@
  * @def PACKET_BUFFER_COUNT
  * @brief Number of buffers supported for reception.
  */
-#define PACKET_BUFFER_COUNT     (1U)
+#define PACKET_BUFFER_COUNT     (2U)
+/**
+ * @ingroup mdfu_client_ftp
+ * @def VERIFY_STEP_SIZE
+ * @brief Maximum number of bytes added to the image CRC on each call of the FTP task.
+ */
+#define VERIFY_STEP_SIZE        (1024U)
+/**
+ * @ingroup mdfu_client_ftp
+ * @def FTP_WINDOW_SIZE
+ * @brief Largest number of commands the host can send ahead of the oldest one not acknowledged in the windowed mode.
+ * @note The window must not exceed half of the sequence number range, so a repeated command can be told apart from a new one.
+ */
+#define FTP_WINDOW_SIZE         (8U)
 /**
  * @ingroup mdfu_client_ftp
  * @def RETRY_TRANSFER_bm
@@ -123,6 +142,12 @@
  * @brief Index of the start of the file transfer data in the receive buffer.
  */
 #define FILE_DATA_INDEX         (COMMAND_DATA_SIZE + SEQUENCE_DATA_SIZE)
+/**
+ * @ingroup mdfu_client_ftp
+ * @def PAYLOAD_ALIGNMENT_SIZE
+ * @brief Number of bytes in front of each receive buffer that place the data of a write block on a word boundary.
+ */
+#define PAYLOAD_ALIGNMENT_SIZE  ((4U - ((FILE_DATA_INDEX + BL_BLOCK_HEADER_SIZE + BL_COMMAND_HEADER_SIZE) % 4U)) % 4U)
 
 /**
  * @ingroup mdfu_client_ftp
@@ -135,7 +160,9 @@ typedef enum
     FTP_START_TRANSFER = 0x02U,
     FTP_WRITE_CHUNK = 0x03U,
     FTP_GET_IMAGE_STATE = 0x04U,
-    FTP_END_TRANSFER = 0x05U
+    FTP_END_TRANSFER = 0x05U,
+    FTP_GET_STATISTICS = 0x80U, /**< Vendor command that is not defined by the MDFU protocol */
+    FTP_SET_BAUD_RATE = 0x81U /**< Vendor command that is not defined by the MDFU protocol */
 } ftp_command_t;
 
 /**
@@ -193,6 +220,18 @@ typedef enum
     FTP_IMAGE_INVALID = 0x02U
 } ftp_image_state_t;
 
+/**
+ * @ingroup mdfu_client_ftp
+ * @enum ftp_image_state_step_t
+ * @brief Enumeration of the steps of a Get Image State command that run across several calls of the FTP task.
+ */
+typedef enum
+{
+    IMAGE_STATE_IDLE = 0U, /**< No Get Image State command is waiting for its response */
+    IMAGE_STATE_FLASH = 1U, /**< The rows skipped by the image are being erased */
+    IMAGE_STATE_VERIFY = 2U /**< The hash range of the image is being calculated */
+} ftp_image_state_step_t;
+
 /**
  * @ingroup mdfu_client_ftp
  * @enum tlv_type_code_t
@@ -203,6 +242,8 @@ typedef enum
     FTP_PROTOCOL_VERSION = 0x01U,
     FTP_TRANSFER_PARAMETERS = 0x02U,
     FTP_TIMEOUT_INFO = 0x03U,
+    FTP_WINDOW_INFO = 0x80U, /**< Vendor type that is not defined by the MDFU protocol */
+    FTP_BAUD_RATE_INFO = 0x81U, /**< Vendor type that is not defined by the MDFU protocol */
 } tlv_type_code_t;
 
 /**
@@ -221,8 +262,30 @@ typedef struct
     uint8_t nextSequenceNumber; /**< The next expected sequence number */
     bool responseRequired; /**< Flag indicating if a response is required */
     bool resendRequired; /**< Flag indicating if a resend is required */
+    uint8_t windowSize; /**< The number of commands the host can send ahead, 1 when the windowed mode is off */
+    bool isWindowOpen; /**< Flag indicating that Write Chunk commands ahead of a missing one can be executed */
+    bool isWindowResendRequested; /**< Flag indicating that the first missing command has already been requested */
+    uint32_t windowReceivedMap; /**< One bit per sequence number executed ahead of the first missing command */
+    uint32_t windowHeldMap; /**< One bit per sequence number received ahead of the first missing command but not executed */
+    uint32_t responseBaudRate; /**< The baud rate confirmed by the response buffer, the link switches to it once the response is sent, 0 for other responses */
 } ftp_parser_helper_t;
 
+/**
+ * @ingroup mdfu_client_ftp
+ * @struct ftp_packet_buffer_t
+ * @brief A structure holding one received FTP frame along with its reception status.
+ *
+ * The receive buffers are used as a ring so that the next frame from the host can be
+ * loaded while a previously received frame is still waiting to be executed.
+ */
+typedef struct
+{
+    uint8_t alignment[PAYLOAD_ALIGNMENT_SIZE]; /**< Unused, lets the core program the pages of a write block straight from the data buffer */
+    uint8_t data[MAX_TRANSFER_SIZE]; /**< The frame bytes received from the host */
+    uint16_t receiveCount; /**< The number of bytes held in the data buffer */
+    com_adapter_result_t frameStatus; /**< The status reported by the communication layer when the frame was closed */
+} ftp_packet_buffer_t;
+
 /**
  * @ingroup mdfu_client_ftp
  * @struct ftp_tlv_t
@@ -241,13 +304,30 @@ typedef struct
 
 /**
  * @ingroup mdfu_client_ftp
- * @brief Buffer for receiving FTP data.
+ * @struct ftp_statistics_t
+ * @brief A structure holding the transfer counters reported by the Get Statistics command.
+ *
+ * The counters are cleared when the device is reset and keep counting across updates.
+ */
+typedef struct
+{
+    uint32_t framesReceived; /**< The number of complete frames received from the host */
+    uint32_t frameCheckFailures; /**< The number of received frames that failed the frame check */
+    uint32_t resends; /**< The number of retry responses that asked the host to send a command again */
+    uint32_t duplicateSequences; /**< The number of commands received again with the last sequence number */
+} ftp_statistics_t;
+
+/**
+ * @ingroup mdfu_client_ftp
+ * @brief Ring of buffers for receiving FTP data.
  *
- * This buffer is used to store incoming FTP data packets.
- * The size of the buffer is defined by MAX_TRANSFER_SIZE which is based on the
- * bootloader's write size.
+ * These buffers are used to store incoming FTP data packets.
+ * The number of buffers is defined by PACKET_BUFFER_COUNT and is reported to the host
+ * in the Get Client Info response. The size of each buffer is defined by MAX_TRANSFER_SIZE
+ * which is based on the bootloader's write size. One more buffer than reported is held as
+ * a spare, see @ref spareBuffer.
  */
-static uint8_t FTP_RECEIVE_BUFFER[MAX_TRANSFER_SIZE];
+static ftp_packet_buffer_t FTP_RECEIVE_BUFFER[PACKET_BUFFER_COUNT + 1U];
 
 /**
  * @ingroup mdfu_client_ftp
@@ -270,6 +350,12 @@ static uint8_t FTP_RETRY_BUFFER[MAX_RESPONSE_SIZE];
 
 static bool resetPending = false;
 static bool isComBusy = false;
+
+/**
+ * @ingroup mdfu_client_ftp
+ * @brief Step of the Get Image State command that is in progress.
+ */
+static ftp_image_state_step_t imageStateStep = IMAGE_STATE_IDLE;
 /**
  * @ingroup mdfu_client_ftp
  * @brief Structure manages the FTP parser data.
@@ -280,9 +366,47 @@ static ftp_parser_helper_t ftpHelper = {
     .nextSequenceNumber = 1U,
     .resendRequired = false,
     .responseRequired = false,
+    .windowSize = 1U,
+    .isWindowOpen = false,
+    .isWindowResendRequested = false,
+    .windowReceivedMap = 0U,
+    .windowHeldMap = 0U,
+    .responseBaudRate = 0U,
 };
-static uint16_t ftpReceiveCount = 0U;
 static uint16_t ftpResponseLength = 0U;
+/**
+ * @ingroup mdfu_client_ftp
+ * @brief Transfer counters reported by the Get Statistics command.
+ */
+static ftp_statistics_t ftpStatistics = {0U, 0U, 0U, 0U};
+/**
+ * @ingroup mdfu_client_ftp
+ * @brief Index of the receive buffer currently being loaded by the communication layer.
+ */
+static uint8_t receiveBufferIndex = 0U;
+/**
+ * @ingroup mdfu_client_ftp
+ * @brief Index of the oldest received buffer that has not been executed yet.
+ */
+static uint8_t processBufferIndex = 0U;
+/**
+ * @ingroup mdfu_client_ftp
+ * @brief Number of received buffers waiting to be executed.
+ */
+static uint8_t pendingBufferCount = 0U;
+/**
+ * @ingroup mdfu_client_ftp
+ * @brief Receive buffers in the order they are loaded and executed.
+ */
+static ftp_packet_buffer_t * receiveRing[PACKET_BUFFER_COUNT];
+/**
+ * @ingroup mdfu_client_ftp
+ * @brief Receive buffer taken out of the ring after its frame was executed.
+ *
+ * The core programs the pages of a write block straight from the received frame, so the buffer
+ * is swapped with this one instead of being loaded again while the Flash may still be busy with it.
+ */
+static ftp_packet_buffer_t * spareBuffer = NULL;
 
 /**
  * @ingroup mdfu_client_ftp
@@ -300,12 +424,23 @@ static void DeviceResetCheck(void);
  * @brief Resets parser data use for command reception.
  *
  * This function resets all flags, buffers, and counters used when receiving FTP
- * commands.
+ * commands into the given receive buffer.
  *
- * @param None
+ * @param [in,out] packetBuffer - Pointer to the receive buffer to be reset
  * @return None
  */
-static void ParserDataReset(void);
+static void ParserDataReset(ftp_packet_buffer_t * packetBuffer);
+/**
+ * @ingroup mdfu_client_ftp
+ * @brief Executes the oldest frame held in the receive buffer ring.
+ *
+ * This function handles the frame status reported by the communication layer, validates the
+ * frame and executes the command it holds. The receive buffer is released once the frame is handled.
+ *
+ * @param [in,out] packetBuffer - Pointer to the receive buffer holding the frame
+ * @return The result of the FTP process cycle as described in @ref FTP_Task
+ */
+static bl_result_t PacketBufferProcess(ftp_packet_buffer_t * packetBuffer);
 /**
  * @ingroup mdfu_client_ftp
  * @brief Validates the sequence number of the incoming command.
@@ -313,21 +448,86 @@ static void ParserDataReset(void);
  * This function checks the validity of the sequence number based on past operations
  * and the next expected number.
  *
- * @param None
+ * @param [in] packetBuffer - Pointer to the receive buffer holding the command
  * @return Returns true if the sequence number is valid, false otherwise
  */
-static bool SequenceNumberValidate(void);
+static bool SequenceNumberValidate(const ftp_packet_buffer_t * packetBuffer);
+/**
+ * @ingroup mdfu_client_ftp
+ * @brief Validates the sequence number of the incoming command in the windowed mode.
+ *
+ * The command with the next expected sequence number is always executed. A Write Chunk command
+ * further ahead in the window is executed as well once the first chunk has unlocked the core,
+ * if its block only depends on its own address and data, see @ref WindowRunAheadCheck.
+ * A command received again is answered with the window state and not executed twice.
+ *
+ * @param [in] packetBuffer - Pointer to the receive buffer holding the command
+ * @return Returns true if the command must be executed, false otherwise
+ */
+static bool WindowSequenceNumberValidate(const ftp_packet_buffer_t * packetBuffer);
+/**
+ * @ingroup mdfu_client_ftp
+ * @brief Checks if a command can be executed ahead of a missing command of the window.
+ *
+ * Write and fill blocks carry their own address and data, and the rows are erased on demand in any order.
+ * A compressed block can copy data back from the blocks in front of it, so it waits until the gap is closed.
+ *
+ * @param [in] packetBuffer - Pointer to the receive buffer holding the command
+ * @return Returns true if the command is a Write Chunk with a write or fill block, false otherwise
+ */
+static bool WindowRunAheadCheck(const ftp_packet_buffer_t * packetBuffer);
+/**
+ * @ingroup mdfu_client_ftp
+ * @brief Moves the window past the current command and past every command already executed after it.
+ *
+ * @param None
+ * @return None
+ */
+static void WindowAdvance(void);
+/**
+ * @ingroup mdfu_client_ftp
+ * @brief Sets the response that reports the window state to the host.
+ *
+ * Without a gap, the response acknowledges every command up to the last one received in order.
+ * Otherwise the first missing command is requested.
+ *
+ * @param [in] isDeferred - The acknowledge is left to a command that is already waiting in the receive ring
+ * @return None
+ */
+static void WindowResponseSet(bool isDeferred);
+/**
+ * @ingroup mdfu_client_ftp
+ * @brief Asks the host to send the first missing command of the window again, once for each gap.
+ *
+ * @param None
+ * @return None
+ */
+static void WindowResendRequest(void);
 /**
  * @ingroup mdfu_client_ftp
  * @brief Sets the Get Client Info data in the response buffer.
  *
  * This function defines and sets the response data to the Get Client Info command.
- * The Get Client Info command data payload used in this function is defined by the MDFU protocol.
+ * The Get Client Info command data payload used in this function is defined by the MDFU protocol,
+ * followed by a vendor TLV with the largest window a host can ask for in the Start Transfer command.
  *
  * @param None
  * @return None
  */
 static void ClientInfoResponseSet(void);
+/**
+ * @ingroup mdfu_client_ftp
+ * @brief Sets the Get Statistics data in the response buffer.
+ *
+ * The response holds the transfer counters followed by the Flash counters of the bootloader core,
+ * each as a 32-bit little endian value:
+ * frames received, frame check failures, resends, duplicate sequences, bytes programmed, rows erased
+ * and Flash busy time in microseconds.
+ *
+ * @param None
+ * @return None
+ */
+static void StatisticsResponseSet(void);
 
 /**
  * @ingroup mdfu_client_ftp
@@ -336,14 +536,14 @@ static void ClientInfoResponseSet(void);
  * This function processes the FTP receive buffer and calls the required operational layer or performs the steps needed to execute the FTP command.
  * The Get Client Info Command data payload used in this function is defined by the MDFU protocol.
  *
- * @param None
+ * @param [in] packetBuffer - Pointer to the receive buffer holding the command
  * @return @ref BL_PASS - FTP process cycle finished successfully
  * @return @ref BL_ERROR_UNKNOWN_COMMAND - FTP process failed due to an unknown command code or unknown file data block type
  * @return @ref BL_ERROR_VERIFICATION_FAIL - FTP process failed due to a data verification failed. Could be returned when an image failure occurs or when a meta-data validation fails
  * @return @ref BL_ERROR_ADDRESS_OUT_OF_RANGE - FTP process failed due to an address error
  * @return @ref BL_ERROR_COMMAND_PROCESSING - FTP process failed due to a general memory process error
  */
-static bl_result_t OperationalBlockExecute(void);
+static bl_result_t OperationalBlockExecute(ftp_packet_buffer_t * packetBuffer);
 
 /**
  * @ingroup mdfu_client_ftp
@@ -395,6 +595,17 @@ static uint8_t TLVAppend(uint8_t * dataBufferStart, ftp_tlv_t * tlvData);
  * @return @ref FTP_GENERIC_ERROR - The bootloader code received has not been mapped to a specific FTP abort code
  */
 static ftp_abort_code_t AbortCodeGet(bl_result_t targetStatus);
+/**
+ * @ingroup mdfu_client_ftp
+ * @brief Runs the next step of the Get Image State command and sets its response once the image state is known.
+ *
+ * The image is verified in chunks of @ref VERIFY_STEP_SIZE bytes, so the communication is serviced between the chunks.
+ *
+ * @param None
+ * @return @ref BL_BUSY - The image state is not known yet
+ * @return Result of the image verification otherwise
+ */
+static bl_result_t ImageStateTask(void);
 
 bl_result_t FTP_Task(void)
 {
@@ -403,64 +614,74 @@ bl_result_t FTP_Task(void)
         DeviceResetCheck();
     }
     bl_result_t processResult = BL_FAIL;
-    ftp_transport_failure_code_t transportStatusResult = FTP_INTEGRITY_CHECK_ERROR;
     com_adapter_result_t comResult = COM_FAIL;
 
-    // Call the command to load the buffer up with the current receive count
-    comResult = COM_FrameTransfer((uint8_t *) & FTP_RECEIVE_BUFFER, &ftpReceiveCount);
-
-    if (comResult == COM_BUFFER_ERROR)
-    {
-        processResult = BL_ERROR_BUFFER_OVERLOAD;
-        ftpHelper.resendRequired = true;
-        transportStatusResult = FTP_COMMAND_TOO_LONG_ERROR;
-        ResponseSet((uint8_t *) & FTP_RETRY_BUFFER, (uint8_t *) & transportStatusResult, FTP_COMMAND_NOT_EXECUTED, ftpHelper.nextSequenceNumber ^ RETRY_TRANSFER_bm, 1U);
-        ParserDataReset();
-    }
-    else if (comResult == COM_PASS)
+    if (pendingBufferCount < PACKET_BUFFER_COUNT)
     {
+        ftp_packet_buffer_t * receiveBuffer = receiveRing[receiveBufferIndex];
+
+        // Call the command to load the buffer up with the current receive count
+        comResult = COM_FrameTransfer(receiveBuffer->data, &receiveBuffer->receiveCount);
 
-        if (ftpReceiveCount < MIN_TRANSFER_SIZE)
+        if ((comResult == COM_PASS) || (comResult == COM_BUFFER_ERROR) || (comResult == COM_TRANSPORT_FAILURE))
         {
-            processResult = BL_ERROR_BUFFER_UNDERLOAD;
-            transportStatusResult = FTP_COMMAND_TOO_SHORT_ERROR;
-            ftpHelper.resendRequired = true;
-            ResponseSet((uint8_t *) & FTP_RETRY_BUFFER, (uint8_t *) & transportStatusResult, FTP_COMMAND_NOT_EXECUTED, ftpHelper.nextSequenceNumber ^ RETRY_TRANSFER_bm, 1U);
+            ftpStatistics.framesReceived++;
+            if (comResult == COM_TRANSPORT_FAILURE)
+            {
+                ftpStatistics.frameCheckFailures++;
+            }
+
+            // Queue the closed frame and move the reception to the next buffer of the ring
+            receiveBuffer->frameStatus = comResult;
+            receiveBufferIndex = (uint8_t)((receiveBufferIndex + 1U) % PACKET_BUFFER_COUNT);
+            pendingBufferCount++;
         }
-        else if (SequenceNumberValidate())
+        else if (comResult == COM_BUSY)
         {
-            // Call execution to handle the rest of the command processes
-            processResult = OperationalBlockExecute();
-            ftpHelper.responseRequired = true;
+            // Still Loading
+            processResult = BL_BUSY;
+        }
+        else if (comResult == COM_SEND_COMPLETE)
+        {
+            // The response has left the TX line, flip the busy flag to allow resets
+            isComBusy = false;
+            processResult = BL_BUSY;
         }
         else
         {
-            processResult = BL_ERROR_FRAME_VALIDATION_FAIL;
+            processResult = BL_ERROR_COMMUNICATION_FAIL;
         }
-        ParserDataReset();
     }
-    else if (comResult == COM_TRANSPORT_FAILURE)
+
+    // Advance the queued Flash operation, frames keep being received while the Flash is busy
+    bl_result_t flashStatus = BL_FlashTask();
+
+    if ((pendingBufferCount > 0U) && (flashStatus != BL_BUSY) && (imageStateStep == IMAGE_STATE_IDLE))
     {
-        processResult = BL_ERROR_FRAME_VALIDATION_FAIL;
-        ftpHelper.resendRequired = true;
-        ResponseSet((uint8_t *) & FTP_RETRY_BUFFER, (uint8_t *) & transportStatusResult, FTP_COMMAND_NOT_EXECUTED, ftpHelper.nextSequenceNumber ^ RETRY_TRANSFER_bm, 1U);
+        // Execute the oldest frame so that the responses are sent in the order the commands were received
+        ftp_packet_buffer_t * executedBuffer = receiveRing[processBufferIndex];
+        processResult = PacketBufferProcess(executedBuffer);
+
+        // Frames are only executed while the Flash is idle, so the spare buffer is free to take the place of this one
+        receiveRing[processBufferIndex] = spareBuffer;
+        spareBuffer = executedBuffer;
+        processBufferIndex = (uint8_t)((processBufferIndex + 1U) % PACKET_BUFFER_COUNT);
+        pendingBufferCount--;
     }
-    else if (comResult == COM_BUSY)
+    else if (pendingBufferCount > 0U)
     {
-        // Still Loading
+        // Hold the frames until the Flash is free and the image state has been answered
         processResult = BL_BUSY;
     }
-#ifdef MULTI_STAGE_RESPONSE
-    else if (comResult == COM_SEND_COMPLETE)
+    else
     {
-        // Flip the busy flag to allow resets
-        isComBusy = false;
-        processResult = BL_BUSY;
+        // Do nothing
     }
-#endif
-    else
+
+    if (imageStateStep != IMAGE_STATE_IDLE)
     {
-        processResult = BL_ERROR_COMMUNICATION_FAIL;
+        // Verify the next chunk of the image, the frames keep being received in between
+        processResult = ImageStateTask();
     }
 
     if (ftpHelper.resendRequired)
@@ -471,7 +692,16 @@ bl_result_t FTP_Task(void)
         {
             processResult = BL_ERROR_COMMUNICATION_FAIL;
         }
+        else
+        {
+            // The frame is sent in the background
+            isComBusy = true;
+        }
+        ftpStatistics.resends++;
         ftpHelper.resendRequired = false;
+
+        // A resend always asks for the next sequence number, which is the first missing command of an open window
+        ftpHelper.isWindowResendRequested = true;
     }
     else if (ftpHelper.responseRequired)
     {
@@ -481,6 +711,17 @@ bl_result_t FTP_Task(void)
         {
             processResult = BL_ERROR_COMMUNICATION_FAIL;
         }
+        else
+        {
+            // The frame is sent in the background, a pending reset waits until it is out
+            isComBusy = true;
+
+            if (ftpHelper.responseBaudRate != 0U)
+            {
+                // The confirmation leaves at the old baud rate, a copy sent for a repeated command switches again
+                (void) COM_BaudRateSet(ftpHelper.responseBaudRate);
+            }
+        }
         ftpHelper.responseRequired = false;
     }
     else
@@ -491,13 +732,65 @@ bl_result_t FTP_Task(void)
     return processResult;
 }
 
-static bool SequenceNumberValidate(void)
+static bl_result_t PacketBufferProcess(ftp_packet_buffer_t * packetBuffer)
+{
+    bl_result_t processResult = BL_FAIL;
+    ftp_transport_failure_code_t transportStatusResult = FTP_INTEGRITY_CHECK_ERROR;
+
+    if (packetBuffer->frameStatus == COM_BUFFER_ERROR)
+    {
+        processResult = BL_ERROR_BUFFER_OVERLOAD;
+        ftpHelper.resendRequired = true;
+        transportStatusResult = FTP_COMMAND_TOO_LONG_ERROR;
+        ResponseSet((uint8_t *) & FTP_RETRY_BUFFER, (uint8_t *) & transportStatusResult, FTP_COMMAND_NOT_EXECUTED, ftpHelper.nextSequenceNumber ^ RETRY_TRANSFER_bm, 1U);
+    }
+    else if (packetBuffer->frameStatus == COM_PASS)
+    {
+        if (packetBuffer->receiveCount < MIN_TRANSFER_SIZE)
+        {
+            processResult = BL_ERROR_BUFFER_UNDERLOAD;
+            transportStatusResult = FTP_COMMAND_TOO_SHORT_ERROR;
+            ftpHelper.resendRequired = true;
+            ResponseSet((uint8_t *) & FTP_RETRY_BUFFER, (uint8_t *) & transportStatusResult, FTP_COMMAND_NOT_EXECUTED, ftpHelper.nextSequenceNumber ^ RETRY_TRANSFER_bm, 1U);
+        }
+        else if (SequenceNumberValidate(packetBuffer))
+        {
+            // Call execution to handle the rest of the command processes
+            processResult = OperationalBlockExecute(packetBuffer);
+            ftpHelper.responseRequired = (imageStateStep == IMAGE_STATE_IDLE);
+
+            if ((ftpHelper.windowSize > 1U) && (processResult == BL_PASS) && (packetBuffer->data[FTP_BYTE_INDEX] == (uint8_t) FTP_WRITE_CHUNK))
+            {
+                // Acknowledge the window instead of the single chunk, the next chunk in the ring acknowledges both
+                ftpHelper.isWindowOpen = true;
+                WindowResponseSet(pendingBufferCount > 1U);
+            }
+        }
+        else
+        {
+            processResult = BL_ERROR_FRAME_VALIDATION_FAIL;
+        }
+    }
+    else
+    {
+        processResult = BL_ERROR_FRAME_VALIDATION_FAIL;
+        ftpHelper.resendRequired = true;
+        ResponseSet((uint8_t *) & FTP_RETRY_BUFFER, (uint8_t *) & transportStatusResult, FTP_COMMAND_NOT_EXECUTED, ftpHelper.nextSequenceNumber ^ RETRY_TRANSFER_bm, 1U);
+    }
+
+    // Release the buffer back to the receive ring
+    ParserDataReset(packetBuffer);
+
+    return processResult;
+}
+
+static bool SequenceNumberValidate(const ftp_packet_buffer_t * packetBuffer)
 {
     bool isValidSequenceNum = false;
 
     // Get the sequence Number info
-    ftpHelper.currentSequenceNumber = FTP_RECEIVE_BUFFER[SEQUENCE_BYTE_INDEX] & SEQUENCE_NUMBER_bm;
-    bool syncRequested = FTP_RECEIVE_BUFFER[SEQUENCE_BYTE_INDEX] & SYNC_TRANSFER_bm;
+    ftpHelper.currentSequenceNumber = packetBuffer->data[SEQUENCE_BYTE_INDEX] & SEQUENCE_NUMBER_bm;
+    bool syncRequested = packetBuffer->data[SEQUENCE_BYTE_INDEX] & SYNC_TRANSFER_bm;
 
     // Sequence Sync Check
     if (syncRequested)
@@ -506,6 +799,14 @@ static bool SequenceNumberValidate(void)
         isValidSequenceNum = true;
         ftpHelper.lastSequenceNumber = ftpHelper.currentSequenceNumber;
         ftpHelper.nextSequenceNumber = (ftpHelper.currentSequenceNumber + 1U) & MAX_SEQUENCE_VALUE;
+        // A new session starts without a window
+        ftpHelper.windowSize = 1U;
+        ftpHelper.windowReceivedMap = 0U;
+        ftpHelper.windowHeldMap = 0U;
+    }
+    else if (ftpHelper.windowSize > 1U)
+    {
+        isValidSequenceNum = WindowSequenceNumberValidate(packetBuffer);
     }
         // Else if the packet is next packet expected, execute the packet
     else if (ftpHelper.currentSequenceNumber == ftpHelper.nextSequenceNumber)
@@ -517,6 +818,7 @@ static bool SequenceNumberValidate(void)
     else if (ftpHelper.currentSequenceNumber == ftpHelper.lastSequenceNumber)
     {
         // Don't execute the command but resend the response that is already in the buffer
+        ftpStatistics.duplicateSequences++;
         isValidSequenceNum = false;
         ftpHelper.responseRequired = true;
     }
@@ -531,11 +833,131 @@ static bool SequenceNumberValidate(void)
     return isValidSequenceNum;
 }
 
-static bl_result_t OperationalBlockExecute(void)
+static bool WindowSequenceNumberValidate(const ftp_packet_buffer_t * packetBuffer)
+{
+    bool isValidSequenceNum = false;
+    uint8_t windowOffset = (uint8_t)((ftpHelper.currentSequenceNumber - ftpHelper.nextSequenceNumber) & MAX_SEQUENCE_VALUE);
+    uint32_t sequenceMask = (uint32_t)1U << (ftpHelper.currentSequenceNumber & MAX_SEQUENCE_VALUE);
+
+    if (windowOffset == 0U)
+    {
+        // The first missing command, it closes the gap in front of the commands executed ahead
+        isValidSequenceNum = true;
+        WindowAdvance();
+    }
+    else if (windowOffset < ftpHelper.windowSize)
+    {
+        if ((ftpHelper.windowReceivedMap & sequenceMask) != 0U)
+        {
+            // Sent again although it has been executed, the request for the missing command may have been lost
+            ftpStatistics.duplicateSequences++;
+            ftpHelper.isWindowResendRequested = false;
+            WindowResponseSet(false);
+        }
+        else if ((ftpHelper.isWindowOpen) && WindowRunAheadCheck(packetBuffer))
+        {
+            isValidSequenceNum = true;
+            ftpHelper.windowReceivedMap |= sequenceMask;
+        }
+        else
+        {
+            // Only write and fill chunks after the metadata block can run ahead, the others wait for the missing command
+            ftpHelper.windowHeldMap |= sequenceMask;
+            WindowResendRequest();
+        }
+    }
+    else if (windowOffset >= ((MAX_SEQUENCE_VALUE + 1U) - ftpHelper.windowSize))
+    {
+        // Sent again because the response has been lost
+        ftpStatistics.duplicateSequences++;
+        if (packetBuffer->data[FTP_BYTE_INDEX] == (uint8_t) FTP_WRITE_CHUNK)
+        {
+            ftpHelper.isWindowResendRequested = false;
+            WindowResponseSet(false);
+        }
+        else
+        {
+            // Don't execute the command but resend the response that is already in the buffer
+            ftpHelper.responseRequired = true;
+        }
+    }
+    else
+    {
+        ftpHelper.resendRequired = true;
+        ftp_transport_failure_code_t transportStatusResult = FTP_INVALID_SEQUENCE_NUMBER_ERROR;
+        ResponseSet((uint8_t *) & FTP_RETRY_BUFFER, (uint8_t *) & transportStatusResult, FTP_COMMAND_NOT_EXECUTED, ftpHelper.nextSequenceNumber ^ RETRY_TRANSFER_bm, 1U);
+    }
+
+    return isValidSequenceNum;
+}
+
+static bool WindowRunAheadCheck(const ftp_packet_buffer_t * packetBuffer)
+{
+    bool isRunAheadAllowed = false;
+
+    if ((packetBuffer->data[FTP_BYTE_INDEX] == (uint8_t) FTP_WRITE_CHUNK)
+            && (packetBuffer->receiveCount >= (FILE_DATA_INDEX + BL_BLOCK_HEADER_SIZE + FRAME_CHECK_SIZE)))
+    {
+        // The block type follows the two bytes of the block length
+        uint8_t blockType = packetBuffer->data[FILE_DATA_INDEX + 2U];
+
+        isRunAheadAllowed = ((blockType == (uint8_t) WRITE_FLASH) || (blockType == (uint8_t) FILL_FLASH));
+    }
+
+    return isRunAheadAllowed;
+}
+
+static void WindowAdvance(void)
+{
+    ftpHelper.lastSequenceNumber = ftpHelper.currentSequenceNumber & MAX_SEQUENCE_VALUE;
+    ftpHelper.nextSequenceNumber = (ftpHelper.lastSequenceNumber + 1U) & MAX_SEQUENCE_VALUE;
+    ftpHelper.isWindowResendRequested = false;
+    ftpHelper.windowHeldMap &= ~((uint32_t)1U << ftpHelper.lastSequenceNumber);
+
+    while ((ftpHelper.windowReceivedMap & ((uint32_t)1U << ftpHelper.nextSequenceNumber)) != 0U)
+    {
+        ftpHelper.windowReceivedMap &= ~((uint32_t)1U << ftpHelper.nextSequenceNumber);
+        ftpHelper.windowHeldMap &= ~((uint32_t)1U << ftpHelper.nextSequenceNumber);
+        ftpHelper.lastSequenceNumber = ftpHelper.nextSequenceNumber;
+        ftpHelper.nextSequenceNumber = (ftpHelper.nextSequenceNumber + 1U) & MAX_SEQUENCE_VALUE;
+    }
+}
+
+static void WindowResponseSet(bool isDeferred)
+{
+    // A held command has to be sent again as well, ask for the first missing one right away instead of letting the host time out
+    if ((ftpHelper.windowReceivedMap | ftpHelper.windowHeldMap) != 0U)
+    {
+        WindowResendRequest();
+        ftpHelper.responseRequired = false;
+    }
+    else
+    {
+        // The acknowledge covers every command up to the last one received in order
+        ResponseSet((uint8_t *) & FTP_RESPONSE_BUFFER, NULL, FTP_COMMAND_SUCCESS, ftpHelper.lastSequenceNumber, 0U);
+        ftpHelper.responseRequired = !isDeferred;
+    }
+}
+
+static void WindowResendRequest(void)
+{
+    if (!ftpHelper.isWindowResendRequested)
+    {
+        ftpHelper.resendRequired = true;
+        ftpHelper.isWindowResendRequested = true;
+        ftp_transport_failure_code_t transportStatusResult = FTP_INVALID_SEQUENCE_NUMBER_ERROR;
+        ResponseSet((uint8_t *) & FTP_RETRY_BUFFER, (uint8_t *) & transportStatusResult, FTP_COMMAND_NOT_EXECUTED, ftpHelper.nextSequenceNumber ^ RETRY_TRANSFER_bm, 1U);
+    }
+}
+
+static bl_result_t OperationalBlockExecute(ftp_packet_buffer_t * packetBuffer)
 {
     bl_result_t processResult = BL_BUSY;
 
-    switch (FTP_RECEIVE_BUFFER[FTP_BYTE_INDEX])
+    // Only the response of the Set Baud Rate command changes the baud rate
+    ftpHelper.responseBaudRate = 0U;
+
+    switch (packetBuffer->data[FTP_BYTE_INDEX])
     {
     case FTP_GET_CLIENT_INFO:
     {
@@ -545,21 +967,81 @@ static bl_result_t OperationalBlockExecute(void)
     }
     case FTP_GET_IMAGE_STATE:
     {
-        processResult = BL_ImageVerify();
-        ftp_image_state_t isImageValid = (processResult == BL_PASS) ? FTP_IMAGE_VALID : FTP_IMAGE_INVALID;
-        ResponseSet((uint8_t *) & FTP_RESPONSE_BUFFER, (uint8_t *) & isImageValid, FTP_COMMAND_SUCCESS, ftpHelper.currentSequenceNumber, 1U);
+        // Erase the rows skipped by the image before the download area is verified, the response is set by ImageStateTask
+        (void) BL_DownloadAreaComplete();
+        imageStateStep = IMAGE_STATE_FLASH;
+        processResult = BL_BUSY;
+        break;
+    }
+    case FTP_GET_STATISTICS:
+    {
+        StatisticsResponseSet();
+        processResult = BL_PASS;
+        break;
+    }
+    case FTP_SET_BAUD_RATE:
+    {
+        // Compared before anything is subtracted, so a frame without command data cannot wrap the length
+        if (packetBuffer->receiveCount < (FILE_DATA_INDEX + FRAME_CHECK_SIZE + 4U))
+        {
+            ftp_transport_failure_code_t transportStatusResult = FTP_COMMAND_TOO_SHORT_ERROR;
+            processResult = BL_ERROR_BUFFER_UNDERLOAD;
+            ResponseSet((uint8_t *) & FTP_RESPONSE_BUFFER, (uint8_t *) & transportStatusResult, FTP_COMMAND_NOT_EXECUTED, ftpHelper.currentSequenceNumber, 1U);
+        }
+        else
+        {
+            // The host proposes a little endian baud rate, the client confirms the closest one it supports
+            uint32_t baudRate = (uint32_t) packetBuffer->data[FILE_DATA_INDEX]
+                    | ((uint32_t) packetBuffer->data[FILE_DATA_INDEX + 1U] << 8)
+                    | ((uint32_t) packetBuffer->data[FILE_DATA_INDEX + 2U] << 16)
+                    | ((uint32_t) packetBuffer->data[FILE_DATA_INDEX + 3U] << 24);
+
+            if (baudRate < COM_MIN_BAUD_RATE)
+            {
+                baudRate = COM_MIN_BAUD_RATE;
+            }
+            else if (baudRate > COM_MAX_BAUD_RATE)
+            {
+                baudRate = COM_MAX_BAUD_RATE;
+            }
+            else
+            {
+                // Supported as proposed
+            }
+
+            processResult = BL_PASS;
+            ftpHelper.responseBaudRate = baudRate;
+            ResponseSet((uint8_t *) & FTP_RESPONSE_BUFFER, (uint8_t *) & baudRate, FTP_COMMAND_SUCCESS, ftpHelper.currentSequenceNumber, 4U);
+        }
         break;
     }
     case FTP_START_TRANSFER:
     {
+        // The window byte is optional, it is only read when the frame holds more than the sequence, command and frame check
+        bool isWindowSent = (packetBuffer->receiveCount > (FILE_DATA_INDEX + FRAME_CHECK_SIZE));
+
         processResult = BL_PASS;
         (void) BL_Initialize();
-        ResponseSet((uint8_t *) & FTP_RESPONSE_BUFFER, NULL, FTP_COMMAND_SUCCESS, ftpHelper.currentSequenceNumber, 0U);
+        ftpHelper.windowSize = 1U;
+        ftpHelper.isWindowOpen = false;
+        ftpHelper.windowReceivedMap = 0U;
+        ftpHelper.windowHeldMap = 0U;
+
+        // A host that supports the windowed mode sends the window it wants, the response holds the window granted
+        if ((true == isWindowSent) && (packetBuffer->data[FILE_DATA_INDEX] > 1U))
+        {
+            ftpHelper.windowSize = (packetBuffer->data[FILE_DATA_INDEX] > FTP_WINDOW_SIZE) ? (uint8_t) FTP_WINDOW_SIZE : packetBuffer->data[FILE_DATA_INDEX];
+            ResponseSet((uint8_t *) & FTP_RESPONSE_BUFFER, &ftpHelper.windowSize, FTP_COMMAND_SUCCESS, ftpHelper.currentSequenceNumber, 1U);
+        }
+        else
+        {
+            ResponseSet((uint8_t *) & FTP_RESPONSE_BUFFER, NULL, FTP_COMMAND_SUCCESS, ftpHelper.currentSequenceNumber, 0U);
+        }
         break;
     }
     case FTP_WRITE_CHUNK:
     {
-        processResult = BL_BootCommandProcess(&FTP_RECEIVE_BUFFER[FILE_DATA_INDEX], (ftpReceiveCount - FRAME_CHECK_SIZE - COMMAND_DATA_SIZE - SEQUENCE_DATA_SIZE));
+        processResult = BL_BootCommandProcess(&packetBuffer->data[FILE_DATA_INDEX], (packetBuffer->receiveCount - FRAME_CHECK_SIZE - COMMAND_DATA_SIZE - SEQUENCE_DATA_SIZE));
 
         if (processResult == BL_PASS)
         {
@@ -574,9 +1056,23 @@ static bl_result_t OperationalBlockExecute(void)
     }
     case FTP_END_TRANSFER:
     {
-        ResponseSet((uint8_t *) & FTP_RESPONSE_BUFFER, NULL, FTP_COMMAND_SUCCESS, ftpHelper.currentSequenceNumber, 0U);
-        resetPending = true;
-        processResult = BL_PASS;
+        // Erase the rows skipped by the image and report a queued write that failed after its block was acknowledged
+        (void) BL_DownloadAreaComplete();
+        do
+        {
+            processResult = BL_FlashTask();
+        } while (processResult == BL_BUSY);
+
+        if (processResult == BL_PASS)
+        {
+            ResponseSet((uint8_t *) & FTP_RESPONSE_BUFFER, NULL, FTP_COMMAND_SUCCESS, ftpHelper.currentSequenceNumber, 0U);
+            resetPending = true;
+        }
+        else
+        {
+            ftp_abort_code_t abortCode = AbortCodeGet(processResult);
+            ResponseSet((uint8_t *) & FTP_RESPONSE_BUFFER, (uint8_t *) & abortCode, FTP_ABORT_TRANSFER, ftpHelper.currentSequenceNumber, 1U);
+        }
         break;
     }
     default:
@@ -590,6 +1086,41 @@ static bl_result_t OperationalBlockExecute(void)
     return processResult;
 }
 
+static bl_result_t ImageStateTask(void)
+{
+    bl_result_t verifyStatus = BL_BUSY;
+
+    if (imageStateStep == IMAGE_STATE_FLASH)
+    {
+        bl_result_t flashStatus = BL_FlashTask();
+
+        if (flashStatus == BL_PASS)
+        {
+            verifyStatus = BL_ImageVerifyStart();
+            imageStateStep = IMAGE_STATE_VERIFY;
+        }
+        else
+        {
+            // A failed erase reports the image as invalid
+            verifyStatus = flashStatus;
+        }
+    }
+    else
+    {
+        verifyStatus = BL_ImageVerifyStep(VERIFY_STEP_SIZE);
+    }
+
+    if (verifyStatus != BL_BUSY)
+    {
+        ftp_image_state_t isImageValid = (verifyStatus == BL_PASS) ? FTP_IMAGE_VALID : FTP_IMAGE_INVALID;
+        ResponseSet((uint8_t *) & FTP_RESPONSE_BUFFER, (uint8_t *) & isImageValid, FTP_COMMAND_SUCCESS, ftpHelper.currentSequenceNumber, 1U);
+        ftpHelper.responseRequired = true;
+        imageStateStep = IMAGE_STATE_IDLE;
+    }
+
+    return verifyStatus;
+}
+
 static ftp_abort_code_t AbortCodeGet(bl_result_t targetStatus)
 {
     ftp_abort_code_t abortCode = FTP_GENERIC_ERROR;
@@ -614,12 +1145,10 @@ static ftp_abort_code_t AbortCodeGet(bl_result_t targetStatus)
     return abortCode;
 }
 
-static void ParserDataReset(void)
+static void ParserDataReset(ftp_packet_buffer_t * packetBuffer)
 {
-    ftpReceiveCount = 0U;
-    // Clear the transfer buffer
-    void* result = memset(&FTP_RECEIVE_BUFFER, 0x00, MAX_TRANSFER_SIZE);
-    (void)result; // Explicitly cast to void to indicate the return value is intentionally unused
+    packetBuffer->receiveCount = 0U;
+    packetBuffer->frameStatus = COM_FAIL;
 }
 
 static void DeviceResetCheck(void)
@@ -710,14 +1239,33 @@ static void ClientInfoResponseSet(void)
         .valueBuffer = (uint8_t *) & generalCommandTimeoutData
     };
 
+    uint8_t windowSize = (uint8_t) FTP_WINDOW_SIZE;
+
+    ftp_tlv_t ftpWindowTLVData = {
+        .dataType = (uint8_t)FTP_WINDOW_INFO,
+        .dataLength = 0x01U,
+        .valueBuffer = &windowSize
+    };
+
+    // Highest baud rate the Set Baud Rate command can switch to
+    uint32_t maximumBaudRate = COM_MAX_BAUD_RATE;
+
+    ftp_tlv_t ftpBaudRateTLVData = {
+        .dataType = (uint8_t)FTP_BAUD_RATE_INFO,
+        .dataLength = 0x04U,
+        .valueBuffer = (uint8_t *) & maximumBaudRate
+    };
+
     // Calculate and set the response length
     ftpResponseLength = (uint16_t)(
             (uint16_t)ftpVersionTLVData.dataLength +
             (uint16_t)ftpTransferParametersTLVData.dataLength +
             (uint16_t)ftpTimeoutTLVData.dataLength +
+            (uint16_t)ftpWindowTLVData.dataLength +
+            (uint16_t)ftpBaudRateTLVData.dataLength +
             (uint16_t)SEQUENCE_DATA_SIZE +
             (uint16_t)COMMAND_DATA_SIZE +
-            (uint16_t)(uint16_t)(uint16_t)((uint16_t)TLV_HEADER_SIZE * 3U)
+            (uint16_t)(uint16_t)(uint16_t)((uint16_t)TLV_HEADER_SIZE * 5U)
             );
 
     // Update The Sequence Value
@@ -731,8 +1279,26 @@ static void ClientInfoResponseSet(void)
     // Push each TLV Byte Stream to the buffer
     fileDataOffset += TLVAppend(&(FTP_RESPONSE_BUFFER[fileDataOffset]), &ftpVersionTLVData);
     fileDataOffset += TLVAppend(&(FTP_RESPONSE_BUFFER[fileDataOffset]), &ftpTransferParametersTLVData);
+    fileDataOffset += TLVAppend(&(FTP_RESPONSE_BUFFER[fileDataOffset]), &ftpTimeoutTLVData);
+    fileDataOffset += TLVAppend(&(FTP_RESPONSE_BUFFER[fileDataOffset]), &ftpWindowTLVData);
     // Drop the length of the last TLV append command because it is not needed
-    (void) TLVAppend(&(FTP_RESPONSE_BUFFER[fileDataOffset]), &ftpTimeoutTLVData);
+    (void) TLVAppend(&(FTP_RESPONSE_BUFFER[fileDataOffset]), &ftpBaudRateTLVData);
+}
+
+static void StatisticsResponseSet(void)
+{
+    const bl_flash_statistics_t * flashStatistics = BL_FlashStatisticsGet();
+    uint32_t statisticsData[STATISTICS_WORD_COUNT] = {
+        ftpStatistics.framesReceived,
+        ftpStatistics.frameCheckFailures,
+        ftpStatistics.resends,
+        ftpStatistics.duplicateSequences,
+        flashStatistics->bytesProgrammed,
+        flashStatistics->rowsErased,
+        flashStatistics->busyTime,
+    };
+
+    ResponseSet((uint8_t *) & FTP_RESPONSE_BUFFER, (uint8_t *) & statisticsData[0], FTP_COMMAND_SUCCESS, ftpHelper.currentSequenceNumber, (uint16_t) sizeof(statisticsData));
 }
 
 bl_result_t FTP_Initialize(void)
@@ -741,5 +1307,18 @@ bl_result_t FTP_Initialize(void)
     com_adapter_result_t comInitStatus = COM_Initialize((uint16_t)MAX_TRANSFER_SIZE);
     isComBusy = false;
     resetPending = false;
+    imageStateStep = IMAGE_STATE_IDLE;
+    ftpHelper.windowSize = 1U;
+    ftpHelper.windowReceivedMap = 0U;
+    ftpHelper.windowHeldMap = 0U;
+    receiveBufferIndex = 0U;
+    processBufferIndex = 0U;
+    pendingBufferCount = 0U;
+    for (uint8_t bufferIndex = 0U; bufferIndex < PACKET_BUFFER_COUNT; bufferIndex++)
+    {
+        receiveRing[bufferIndex] = &FTP_RECEIVE_BUFFER[bufferIndex];
+        ParserDataReset(receiveRing[bufferIndex]);
+    }
+    spareBuffer = &FTP_RECEIVE_BUFFER[PACKET_BUFFER_COUNT];
     return (comInitStatus == COM_PASS) ? BL_PASS : BL_FAIL;
 }
\ No newline at end of file
@@ -0,0 +1,82 @@
+/**
+ * @file    sim_dsu.c
+ * @ingroup mdfu_host_sim
+ * @brief   Stand-in for the DSU PLIB with a software CRC-32.
+ *
+ * The DSU uses the reflected IEEE 802.3 polynomial and returns the CRC register without the
+ * final inversion, so the result for a seed of 0xFFFFFFFF is the bitwise inverse of the usual
+ * CRC-32 (zlib, Ethernet) of the same data. The calculation moves the virtual clock by the CRC
+ * time of every word.
+ */
+
+#include "peripheral/dsu/plib_dsu.h"
+#include "sim_hal.h"
+#include "sim_internal.h"
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_CRC32_POLYNOMIAL
+ * @brief Reflected CRC-32 polynomial used by the DSU.
+ */
+#define SIM_CRC32_POLYNOMIAL    (0xEDB88320U)
+
+static uint32_t crcTable[256];
+static bool isCrcTableReady = false;
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Fills the byte-wise lookup table of the CRC.
+ *
+ * @param None
+ * @return None
+ */
+static void CrcTableBuild(void);
+
+static void CrcTableBuild(void)
+{
+    for (uint32_t tableIndex = 0U; tableIndex < 256U; tableIndex++)
+    {
+        uint32_t crcValue = tableIndex;
+
+        for (uint8_t bitIndex = 0U; bitIndex < 8U; bitIndex++)
+        {
+            crcValue = ((crcValue & 1U) != 0U) ? ((crcValue >> 1) ^ SIM_CRC32_POLYNOMIAL) : (crcValue >> 1);
+        }
+        crcTable[tableIndex] = crcValue;
+    }
+    isCrcTableReady = true;
+}
+
+bool DSU_CRCCalculate(uint32_t startAddress, size_t length, uint32_t crcSeed, uint32_t * crc)
+{
+    bool statusValue = false;
+
+    // The DSU ignores the two lower bits of the address and of the length
+    uint32_t wordAddress = startAddress & ~3U;
+    uint32_t wordLength = (uint32_t) length & ~3U;
+    const uint8_t * memoryPtr = SIM_MemoryGet(wordAddress, wordLength);
+
+    if (isCrcTableReady == false)
+    {
+        CrcTableBuild();
+    }
+
+    // A range outside of the Flash ends with a bus error
+    if ((0U != length) && (NULL != crc) && (NULL != memoryPtr))
+    {
+        uint32_t crcValue = crcSeed;
+
+        SIM_NvmctrlReadStall(wordAddress);
+        SIM_TimeAdvance((uint64_t) SIM_FlashTimingGet()->crcWordTime * (wordLength / 4U));
+
+        for (uint32_t byteIndex = 0U; byteIndex < wordLength; byteIndex++)
+        {
+            crcValue = crcTable[(crcValue ^ memoryPtr[byteIndex]) & 0xFFU] ^ (crcValue >> 8);
+        }
+
+        *crc = crcValue;
+        statusValue = true;
+    }
+
+    return statusValue;
+}
@@ -0,0 +1,109 @@
+/**
+ * @file    sim_i2c.c
+ * @ingroup mdfu_host_sim
+ * @brief   Stand-in for the SERCOM0 I2C client PLIB.
+ *
+ * A host transaction is turned into the sequence of events that the PLIB interrupt handler
+ * passes to the registered callback: address match, one event per byte and the stop condition.
+ */
+
+#include "peripheral/sercom/i2c_slave/plib_sercom0_i2c_slave.h"
+#include "sim_hal.h"
+#include "sim_internal.h"
+
+static SERCOM_I2C_SLAVE_CALLBACK eventCallback = NULL;
+static uintptr_t eventContext = 0U;
+static SERCOM_I2C_SLAVE_TRANSFER_DIR transferDirection = SERCOM_I2C_SLAVE_TRANSFER_DIR_WRITE;
+static uint8_t receivedByte = 0U;
+static uint8_t sentByte = 0U;
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Passes an event to the callback of the device.
+ *
+ * @param[in] event - Event of the transaction
+ * @return True - The device acknowledges
+ * @return False - The device does not acknowledge or has no callback
+ */
+static bool EventRaise(SERCOM_I2C_SLAVE_TRANSFER_EVENT event);
+
+static bool EventRaise(SERCOM_I2C_SLAVE_TRANSFER_EVENT event)
+{
+    bool isAcknowledged = false;
+
+    if (eventCallback != NULL)
+    {
+        isAcknowledged = eventCallback(event, eventContext);
+    }
+
+    return isAcknowledged;
+}
+
+void SIM_SerialReset(void)
+{
+    transferDirection = SERCOM_I2C_SLAVE_TRANSFER_DIR_WRITE;
+    receivedByte = 0U;
+    sentByte = 0U;
+}
+
+bool SIM_I2cWrite(const uint8_t * data, size_t length)
+{
+    transferDirection = SERCOM_I2C_SLAVE_TRANSFER_DIR_WRITE;
+    bool isAcknowledged = EventRaise(SERCOM_I2C_SLAVE_TRANSFER_EVENT_ADDR_MATCH);
+
+    if (isAcknowledged)
+    {
+        for (size_t byteIndex = 0U; byteIndex < length; byteIndex++)
+        {
+            receivedByte = data[byteIndex];
+            (void) EventRaise(SERCOM_I2C_SLAVE_TRANSFER_EVENT_RX_READY);
+        }
+        (void) EventRaise(SERCOM_I2C_SLAVE_TRANSFER_EVENT_STOP_BIT_RECEIVED);
+    }
+
+    return isAcknowledged;
+}
+
+bool SIM_I2cRead(uint8_t * data, size_t length)
+{
+    transferDirection = SERCOM_I2C_SLAVE_TRANSFER_DIR_READ;
+    bool isAcknowledged = EventRaise(SERCOM_I2C_SLAVE_TRANSFER_EVENT_ADDR_MATCH);
+
+    if (isAcknowledged)
+    {
+        for (size_t byteIndex = 0U; byteIndex < length; byteIndex++)
+        {
+            (void) EventRaise(SERCOM_I2C_SLAVE_TRANSFER_EVENT_TX_READY);
+            data[byteIndex] = sentByte;
+        }
+        (void) EventRaise(SERCOM_I2C_SLAVE_TRANSFER_EVENT_STOP_BIT_RECEIVED);
+    }
+
+    return isAcknowledged;
+}
+
+void SERCOM0_I2C_CallbackRegister(SERCOM_I2C_SLAVE_CALLBACK callback, uintptr_t contextHandle)
+{
+    eventCallback = callback;
+    eventContext = contextHandle;
+}
+
+uint8_t SERCOM0_I2C_ReadByte(void)
+{
+    return receivedByte;
+}
+
+void SERCOM0_I2C_WriteByte(uint8_t wrByte)
+{
+    sentByte = wrByte;
+}
+
+SERCOM_I2C_SLAVE_ERROR SERCOM0_I2C_ErrorGet(void)
+{
+    return 0U;
+}
+
+SERCOM_I2C_SLAVE_TRANSFER_DIR SERCOM0_I2C_TransferDirGet(void)
+{
+    return transferDirection;
+}
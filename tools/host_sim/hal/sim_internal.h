@@ -0,0 +1,52 @@
+/**
+ * @file    sim_internal.h
+ * @ingroup mdfu_host_sim
+ * @brief   Functions shared between the stand-in PLIBs of the simulated HAL.
+ */
+#ifndef SIM_INTERNAL_H
+#define SIM_INTERNAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Erases the main and data Flash and unlocks all regions.
+ *
+ * @param None
+ * @return None
+ */
+void SIM_NvmctrlReset(void);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Waits until a command of the NVMCTRL on the array that holds the address has finished.
+ *
+ * A read of the array that is being programmed or erased stalls the bus until the command ends,
+ * the other array can be read at once.
+ *
+ * @param[in] address - Address about to be read
+ * @return None
+ */
+void SIM_NvmctrlReadStall(uint32_t address);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Empties the serial port of the simulated device, implemented by the stand-in of each transport.
+ *
+ * @param None
+ * @return None
+ */
+void SIM_SerialReset(void);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Drives input pins of PORT group A to the given level.
+ *
+ * @param[in] pinMask - Mask of the pins
+ * @param[in] isHigh - True to read the pins as high, false as low
+ * @return None
+ */
+void SIM_PortInputSet(uint32_t pinMask, bool isHigh);
+
+#endif // SIM_INTERNAL_H
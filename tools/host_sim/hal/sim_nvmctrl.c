@@ -0,0 +1,498 @@
+/**
+ * @file    sim_nvmctrl.c
+ * @ingroup mdfu_host_sim
+ * @brief   Stand-in for the NVMCTRL PLIB backed by in-memory main and data Flash arrays.
+ *
+ * Programming can only clear bits, an erase sets a whole row back to the erased value and a
+ * locked region rejects both with a lock error, as on the device. Each command keeps the
+ * controller busy for its duration on the virtual clock, a command issued before the previous one
+ * has finished is rejected with a programming error. The erases of every row are counted.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "peripheral/nvmctrl/plib_nvmctrl.h"
+#include "sim_hal.h"
+#include "sim_internal.h"
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_LOCK_REGION_COUNT
+ * @brief Number of lock regions of the main Flash.
+ */
+#define SIM_LOCK_REGION_COUNT   (16U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_DSU_DID_ADDRESS
+ * @brief Address of the DSU device identification register.
+ */
+#define SIM_DSU_DID_ADDRESS     (0x41002018U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_FLASH_PAGE_COUNT
+ * @brief Number of pages of the main and the data Flash together.
+ */
+#define SIM_FLASH_PAGE_COUNT    ((FLASH_SIZE + DATAFLASH_SIZE) / NVMCTRL_FLASH_PAGESIZE)
+
+static uint8_t flashMemory[FLASH_SIZE];
+static uint8_t dataFlashMemory[DATAFLASH_SIZE];
+static bool isRegionLocked[SIM_LOCK_REGION_COUNT];
+static NVMCTRL_ERROR nvmError = NVMCTRL_ERROR_NONE;
+static uint32_t deviceIdRegister = CHIP_DSU_DID;
+static uint32_t rowEraseCount[FLASH_SIZE / NVMCTRL_FLASH_ROWSIZE];
+static uint32_t dataRowEraseCount[DATAFLASH_SIZE / NVMCTRL_DATAFLASH_ROWSIZE];
+static bool isPageWritten[SIM_FLASH_PAGE_COUNT];
+static sim_flash_statistics_t flashStatistics;
+static uint64_t busyEndTime = 0U;
+static bool isDataFlashBusy = false;
+
+// Page write and row erase are the maximum values of the NVM characteristics. The region lock
+// commands have no specified time and the CPU and DSU costs are estimates at 48 MHz.
+static sim_flash_timing_t flashTiming = {
+    .pageWriteTime = 2500000U,
+    .rowEraseTime = 6000000U,
+    .regionLockTime = 10000U,
+    .busyPollTime = 250U,
+    .crcWordTime = 84U,
+};
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Programs one page into the given memory, a programmed bit cannot be set back to one.
+ *
+ * @param[in] memoryPtr - Simulated memory of the page
+ * @param[in] data - Page data
+ * @return None
+ */
+static void PageProgram(uint8_t * memoryPtr, const uint32_t * data);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Checks if the main Flash address is in a locked region and raises the lock error if so.
+ *
+ * @param[in] address - Main Flash address
+ * @return True - The region is locked
+ * @return False - The region can be programmed and erased
+ */
+static bool RegionLockCheck(uint32_t address);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Starts a command of the given duration unless the controller is still busy.
+ *
+ * @param[in] address - Address of the command, selects the main or the data Flash
+ * @param[in] duration - Time in nanoseconds the controller stays busy
+ * @return True - The command has been started
+ * @return False - The previous command has not finished, the programming error is raised
+ */
+static bool CommandStart(uint32_t address, uint32_t duration);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Counts a page write and checks if the page has been written since its last erase.
+ *
+ * @param[in] pageAddress - Address of the page
+ * @return None
+ */
+static void PageWriteCount(uint32_t pageAddress);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Counts a row erase and marks the pages of the row as erased.
+ *
+ * @param[in] rowAddress - Address of the row
+ * @param[in] eraseCount - Erase counter of the row
+ * @return None
+ */
+static void RowEraseCount(uint32_t rowAddress, uint32_t * eraseCount);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Returns the index of a page in the list of the main and the data Flash pages.
+ *
+ * @param[in] pageAddress - Address of the page
+ * @return Index of the page
+ */
+static uint32_t PageIndexGet(uint32_t pageAddress);
+
+static void PageProgram(uint8_t * memoryPtr, const uint32_t * data)
+{
+    uint8_t pageData[NVMCTRL_FLASH_PAGESIZE];
+
+    (void) memcpy(&pageData[0], data, NVMCTRL_FLASH_PAGESIZE);
+
+    for (uint32_t byteIndex = 0U; byteIndex < NVMCTRL_FLASH_PAGESIZE; byteIndex++)
+    {
+        memoryPtr[byteIndex] &= pageData[byteIndex];
+    }
+}
+
+static bool RegionLockCheck(uint32_t address)
+{
+    bool isLocked = isRegionLocked[(address - FLASH_ADDR) / (FLASH_SIZE / SIM_LOCK_REGION_COUNT)];
+
+    if (isLocked)
+    {
+        nvmError |= NVMCTRL_ERROR_LOCK;
+    }
+
+    return isLocked;
+}
+
+static bool CommandStart(uint32_t address, uint32_t duration)
+{
+    bool isStarted = (SIM_TimeGet() >= busyEndTime);
+
+    if (isStarted)
+    {
+        busyEndTime = SIM_TimeGet() + duration;
+        isDataFlashBusy = (address >= DATAFLASH_ADDR);
+        flashStatistics.busyTime += duration;
+    }
+    else
+    {
+        nvmError |= NVMCTRL_ERROR_PROG;
+    }
+
+    return isStarted;
+}
+
+static uint32_t PageIndexGet(uint32_t pageAddress)
+{
+    uint32_t pageIndex = (pageAddress - FLASH_ADDR) / NVMCTRL_FLASH_PAGESIZE;
+
+    if (pageAddress >= DATAFLASH_ADDR)
+    {
+        pageIndex = (FLASH_SIZE + (pageAddress - DATAFLASH_ADDR)) / NVMCTRL_FLASH_PAGESIZE;
+    }
+
+    return pageIndex;
+}
+
+static void PageWriteCount(uint32_t pageAddress)
+{
+    uint32_t pageIndex = PageIndexGet(pageAddress);
+
+    flashStatistics.pageWrites++;
+    if (isPageWritten[pageIndex])
+    {
+        flashStatistics.pageRewrites++;
+    }
+    isPageWritten[pageIndex] = true;
+}
+
+static void RowEraseCount(uint32_t rowAddress, uint32_t * eraseCount)
+{
+    uint32_t pageIndex = PageIndexGet(rowAddress);
+
+    flashStatistics.rowErases++;
+    if (*eraseCount == 0U)
+    {
+        flashStatistics.erasedRows++;
+    }
+    *eraseCount += 1U;
+
+    if (rowAddress >= DATAFLASH_ADDR)
+    {
+        flashStatistics.maxDataRowErases = (*eraseCount > flashStatistics.maxDataRowErases) ? *eraseCount : flashStatistics.maxDataRowErases;
+    }
+    else
+    {
+        flashStatistics.maxRowErases = (*eraseCount > flashStatistics.maxRowErases) ? *eraseCount : flashStatistics.maxRowErases;
+    }
+
+    (void) memset(&isPageWritten[pageIndex], 0, NVMCTRL_FLASH_ROWSIZE / NVMCTRL_FLASH_PAGESIZE);
+}
+
+void SIM_NvmctrlReadStall(uint32_t address)
+{
+    uint64_t currentTime = SIM_TimeGet();
+    bool isMainFlashRead = ((address - FLASH_ADDR) < FLASH_SIZE);
+    bool isDataFlashRead = ((address - DATAFLASH_ADDR) < DATAFLASH_SIZE);
+
+    if ((currentTime < busyEndTime) && ((isMainFlashRead && !isDataFlashBusy) || (isDataFlashRead && isDataFlashBusy)))
+    {
+        SIM_TimeAdvance(busyEndTime - currentTime);
+    }
+}
+
+void SIM_FlashTimingSet(const sim_flash_timing_t * timing)
+{
+    flashTiming = *timing;
+}
+
+const sim_flash_timing_t * SIM_FlashTimingGet(void)
+{
+    return &flashTiming;
+}
+
+void SIM_FlashStatisticsGet(sim_flash_statistics_t * statistics)
+{
+    *statistics = flashStatistics;
+}
+
+uint32_t SIM_FlashRowEraseCountGet(uint32_t address)
+{
+    uint32_t eraseCount = 0U;
+
+    if ((address - FLASH_ADDR) < FLASH_SIZE)
+    {
+        eraseCount = rowEraseCount[(address - FLASH_ADDR) / NVMCTRL_FLASH_ROWSIZE];
+    }
+    else if ((address - DATAFLASH_ADDR) < DATAFLASH_SIZE)
+    {
+        eraseCount = dataRowEraseCount[(address - DATAFLASH_ADDR) / NVMCTRL_DATAFLASH_ROWSIZE];
+    }
+    else
+    {
+        // Not a Flash address
+    }
+
+    return eraseCount;
+}
+
+uint8_t * SIM_MemoryGet(uint32_t address, uint32_t length)
+{
+    uint8_t * memoryPtr = NULL;
+
+    if ((length <= FLASH_SIZE) && ((address - FLASH_ADDR) <= (FLASH_SIZE - length)))
+    {
+        memoryPtr = &flashMemory[address - FLASH_ADDR];
+    }
+    else if ((length <= DATAFLASH_SIZE) && ((address - DATAFLASH_ADDR) <= (DATAFLASH_SIZE - length)))
+    {
+        memoryPtr = &dataFlashMemory[address - DATAFLASH_ADDR];
+    }
+    else
+    {
+        // Not a Flash address
+    }
+
+    return memoryPtr;
+}
+
+bool SIM_FlashSave(const char * path)
+{
+    bool isSaved = false;
+    FILE * flashFile = fopen(path, "wb");
+
+    if (flashFile != NULL)
+    {
+        isSaved = (fwrite(&flashMemory[0], 1U, sizeof(flashMemory), flashFile) == sizeof(flashMemory))
+                && (fwrite(&dataFlashMemory[0], 1U, sizeof(dataFlashMemory), flashFile) == sizeof(dataFlashMemory));
+        isSaved = (fclose(flashFile) == 0) && isSaved;
+    }
+
+    return isSaved;
+}
+
+bool SIM_FlashLoad(const char * path)
+{
+    bool isLoaded = false;
+    FILE * flashFile = fopen(path, "rb");
+
+    if (flashFile != NULL)
+    {
+        isLoaded = (fread(&flashMemory[0], 1U, sizeof(flashMemory), flashFile) == sizeof(flashMemory))
+                && (fread(&dataFlashMemory[0], 1U, sizeof(dataFlashMemory), flashFile) == sizeof(dataFlashMemory));
+        (void) fclose(flashFile);
+    }
+
+    for (uint32_t pageIndex = 0U; (isLoaded == true) && (pageIndex < SIM_FLASH_PAGE_COUNT); pageIndex++)
+    {
+        const uint8_t * pagePtr = (pageIndex < (FLASH_SIZE / NVMCTRL_FLASH_PAGESIZE))
+                ? &flashMemory[pageIndex * NVMCTRL_FLASH_PAGESIZE]
+                : &dataFlashMemory[(pageIndex * NVMCTRL_FLASH_PAGESIZE) - FLASH_SIZE];
+
+        // A programmed page has to be erased before it is written again, as after a write
+        isPageWritten[pageIndex] = false;
+        for (uint32_t byteIndex = 0U; byteIndex < NVMCTRL_FLASH_PAGESIZE; byteIndex++)
+        {
+            if (pagePtr[byteIndex] != SIM_FLASH_ERASED_VALUE)
+            {
+                isPageWritten[pageIndex] = true;
+                break;
+            }
+        }
+    }
+
+    return isLoaded;
+}
+
+void SIM_DeviceIdSet(uint32_t deviceId)
+{
+    deviceIdRegister = deviceId;
+}
+
+void SIM_NvmctrlReset(void)
+{
+    (void) memset(&flashMemory[0], SIM_FLASH_ERASED_VALUE, sizeof(flashMemory));
+    (void) memset(&dataFlashMemory[0], SIM_FLASH_ERASED_VALUE, sizeof(dataFlashMemory));
+    (void) memset(&isRegionLocked[0], 0, sizeof(isRegionLocked));
+    (void) memset(&rowEraseCount[0], 0, sizeof(rowEraseCount));
+    (void) memset(&dataRowEraseCount[0], 0, sizeof(dataRowEraseCount));
+    (void) memset(&isPageWritten[0], 0, sizeof(isPageWritten));
+    (void) memset(&flashStatistics, 0, sizeof(flashStatistics));
+    nvmError = NVMCTRL_ERROR_NONE;
+    busyEndTime = 0U;
+    isDataFlashBusy = false;
+}
+
+void NVMCTRL_Initialize(void)
+{
+    nvmError = NVMCTRL_ERROR_NONE;
+}
+
+bool NVMCTRL_Read(uint32_t *data, uint32_t length, const uint32_t address)
+{
+    const uint8_t * memoryPtr = SIM_MemoryGet(address, length);
+
+    if ((address >= SIM_DSU_DID_ADDRESS) && ((address - SIM_DSU_DID_ADDRESS) < sizeof(deviceIdRegister))
+            && (length <= (sizeof(deviceIdRegister) - (address - SIM_DSU_DID_ADDRESS))))
+    {
+        memoryPtr = &((const uint8_t *) &deviceIdRegister)[address - SIM_DSU_DID_ADDRESS];
+    }
+
+    if (memoryPtr == NULL)
+    {
+        // The device would take a hard fault on an unmapped read
+        (void) fprintf(stderr, "sim: read of %u bytes at unmapped address 0x%08X\n", (unsigned int) length, (unsigned int) address);
+        abort();
+    }
+
+    SIM_NvmctrlReadStall(address);
+    (void) memcpy(data, memoryPtr, length);
+    return true;
+}
+
+bool NVMCTRL_DATA_FLASH_Read(uint32_t *data, uint32_t length, const uint32_t address)
+{
+    return NVMCTRL_Read(data, length, address);
+}
+
+bool NVMCTRL_PageWrite(uint32_t *data, const uint32_t address)
+{
+    uint32_t pageAddress = address - (address % NVMCTRL_FLASH_PAGESIZE);
+    uint8_t * memoryPtr = SIM_MemoryGet(pageAddress, NVMCTRL_FLASH_PAGESIZE);
+
+    if ((memoryPtr == NULL) || (pageAddress >= DATAFLASH_ADDR))
+    {
+        nvmError |= NVMCTRL_ERROR_NVM;
+    }
+    else if ((RegionLockCheck(pageAddress) == false) && CommandStart(pageAddress, flashTiming.pageWriteTime))
+    {
+        PageProgram(memoryPtr, data);
+        PageWriteCount(pageAddress);
+    }
+    else
+    {
+        // Rejected by the lock
+    }
+
+    return true;
+}
+
+bool NVMCTRL_RowErase(uint32_t address)
+{
+    uint32_t rowAddress = address - (address % NVMCTRL_FLASH_ROWSIZE);
+    uint8_t * memoryPtr = SIM_MemoryGet(rowAddress, NVMCTRL_FLASH_ROWSIZE);
+
+    if ((memoryPtr == NULL) || (rowAddress >= DATAFLASH_ADDR))
+    {
+        nvmError |= NVMCTRL_ERROR_NVM;
+    }
+    else if ((RegionLockCheck(rowAddress) == false) && CommandStart(rowAddress, flashTiming.rowEraseTime))
+    {
+        (void) memset(memoryPtr, SIM_FLASH_ERASED_VALUE, NVMCTRL_FLASH_ROWSIZE);
+        RowEraseCount(rowAddress, &rowEraseCount[(rowAddress - FLASH_ADDR) / NVMCTRL_FLASH_ROWSIZE]);
+    }
+    else
+    {
+        // Rejected by the lock
+    }
+
+    return true;
+}
+
+bool NVMCTRL_DATA_FLASH_PageWrite(uint32_t *data, const uint32_t address)
+{
+    uint32_t pageAddress = address - (address % NVMCTRL_DATAFLASH_PAGESIZE);
+    uint8_t * memoryPtr = SIM_MemoryGet(pageAddress, NVMCTRL_DATAFLASH_PAGESIZE);
+
+    if ((memoryPtr == NULL) || (pageAddress < DATAFLASH_ADDR))
+    {
+        nvmError |= NVMCTRL_ERROR_NVM;
+    }
+    else if (CommandStart(pageAddress, flashTiming.pageWriteTime))
+    {
+        PageProgram(memoryPtr, data);
+        PageWriteCount(pageAddress);
+    }
+    else
+    {
+        // Rejected while busy
+    }
+
+    return true;
+}
+
+bool NVMCTRL_DATA_FLASH_RowErase(uint32_t address)
+{
+    uint32_t rowAddress = address - (address % NVMCTRL_DATAFLASH_ROWSIZE);
+    uint8_t * memoryPtr = SIM_MemoryGet(rowAddress, NVMCTRL_DATAFLASH_ROWSIZE);
+
+    if ((memoryPtr == NULL) || (rowAddress < DATAFLASH_ADDR))
+    {
+        nvmError |= NVMCTRL_ERROR_NVM;
+    }
+    else if (CommandStart(rowAddress, flashTiming.rowEraseTime))
+    {
+        (void) memset(memoryPtr, SIM_FLASH_ERASED_VALUE, NVMCTRL_DATAFLASH_ROWSIZE);
+        RowEraseCount(rowAddress, &dataRowEraseCount[(rowAddress - DATAFLASH_ADDR) / NVMCTRL_DATAFLASH_ROWSIZE]);
+    }
+    else
+    {
+        // Rejected while busy
+    }
+
+    return true;
+}
+
+NVMCTRL_ERROR NVMCTRL_ErrorGet(void)
+{
+    NVMCTRL_ERROR error = nvmError;
+
+    // Reading the errors clears them, as on the device
+    nvmError = NVMCTRL_ERROR_NONE;
+
+    return error;
+}
+
+bool NVMCTRL_IsBusy(void)
+{
+    // Every poll costs CPU time, so a polling loop moves the clock to the end of the command
+    SIM_TimeAdvance(flashTiming.busyPollTime);
+
+    return (SIM_TimeGet() < busyEndTime);
+}
+
+void NVMCTRL_RegionLock(uint32_t address)
+{
+    if ((address < FLASH_SIZE) && CommandStart(address, flashTiming.regionLockTime))
+    {
+        isRegionLocked[address / (FLASH_SIZE / SIM_LOCK_REGION_COUNT)] = true;
+        flashStatistics.regionLocks++;
+    }
+}
+
+void NVMCTRL_RegionUnlock(uint32_t address)
+{
+    if ((address < FLASH_SIZE) && CommandStart(address, flashTiming.regionLockTime))
+    {
+        isRegionLocked[address / (FLASH_SIZE / SIM_LOCK_REGION_COUNT)] = false;
+        flashStatistics.regionLocks++;
+    }
+}
@@ -0,0 +1,340 @@
+/**
+ * @file    sim_spi.c
+ * @ingroup mdfu_host_sim
+ * @brief   Stand-ins for the SERCOM3 SPI client and DMAC PLIBs.
+ *
+ * Every byte of a host transaction is moved by the DMAC channel that reads from or writes to the
+ * SERCOM data register, following the descriptors armed by the device. A received byte that no
+ * channel takes stays in the two byte receive buffer of the SERCOM, later ones overflow it.
+ *
+ * The descriptors hold 32-bit addresses, so the simulation is linked as a position dependent
+ * executable to keep the addresses of its static data below 4 GB.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "peripheral/sercom/spi_slave/plib_sercom3_spi_slave.h"
+#include "peripheral/dmac/plib_dmac.h"
+#include "peripheral/port/plib_port.h"
+#include "sim_hal.h"
+#include "sim_internal.h"
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_DMAC_CHANNEL_COUNT
+ * @brief Number of DMAC channels used by the bootloader.
+ */
+#define SIM_DMAC_CHANNEL_COUNT      (2U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_SPI_RX_BUFFER_SIZE
+ * @brief Depth of the receive buffer of the SERCOM.
+ */
+#define SIM_SPI_RX_BUFFER_SIZE      (2U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_SPI_IDLE_VALUE
+ * @brief Value shifted out by the device when no DMAC channel provides a byte.
+ */
+#define SIM_SPI_IDLE_VALUE          (0xFFU)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @struct sim_dmac_channel_t
+ * @brief State of one DMAC channel.
+ * @var sim_dmac_channel_t:: isEnabled
+ * The channel moves data
+ * @var sim_dmac_channel_t:: writeBack
+ * Copy of the active descriptor with the count of beats left, as in the write-back section
+ */
+typedef struct
+{
+    bool isEnabled;
+    dmac_descriptor_registers_t writeBack;
+} sim_dmac_channel_t;
+
+// Same block settings as the DMAC PLIB: channel 0 fills memory, channel 1 feeds the SERCOM
+static const uint16_t channelBlockControl[SIM_DMAC_CHANNEL_COUNT] = {
+    (uint16_t)(DMAC_BTCTRL_BLOCKACT_NOACT | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_DSTINC_Msk | DMAC_BTCTRL_VALID_Msk),
+    (uint16_t)(DMAC_BTCTRL_BLOCKACT_NOACT | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_SRCINC_Msk | DMAC_BTCTRL_VALID_Msk),
+};
+
+static sim_dmac_channel_t dmacChannels[SIM_DMAC_CHANNEL_COUNT];
+static volatile uint32_t spiDataRegister;
+static uint8_t rxBuffer[SIM_SPI_RX_BUFFER_SIZE];
+static uint8_t rxCount = 0U;
+static bool isTransferStarted = false;
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Converts a 32-bit address of a descriptor back to a host pointer.
+ *
+ * @param[in] address - Address written into a descriptor
+ * @return Host pointer
+ */
+static uint8_t * AddressToPointer(uint32_t address);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Converts a host pointer to the 32-bit address written into a descriptor.
+ *
+ * @param[in] pointer - Host pointer
+ * @return Address for the descriptor
+ */
+static uint32_t PointerToAddress(const volatile void * pointer);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Moves one beat of the channel and loads the next descriptor at the end of a block.
+ *
+ * @param[in] channel - Channel to step
+ * @param[in] data - Byte received from the SERCOM, ignored by a channel that writes to the SERCOM
+ * @return Byte read by the channel
+ */
+static uint8_t ChannelBeat(sim_dmac_channel_t * channel, uint8_t data);
+
+static uint8_t * AddressToPointer(uint32_t address)
+{
+    /* cppcheck-suppress misra-c2012-11.4 */
+    return (uint8_t *)(uintptr_t) address;
+}
+
+static uint32_t PointerToAddress(const volatile void * pointer)
+{
+    uintptr_t address = (uintptr_t) pointer;
+
+    if (address > UINT32_MAX)
+    {
+        (void) fprintf(stderr, "sim: %p does not fit into a DMAC descriptor, link the simulation without PIE\n", (const void *) pointer);
+        abort();
+    }
+
+    return (uint32_t) address;
+}
+
+static uint8_t ChannelBeat(sim_dmac_channel_t * channel, uint8_t data)
+{
+    dmac_descriptor_registers_t * active = &channel->writeBack;
+    uint8_t readData = SIM_SPI_IDLE_VALUE;
+
+    // Incrementing addresses hold the end of the block
+    uint32_t sourceAddress = active->DMAC_SRCADDR;
+    uint32_t destinationAddress = active->DMAC_DSTADDR;
+    if ((active->DMAC_BTCTRL & DMAC_BTCTRL_SRCINC_Msk) != 0U)
+    {
+        sourceAddress -= active->DMAC_BTCNT;
+    }
+    if ((active->DMAC_BTCTRL & DMAC_BTCTRL_DSTINC_Msk) != 0U)
+    {
+        destinationAddress -= active->DMAC_BTCNT;
+    }
+
+    if (sourceAddress == PointerToAddress(&spiDataRegister))
+    {
+        *AddressToPointer(destinationAddress) = data;
+    }
+    else
+    {
+        readData = *AddressToPointer(sourceAddress);
+    }
+
+    active->DMAC_BTCNT--;
+
+    if (active->DMAC_BTCNT == 0U)
+    {
+        if (active->DMAC_DESCADDR != 0U)
+        {
+            /* cppcheck-suppress misra-c2012-11.3 */
+            (void) memcpy(active, AddressToPointer(active->DMAC_DESCADDR), sizeof(dmac_descriptor_registers_t));
+        }
+        else
+        {
+            channel->isEnabled = false;
+        }
+    }
+
+    return readData;
+}
+
+void SIM_SerialReset(void)
+{
+    (void) memset(&dmacChannels[0], 0, sizeof(dmacChannels));
+    rxCount = 0U;
+    isTransferStarted = false;
+}
+
+void SIM_SpiTransfer(const uint8_t * hostData, uint8_t * clientData, size_t length)
+{
+    sim_dmac_channel_t * sendChannel = NULL;
+    sim_dmac_channel_t * receiveChannel = NULL;
+
+    // The chip select pin reads low for the whole transaction
+    SIM_PortInputSet((uint32_t)1U << (uint32_t) CHIP_SELECT_PIN, false);
+    isTransferStarted = true;
+
+    for (size_t byteIndex = 0U; byteIndex < length; byteIndex++)
+    {
+        uint8_t sentData = SIM_SPI_IDLE_VALUE;
+
+        // Find the channels serving the SERCOM again, a new descriptor can change them
+        sendChannel = NULL;
+        receiveChannel = NULL;
+        for (uint8_t channelIndex = 0U; channelIndex < SIM_DMAC_CHANNEL_COUNT; channelIndex++)
+        {
+            sim_dmac_channel_t * channel = &dmacChannels[channelIndex];
+
+            if (channel->isEnabled && (channel->writeBack.DMAC_SRCADDR == PointerToAddress(&spiDataRegister)))
+            {
+                receiveChannel = channel;
+            }
+            else if (channel->isEnabled && (channel->writeBack.DMAC_DSTADDR == PointerToAddress(&spiDataRegister)))
+            {
+                sendChannel = channel;
+            }
+            else
+            {
+                // Channel not used by the SERCOM
+            }
+        }
+
+        if (sendChannel != NULL)
+        {
+            sentData = ChannelBeat(sendChannel, 0U);
+        }
+
+        if (receiveChannel != NULL)
+        {
+            (void) ChannelBeat(receiveChannel, hostData[byteIndex]);
+        }
+        else if (rxCount < SIM_SPI_RX_BUFFER_SIZE)
+        {
+            rxBuffer[rxCount] = hostData[byteIndex];
+            rxCount++;
+        }
+        else
+        {
+            // Buffer overflow, the byte is lost
+        }
+
+        if (clientData != NULL)
+        {
+            clientData[byteIndex] = sentData;
+        }
+    }
+
+    SIM_PortInputSet((uint32_t)1U << (uint32_t) CHIP_SELECT_PIN, true);
+}
+
+bool SERCOM3_Open(void)
+{
+    return true;
+}
+
+uint8_t SERCOM3_IsRxReady(void)
+{
+    return (rxCount > 0U) ? 1U : 0U;
+}
+
+uint8_t SERCOM3_IsTransferStarted(void)
+{
+    return isTransferStarted ? 1U : 0U;
+}
+
+void SERCOM3_TransferStartClear(void)
+{
+    isTransferStarted = false;
+}
+
+void * SERCOM3_DataAddressGet(void)
+{
+    /* cppcheck-suppress misra-c2012-11.8 */
+    return (void *) &spiDataRegister;
+}
+
+void SERCOM3_BufferFlush(void)
+{
+    rxCount = 0U;
+}
+
+bool DMAC_ChannelTransfer(DMAC_CHANNEL channel, const void *srcAddr, const void *destAddr, size_t blockSize)
+{
+    bool returnStatus = false;
+
+    if ((false == DMAC_ChannelIsBusy(channel)) && (blockSize != 0U) && (blockSize <= 0xFFFFU))
+    {
+        dmac_descriptor_registers_t * active = &dmacChannels[channel].writeBack;
+
+        active->DMAC_BTCTRL = channelBlockControl[channel];
+        active->DMAC_BTCNT = (uint16_t) blockSize;
+        active->DMAC_SRCADDR = PointerToAddress(srcAddr);
+        active->DMAC_DSTADDR = PointerToAddress(destAddr);
+        active->DMAC_DESCADDR = 0U;
+        if ((active->DMAC_BTCTRL & DMAC_BTCTRL_SRCINC_Msk) != 0U)
+        {
+            active->DMAC_SRCADDR += (uint32_t) blockSize;
+        }
+        if ((active->DMAC_BTCTRL & DMAC_BTCTRL_DSTINC_Msk) != 0U)
+        {
+            active->DMAC_DSTADDR += (uint32_t) blockSize;
+        }
+        dmacChannels[channel].isEnabled = true;
+        returnStatus = true;
+    }
+
+    return returnStatus;
+}
+
+bool DMAC_ChannelLinkedListTransfer(DMAC_CHANNEL channel, const dmac_descriptor_registers_t *channelDesc)
+{
+    bool returnStatus = false;
+
+    if ((channelDesc != NULL) && (false == DMAC_ChannelIsBusy(channel)))
+    {
+        (void) PointerToAddress(channelDesc);
+        (void) memcpy(&dmacChannels[channel].writeBack, channelDesc, sizeof(dmac_descriptor_registers_t));
+        dmacChannels[channel].isEnabled = true;
+        returnStatus = true;
+    }
+
+    return returnStatus;
+}
+
+bool DMAC_ChannelIsBusy(DMAC_CHANNEL channel)
+{
+    return dmacChannels[channel].isEnabled;
+}
+
+void DMAC_ChannelDisable(DMAC_CHANNEL channel)
+{
+    dmacChannels[channel].isEnabled = false;
+}
+
+uint16_t DMAC_ChannelLinkedListTransferredCountGet(DMAC_CHANNEL channel, const dmac_descriptor_registers_t *channelDesc)
+{
+    uint16_t transferredCount = 0U;
+    uint16_t completedCount = 0U;
+    const dmac_descriptor_registers_t * workDesc = channelDesc;
+    const dmac_descriptor_registers_t * const writeBackDesc = &dmacChannels[channel].writeBack;
+
+    // The write-back copy holds the descriptor that was active when the channel stopped
+    while (workDesc != NULL)
+    {
+        if ((writeBackDesc->DMAC_SRCADDR == workDesc->DMAC_SRCADDR) && (writeBackDesc->DMAC_DSTADDR == workDesc->DMAC_DSTADDR))
+        {
+            transferredCount = completedCount + (workDesc->DMAC_BTCNT - writeBackDesc->DMAC_BTCNT);
+            workDesc = NULL;
+        }
+        else
+        {
+            completedCount += workDesc->DMAC_BTCNT;
+            /* cppcheck-suppress misra-c2012-11.4 */
+            workDesc = (const dmac_descriptor_registers_t *) AddressToPointer(workDesc->DMAC_DESCADDR);
+        }
+    }
+
+    return transferredCount;
+}
@@ -0,0 +1,174 @@
+/**
+ * @file    sim_system.c
+ * @ingroup mdfu_host_sim
+ * @brief   Stand-ins for the core registers and for the PORT, PAC and SYSTICK PLIBs.
+ *
+ * The virtual clock of the simulated device lives here. The SysTick counts down from it at
+ * SYSTICK_FREQ and a SysTick delay moves it forward by the requested time.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "peripheral/pac/plib_pac.h"
+#include "peripheral/port/plib_port.h"
+#include "peripheral/systick/plib_systick.h"
+#include "sim_hal.h"
+#include "sim_internal.h"
+
+SysTick_Type simSysTick;
+SCB_Type simScb;
+sim_port_t simPort;
+
+static bool isResetRequested = false;
+static uint64_t currentTime = 0U;
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_NANOSECONDS_PER_SECOND
+ * @brief Resolution of the virtual clock.
+ */
+#define SIM_NANOSECONDS_PER_SECOND  (1000000000U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Returns the number of SysTick clock cycles from the reset up to the given time.
+ *
+ * @param[in] time - Virtual time in nanoseconds
+ * @return SysTick clock cycles
+ */
+static uint64_t SysTickCyclesGet(uint64_t time);
+
+static uint64_t SysTickCyclesGet(uint64_t time)
+{
+    // Split the product so it cannot overflow within the range of the clock
+    return ((time / SIM_NANOSECONDS_PER_SECOND) * SYSTICK_FREQ)
+            + (((time % SIM_NANOSECONDS_PER_SECOND) * SYSTICK_FREQ) / SIM_NANOSECONDS_PER_SECOND);
+}
+
+void SIM_Reset(void)
+{
+    SIM_NvmctrlReset();
+    SIM_SerialReset();
+    (void) memset(&simSysTick, 0, sizeof(simSysTick));
+    (void) memset(&simScb, 0, sizeof(simScb));
+    (void) memset(&simPort, 0, sizeof(simPort));
+    currentTime = 0U;
+
+    // Every input pin reads high, so an SPI chip select is released
+    SIM_PortInputSet(0xFFFFFFFFU, true);
+    isResetRequested = false;
+}
+
+uint64_t SIM_TimeGet(void)
+{
+    return currentTime;
+}
+
+void SIM_TimeAdvance(uint64_t duration)
+{
+    uint64_t cycleCount = SysTickCyclesGet(currentTime + duration) - SysTickCyclesGet(currentTime);
+
+    currentTime += duration;
+
+    if (((SysTick->CTRL & SysTick_CTRL_ENABLE_Msk) != 0U) && (cycleCount > 0U))
+    {
+        uint64_t period = (uint64_t) SysTick->LOAD + 1U;
+        uint64_t counterValue = SysTick->VAL;
+
+        // A cleared counter is reloaded on the next cycle without flagging the period
+        if (counterValue == 0U)
+        {
+            counterValue = SysTick->LOAD;
+            cycleCount--;
+        }
+
+        if (cycleCount < counterValue)
+        {
+            counterValue -= cycleCount;
+        }
+        else
+        {
+            uint64_t remainder = (cycleCount - counterValue) % period;
+
+            counterValue = (remainder == 0U) ? 0U : (period - remainder);
+            SysTick->CTRL |= SysTick_CTRL_COUNTFLAG_Msk;
+        }
+
+        SysTick->VAL = (uint32_t) counterValue;
+    }
+}
+
+bool SIM_ResetRequested(void)
+{
+    return isResetRequested;
+}
+
+void SIM_PortInputSet(uint32_t pinMask, bool isHigh)
+{
+    size_t inputOffset = offsetof(port_registers_t, GROUP) + offsetof(port_group_registers_t, PORT_IN);
+    uint32_t inputValue = simPort.registers.GROUP[0].PORT_IN;
+
+    inputValue = isHigh ? (inputValue | pinMask) : (inputValue & ~pinMask);
+    (void) memcpy(&simPort.raw[inputOffset], &inputValue, sizeof(inputValue));
+}
+
+void NVIC_SystemReset(void)
+{
+    isResetRequested = true;
+}
+
+void PAC_PeripheralProtectSetup(PAC_PERIPHERAL peripheral, PAC_PROTECTION operation)
+{
+    (void) peripheral;
+    (void) operation;
+}
+
+void SYSTICK_TimerInitialize(void)
+{
+    SysTick->CTRL = 0U;
+    SysTick->VAL = 0U;
+    SysTick->LOAD = (SYSTICK_FREQ / 1000U) - 1U;
+    SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk;
+}
+
+void SYSTICK_TimerStart(void)
+{
+    SysTick->VAL = 0U;
+    SysTick->CTRL &= ~(SysTick_CTRL_COUNTFLAG_Msk);
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+}
+
+void SYSTICK_TimerStop(void)
+{
+    SysTick->CTRL &= ~(SysTick_CTRL_ENABLE_Msk);
+}
+
+void SYSTICK_TimerPeriodSet(uint32_t period)
+{
+    SysTick->LOAD = period - 1U;
+}
+
+uint32_t SYSTICK_TimerCounterGet(void)
+{
+    return SysTick->VAL;
+}
+
+uint32_t SYSTICK_TimerFrequencyGet(void)
+{
+    return SYSTICK_FREQ;
+}
+
+void SYSTICK_DelayMs(uint32_t delay_ms)
+{
+    SIM_TimeAdvance((uint64_t) delay_ms * 1000000U);
+}
+
+bool SYSTICK_TimerPeriodHasExpired(void)
+{
+    bool periodHasExpired = ((SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk) > 0U);
+
+    // Reading the control register clears the flag, as on the device
+    SysTick->CTRL &= ~(SysTick_CTRL_COUNTFLAG_Msk);
+
+    return periodHasExpired;
+}
@@ -0,0 +1,409 @@
+/**
+ * @file    sim_usart.c
+ * @ingroup mdfu_host_sim
+ * @brief   Stand-in for the SERCOM1 USART PLIB built on two byte queues.
+ *
+ * The receive queue has the size of the ring buffer of the PLIB, bytes sent by the host while
+ * it is full are lost as on the device. The transmit queue holds what the device has sent until
+ * the host reads it. With a baud rate set, each byte is stamped with the time its stop bit ends,
+ * one byte time after the previous one, and the host only reads it from then on. The device
+ * queues its bytes like the interrupt driven ring buffer of the PLIB and only waits while that
+ * ring buffer is full. The device can switch its end of the line to another baud rate, bytes between
+ * ends that run at different baud rates are read as framing errors. Framing errors and bytes lost
+ * on a full ring buffer are reported by SERCOM1_USART_ErrorGet, as the receive interrupt keeps them. With flow control turned
+ * on, RTS follows the fill level of the receive queue as the PLIB drives it.
+ */
+
+#include <string.h>
+#include "peripheral/sercom/usart/plib_sercom1_usart.h"
+#include "sim_hal.h"
+#include "sim_internal.h"
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_USART_READ_BUFFER_SIZE
+ * @brief Size of the receive ring buffer of the SERCOM1 USART PLIB, one slot is always left free.
+ */
+#define SIM_USART_READ_BUFFER_SIZE  (512U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_USART_WRITE_BUFFER_SIZE
+ * @brief Number of bytes sent by the device that are kept for the host.
+ */
+#define SIM_USART_WRITE_BUFFER_SIZE (4096U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_USART_FRAME_BITS
+ * @brief Bits on the line for one byte: start bit, eight data bits and stop bit.
+ */
+#define SIM_USART_FRAME_BITS        (10U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_USART_TX_RING_SIZE
+ * @brief Bytes the device can queue before they are sent: the transmit ring buffer of the PLIB,
+ * the data register and the shift register.
+ */
+#define SIM_USART_TX_RING_SIZE      (128U + 2U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_USART_POLL_TIME
+ * @brief Time in nanoseconds of one poll of the transmit state, so a waiting loop moves the clock.
+ */
+#define SIM_USART_POLL_TIME         (100U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_USART_RTS_STOP_LEVEL
+ * @brief Free bytes left in the receive ring buffer when RTS holds off the host, as in the PLIB.
+ */
+#define SIM_USART_RTS_STOP_LEVEL    (64U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_USART_RTS_RESUME_LEVEL
+ * @brief Free bytes in the receive ring buffer before RTS lets the host send again, as in the PLIB.
+ */
+#define SIM_USART_RTS_RESUME_LEVEL  (128U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @struct sim_byte_queue_t
+ * @brief First in, first out queue of bytes.
+ */
+typedef struct
+{
+    uint8_t * data;
+    size_t bufferSize;
+    size_t capacity;
+    size_t readIndex;
+    size_t count;
+} sim_byte_queue_t;
+
+static uint8_t readBuffer[SIM_USART_READ_BUFFER_SIZE];
+static uint8_t writeBuffer[SIM_USART_WRITE_BUFFER_SIZE];
+static sim_byte_queue_t readQueue = {&readBuffer[0], SIM_USART_READ_BUFFER_SIZE, SIM_USART_READ_BUFFER_SIZE - 1U, 0U, 0U};
+static uint64_t writeEndTimes[SIM_USART_WRITE_BUFFER_SIZE];
+static sim_byte_queue_t writeQueue = {&writeBuffer[0], SIM_USART_WRITE_BUFFER_SIZE, SIM_USART_WRITE_BUFFER_SIZE, 0U, 0U};
+static uint64_t lineEndTime = 0U;
+static USART_ERROR usartError = USART_ERROR_NONE;
+static uint32_t lineBaudRate = 0U;
+static uint32_t hostBaudRate = 0U;
+static uint32_t deviceBaudRate = 0U;
+static bool isFlowControlEnabled = false;
+static bool isHostHeldOff = false;
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Gives the byte read at the other end of the line.
+ *
+ * @param[in] data - Byte sent
+ * @return The byte, or 0x00 when the two ends run at different baud rates
+ */
+static uint8_t LineByteGet(uint8_t data);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Adds a byte to the end of the queue.
+ *
+ * @param[in] queue - Queue to add to
+ * @param[in] data - Byte to add
+ * @return True - The byte has been added
+ * @return False - The queue is full
+ */
+static bool QueuePut(sim_byte_queue_t * queue, uint8_t data);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Takes the byte at the head of the queue.
+ *
+ * @param[in] queue - Queue to take from
+ * @param[out] data - Byte taken
+ * @return True - A byte has been taken
+ * @return False - The queue is empty
+ */
+static bool QueueGet(sim_byte_queue_t * queue, uint8_t * data);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Puts a byte of the device on the line after the bytes already queued.
+ *
+ * @param[in] data - Byte sent
+ * @return True - The byte has been queued
+ * @return False - The transmit ring buffer of the device is full
+ */
+static bool LineBytePut(uint8_t data);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Counts the bytes of the device whose stop bit has not ended yet.
+ *
+ * @param None
+ * @return Number of bytes still queued or on the line
+ */
+static size_t LineBusyCountGet(void);
+
+static bool QueuePut(sim_byte_queue_t * queue, uint8_t data)
+{
+    bool isAdded = false;
+
+    if (queue->count < queue->capacity)
+    {
+        queue->data[(queue->readIndex + queue->count) % queue->bufferSize] = data;
+        queue->count++;
+        isAdded = true;
+    }
+
+    return isAdded;
+}
+
+static bool QueueGet(sim_byte_queue_t * queue, uint8_t * data)
+{
+    bool isTaken = false;
+
+    if (queue->count > 0U)
+    {
+        *data = queue->data[queue->readIndex];
+        queue->readIndex = (queue->readIndex + 1U) % queue->bufferSize;
+        queue->count--;
+        isTaken = true;
+    }
+
+    return isTaken;
+}
+
+static uint8_t LineByteGet(uint8_t data)
+{
+    return (hostBaudRate == deviceBaudRate) ? data : 0x00U;
+}
+
+static size_t LineBusyCountGet(void)
+{
+    uint64_t currentTime = SIM_TimeGet();
+    size_t busyCount = 0U;
+
+    // The bytes end in order, count back from the newest one
+    while ((busyCount < writeQueue.count)
+            && (writeEndTimes[(writeQueue.readIndex + writeQueue.count - 1U - busyCount) % writeQueue.bufferSize] > currentTime))
+    {
+        busyCount++;
+    }
+
+    return busyCount;
+}
+
+static bool LineBytePut(uint8_t data)
+{
+    bool isQueued = false;
+    size_t slot = (writeQueue.readIndex + writeQueue.count) % writeQueue.bufferSize;
+
+    // A byte that the host does not read in time is lost on the line
+    if ((LineBusyCountGet() < SIM_USART_TX_RING_SIZE) && QueuePut(&writeQueue, LineByteGet(data)))
+    {
+        uint64_t currentTime = SIM_TimeGet();
+        uint64_t byteTime = (deviceBaudRate > 0U) ? (((uint64_t) SIM_USART_FRAME_BITS * 1000000000U) / deviceBaudRate) : 0U;
+
+        lineEndTime = ((lineEndTime > currentTime) ? lineEndTime : currentTime) + byteTime;
+        writeEndTimes[slot] = lineEndTime;
+        isQueued = true;
+    }
+
+    return isQueued;
+}
+
+void SIM_SerialReset(void)
+{
+    readQueue.readIndex = 0U;
+    readQueue.count = 0U;
+    writeQueue.readIndex = 0U;
+    writeQueue.count = 0U;
+    lineEndTime = 0U;
+    usartError = USART_ERROR_NONE;
+    deviceBaudRate = lineBaudRate;
+    isFlowControlEnabled = false;
+    isHostHeldOff = false;
+}
+
+void SIM_UsartBaudSet(uint32_t baudRate)
+{
+    lineBaudRate = baudRate;
+    hostBaudRate = baudRate;
+    deviceBaudRate = baudRate;
+}
+
+void SIM_UsartHostBaudSet(uint32_t baudRate)
+{
+    hostBaudRate = baudRate;
+}
+
+size_t SIM_UsartHostWrite(const uint8_t * data, size_t length)
+{
+    size_t queuedCount = 0U;
+
+    while ((queuedCount < length) && QueuePut(&readQueue, LineByteGet(data[queuedCount])))
+    {
+        // The receive interrupt keeps the error of the byte until SERCOM1_USART_ErrorGet reads it
+        if (hostBaudRate != deviceBaudRate)
+        {
+            usartError |= USART_ERROR_FRAMING;
+        }
+        queuedCount++;
+    }
+
+    if (queuedCount < length)
+    {
+        // The PLIB flags a byte that did not fit into its ring buffer as an overrun
+        usartError |= USART_ERROR_OVERRUN;
+    }
+
+    if (isFlowControlEnabled && ((readQueue.capacity - readQueue.count) <= SIM_USART_RTS_STOP_LEVEL))
+    {
+        isHostHeldOff = true;
+    }
+
+    return queuedCount;
+}
+
+bool SIM_UsartHostClearToSend(void)
+{
+    return (isHostHeldOff == false);
+}
+
+size_t SIM_UsartHostRead(uint8_t * data, size_t size)
+{
+    size_t readCount = 0U;
+
+    // Only the bytes whose stop bit has ended have reached the host
+    while ((readCount < size) && (writeQueue.count > 0U) && (writeEndTimes[writeQueue.readIndex] <= SIM_TimeGet())
+            && QueueGet(&writeQueue, &data[readCount]))
+    {
+        readCount++;
+    }
+
+    return readCount;
+}
+
+void SERCOM1_USART_Initialize(void)
+{
+    SIM_SerialReset();
+}
+
+size_t SERCOM1_USART_Read(uint8_t * pRdBuffer, const size_t size)
+{
+    size_t readCount = 0U;
+
+    while ((readCount < size) && QueueGet(&readQueue, &pRdBuffer[readCount]))
+    {
+        readCount++;
+    }
+
+    if (isHostHeldOff && ((readQueue.capacity - readQueue.count) >= SIM_USART_RTS_RESUME_LEVEL))
+    {
+        isHostHeldOff = false;
+    }
+
+    return readCount;
+}
+
+size_t SERCOM1_USART_Write(uint8_t * pWrBuffer, const size_t size)
+{
+    size_t writeCount = 0U;
+
+    while ((writeCount < size) && LineBytePut(pWrBuffer[writeCount]))
+    {
+        writeCount++;
+    }
+
+    // The caller polls again while the ring buffer is full
+    if (writeCount < size)
+    {
+        SIM_TimeAdvance(SIM_USART_POLL_TIME);
+    }
+
+    return writeCount;
+}
+
+size_t SERCOM1_USART_WriteCountGet(void)
+{
+    size_t busyCount = LineBusyCountGet();
+
+    // The last two bytes are in the data and shift registers, no longer in the ring buffer
+    size_t writeCount = (busyCount > 2U) ? (busyCount - 2U) : 0U;
+
+    if (writeCount > 0U)
+    {
+        SIM_TimeAdvance(SIM_USART_POLL_TIME);
+    }
+
+    return writeCount;
+}
+
+size_t SERCOM1_USART_WriteFreeBufferCountGet(void)
+{
+    return (SIM_USART_TX_RING_SIZE - 2U) - SERCOM1_USART_WriteCountGet();
+}
+
+size_t SERCOM1_USART_WriteBufferSizeGet(void)
+{
+    return SIM_USART_TX_RING_SIZE - 2U;
+}
+
+bool SERCOM1_USART_TransmitterIsReady(void)
+{
+    return (LineBusyCountGet() < 2U);
+}
+
+bool SERCOM1_USART_TransmitComplete(void)
+{
+    bool isComplete = (LineBusyCountGet() == 0U);
+
+    if (isComplete == false)
+    {
+        SIM_TimeAdvance(SIM_USART_POLL_TIME);
+    }
+
+    return isComplete;
+}
+
+void SERCOM1_USART_WriteByte(int data)
+{
+    (void) LineBytePut((uint8_t) data);
+}
+
+bool SERCOM1_USART_SerialSetup(USART_SERIAL_SETUP * serialSetup, uint32_t clkFrequency)
+{
+    bool setupStatus = false;
+    uint32_t clockFrequency = (clkFrequency == 0U) ? SERCOM1_USART_FrequencyGet() : clkFrequency;
+
+    // The PLIB takes baud rates down to 3 samples per bit
+    if ((serialSetup != NULL) && (serialSetup->baudRate > 0U) && (clockFrequency >= (3U * serialSetup->baudRate)))
+    {
+        deviceBaudRate = serialSetup->baudRate;
+        setupStatus = true;
+    }
+
+    return setupStatus;
+}
+
+void SERCOM1_USART_FlowControlEnable(void)
+{
+    isFlowControlEnabled = true;
+    isHostHeldOff = false;
+}
+
+uint32_t SERCOM1_USART_FrequencyGet(void)
+{
+    return 48000000UL;
+}
+
+USART_ERROR SERCOM1_USART_ErrorGet(void)
+{
+    USART_ERROR error = usartError;
+
+    usartError = USART_ERROR_NONE;
+
+    return error;
+}
@@ -0,0 +1,35 @@
+/**
+ * @file    cmsis_compiler.h
+ * @ingroup mdfu_host_sim
+ * @brief   Host stand-in for the CMSIS compiler abstraction, for GCC and Clang.
+ */
+#ifndef CMSIS_COMPILER_H
+#define CMSIS_COMPILER_H
+
+#ifndef __STATIC_INLINE
+#define __STATIC_INLINE     static inline
+#endif
+#ifndef __STATIC_FORCEINLINE
+#define __STATIC_FORCEINLINE    __attribute__((always_inline)) static inline
+#endif
+#ifndef __NO_RETURN
+#define __NO_RETURN         __attribute__((__noreturn__))
+#endif
+#ifndef __ALIGNED
+#define __ALIGNED(x)        __attribute__((aligned(x)))
+#endif
+#ifndef __PACKED
+#define __PACKED            __attribute__((packed))
+#endif
+#ifndef __WEAK
+#define __WEAK              __attribute__((weak))
+#endif
+
+#define __NOP()             do { } while (0)
+#define __DSB()             __sync_synchronize()
+#define __DMB()             __sync_synchronize()
+#define __ISB()             __sync_synchronize()
+#define __disable_irq()     do { } while (0)
+#define __enable_irq()      do { } while (0)
+
+#endif // CMSIS_COMPILER_H
@@ -0,0 +1,91 @@
+/**
+ * @file    core_cm0plus.h
+ * @ingroup mdfu_host_sim
+ * @brief   Host stand-in for the CMSIS Cortex-M0+ core header.
+ *
+ * Only the parts used by the bootloader library and its PLIB headers are provided. The core
+ * registers are plain objects owned by the simulated HAL instead of memory mapped registers.
+ */
+#ifndef CORE_CM0PLUS_H
+#define CORE_CM0PLUS_H
+
+#include <stdint.h>
+#include "cmsis_compiler.h"
+
+#define __I     volatile const
+#define __O     volatile
+#define __IO    volatile
+#define __IM    volatile const
+#define __OM    volatile
+#define __IOM   volatile
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief SysTick registers, see the ARMv6-M architecture reference.
+ */
+typedef struct
+{
+    __IOM uint32_t CTRL;
+    __IOM uint32_t LOAD;
+    __IOM uint32_t VAL;
+    __IM uint32_t CALIB;
+} SysTick_Type;
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Subset of the System Control Block registers.
+ */
+typedef struct
+{
+    __IM uint32_t CPUID;
+    __IOM uint32_t ICSR;
+    __IOM uint32_t VTOR;
+    __IOM uint32_t AIRCR;
+} SCB_Type;
+
+#define SysTick_CTRL_COUNTFLAG_Pos  16U
+#define SysTick_CTRL_COUNTFLAG_Msk  (1UL << SysTick_CTRL_COUNTFLAG_Pos)
+#define SysTick_CTRL_CLKSOURCE_Pos  2U
+#define SysTick_CTRL_CLKSOURCE_Msk  (1UL << SysTick_CTRL_CLKSOURCE_Pos)
+#define SysTick_CTRL_TICKINT_Pos    1U
+#define SysTick_CTRL_TICKINT_Msk    (1UL << SysTick_CTRL_TICKINT_Pos)
+#define SysTick_CTRL_ENABLE_Pos     0U
+#define SysTick_CTRL_ENABLE_Msk     (1UL)
+#define SysTick_LOAD_RELOAD_Msk     (0xFFFFFFUL)
+#define SysTick_VAL_CURRENT_Msk     (0xFFFFFFUL)
+
+extern SysTick_Type simSysTick;
+extern SCB_Type simScb;
+
+#define SysTick (&simSysTick)
+#define SCB     (&simScb)
+
+void NVIC_SystemReset(void);
+
+__STATIC_INLINE void NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+    (void) IRQn;
+}
+
+__STATIC_INLINE void NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+    (void) IRQn;
+}
+
+__STATIC_INLINE void NVIC_ClearPendingIRQ(IRQn_Type IRQn)
+{
+    (void) IRQn;
+}
+
+__STATIC_INLINE void NVIC_SetPriority(IRQn_Type IRQn, uint32_t priority)
+{
+    (void) IRQn;
+    (void) priority;
+}
+
+__STATIC_INLINE void __set_MSP(uint32_t topOfMainStack)
+{
+    (void) topOfMainStack;
+}
+
+#endif // CORE_CM0PLUS_H
@@ -0,0 +1,36 @@
+/**
+ * @file    device.h
+ * @ingroup mdfu_host_sim
+ * @brief   Host stand-in for the device header of the bootloader projects.
+ *
+ * Pulls in the device pack header as the MPLAB projects do, then points the registers that the
+ * PLIB headers access through macros (the PORT pins) to objects of the simulated HAL.
+ */
+#ifndef DEVICE_H
+#define DEVICE_H
+
+#ifndef DONT_USE_PREDEFINED_CORE_HANDLERS
+#define DONT_USE_PREDEFINED_CORE_HANDLERS
+#endif
+#ifndef DONT_USE_PREDEFINED_PERIPHERALS_HANDLERS
+#define DONT_USE_PREDEFINED_PERIPHERALS_HANDLERS
+#endif
+#include "pic32cm1216mc00032.h"
+#include "toolchain_specifics.h"
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief PORT registers of the simulated device, the raw view lets the HAL drive the input pins.
+ */
+typedef union
+{
+    port_registers_t registers;
+    uint8_t raw[sizeof(port_registers_t)];
+} sim_port_t;
+
+extern sim_port_t simPort;
+
+#undef PORT_REGS
+#define PORT_REGS (&simPort.registers)
+
+#endif // DEVICE_H
@@ -0,0 +1,320 @@
+/**
+ * @file    sim_hal.h
+ * @ingroup mdfu_host_sim
+ * @brief   Host side API of the simulated HAL used to run the bootloader library on a workstation.
+ *
+ * The stand-in PLIBs keep the state of the device: the main and data Flash, the device ID and
+ * one serial port. The functions below let a host program act as the other end of that port and
+ * look at the Flash content, while the bootloader library calls the PLIB APIs as on the device.
+ */
+#ifndef SIM_HAL_H
+#define SIM_HAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_FLASH_ERASED_VALUE
+ * @brief Value of an erased Flash byte.
+ */
+#define SIM_FLASH_ERASED_VALUE (0xFFU)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_FLASH_ENDURANCE
+ * @brief Minimum number of erase cycles of a main Flash row given by the datasheet.
+ */
+#define SIM_FLASH_ENDURANCE (25000U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_DATAFLASH_ENDURANCE
+ * @brief Minimum number of erase cycles of a data Flash row given by the datasheet.
+ */
+#define SIM_DATAFLASH_ENDURANCE (100000U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @struct sim_flash_timing_t
+ * @brief Durations charged by the simulated device, all in nanoseconds.
+ * @var sim_flash_timing_t:: pageWriteTime
+ * Member 'pageWriteTime' contains the time the NVMCTRL is busy after a page write command
+ * @var sim_flash_timing_t:: rowEraseTime
+ * Member 'rowEraseTime' contains the time the NVMCTRL is busy after a row erase command
+ * @var sim_flash_timing_t:: regionLockTime
+ * Member 'regionLockTime' contains the time the NVMCTRL is busy after a region lock or unlock command
+ * @var sim_flash_timing_t:: busyPollTime
+ * Member 'busyPollTime' contains the CPU time of one NVMCTRL_IsBusy call
+ * @var sim_flash_timing_t:: crcWordTime
+ * Member 'crcWordTime' contains the time the DSU needs for one word of a CRC
+ */
+typedef struct
+{
+    uint32_t pageWriteTime;
+    uint32_t rowEraseTime;
+    uint32_t regionLockTime;
+    uint32_t busyPollTime;
+    uint32_t crcWordTime;
+} sim_flash_timing_t;
+
+/**
+ * @ingroup mdfu_host_sim
+ * @struct sim_flash_statistics_t
+ * @brief Flash commands executed since the last @ref SIM_Reset.
+ * @var sim_flash_statistics_t:: pageWrites
+ * Member 'pageWrites' contains the number of page writes of the main and the data Flash
+ * @var sim_flash_statistics_t:: pageRewrites
+ * Member 'pageRewrites' contains the number of page writes to a page that was not erased since its last write
+ * @var sim_flash_statistics_t:: rowErases
+ * Member 'rowErases' contains the number of row erases of the main and the data Flash
+ * @var sim_flash_statistics_t:: regionLocks
+ * Member 'regionLocks' contains the number of region lock and unlock commands
+ * @var sim_flash_statistics_t:: busyTime
+ * Member 'busyTime' contains the time in nanoseconds the NVMCTRL has been busy
+ * @var sim_flash_statistics_t:: maxRowErases
+ * Member 'maxRowErases' contains the highest number of erases of a single main Flash row
+ * @var sim_flash_statistics_t:: maxDataRowErases
+ * Member 'maxDataRowErases' contains the highest number of erases of a single data Flash row
+ * @var sim_flash_statistics_t:: erasedRows
+ * Member 'erasedRows' contains the number of main and data Flash rows erased at least once
+ */
+typedef struct
+{
+    uint32_t pageWrites;
+    uint32_t pageRewrites;
+    uint32_t rowErases;
+    uint32_t regionLocks;
+    uint64_t busyTime;
+    uint32_t maxRowErases;
+    uint32_t maxDataRowErases;
+    uint32_t erasedRows;
+} sim_flash_statistics_t;
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Puts the simulated device back into its power-on state.
+ *
+ * The main and data Flash are erased, all lock regions are unlocked, the erase counters and the
+ * virtual clock restart from zero, the SysTick is stopped, the serial port is emptied and the
+ * reset request is cleared.
+ *
+ * @param None
+ * @return None
+ */
+void SIM_Reset(void);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Returns a pointer to the simulated memory that holds the given address range.
+ *
+ * @param[in] address - Device address of the first byte
+ * @param[in] length - Length of the range in bytes
+ * @return Pointer to the first byte, NULL if the range is not fully inside the main or the data Flash
+ */
+uint8_t * SIM_MemoryGet(uint32_t address, uint32_t length);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Writes the content of the main and the data Flash into a file.
+ *
+ * @param[in] path - Path of the file, an existing file is replaced
+ * @return True - The whole Flash has been written
+ * @return False - The file cannot be written
+ */
+bool SIM_FlashSave(const char * path);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Replaces the content of the main and the data Flash with a file written by @ref SIM_FlashSave.
+ *
+ * The lock regions, the erase counters and the virtual clock are kept, so a device powered up
+ * with this Flash is a @ref SIM_Reset followed by this call.
+ *
+ * @param[in] path - Path of the file
+ * @return True - The whole Flash has been read
+ * @return False - The file cannot be read or is too short
+ */
+bool SIM_FlashLoad(const char * path);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Sets the value read from the DSU device identification register.
+ *
+ * @param[in] deviceId - Value of the DID register, the default is the ID of the PIC32CM1216MC00032
+ * @return None
+ */
+void SIM_DeviceIdSet(uint32_t deviceId);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Checks if the library has requested a device reset since the last @ref SIM_Reset.
+ *
+ * @param None
+ * @return True - NVIC_SystemReset has been called
+ * @return False - No reset has been requested
+ */
+bool SIM_ResetRequested(void);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Returns the time of the virtual clock of the simulated device.
+ *
+ * The clock only moves when the device waits: while it polls the NVMCTRL, reads Flash that is
+ * being programmed, runs a DSU CRC or a SysTick delay, or when the host calls @ref SIM_TimeAdvance.
+ *
+ * @param None
+ * @return Nanoseconds since the last @ref SIM_Reset
+ */
+uint64_t SIM_TimeGet(void);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Moves the virtual clock forward, the SysTick counts down by the same time.
+ *
+ * @param[in] duration - Time in nanoseconds
+ * @return None
+ */
+void SIM_TimeAdvance(uint64_t duration);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Replaces the durations charged by the simulated device.
+ *
+ * The defaults are the maximum page write and row erase times of the datasheet, so a predicted
+ * update time is an upper bound for the Flash part. The timing is kept by @ref SIM_Reset.
+ *
+ * @param[in] timing - New durations
+ * @return None
+ */
+void SIM_FlashTimingSet(const sim_flash_timing_t * timing);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Returns the durations charged by the simulated device.
+ *
+ * @param None
+ * @return Pointer to the current durations
+ */
+const sim_flash_timing_t * SIM_FlashTimingGet(void);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Returns the statistics of the Flash commands executed since the last @ref SIM_Reset.
+ *
+ * @param[out] statistics - Filled with the counts and the busy time
+ * @return None
+ */
+void SIM_FlashStatisticsGet(sim_flash_statistics_t * statistics);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Returns how often the row that holds the given address has been erased.
+ *
+ * @param[in] address - Main or data Flash address
+ * @return Number of erases since the last @ref SIM_Reset, 0 for an address outside of the Flash
+ */
+uint32_t SIM_FlashRowEraseCountGet(uint32_t address);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Sends bytes from the host to the SERCOM1 USART of the device.
+ *
+ * The bytes are queued in the receive ring buffer of the USART PLIB. Bytes that do not fit
+ * into the ring buffer are dropped and reported as an overrun by SERCOM1_USART_ErrorGet, as on the device.
+ *
+ * @param[in] data - Bytes sent by the host
+ * @param[in] length - Number of bytes
+ * @return Number of bytes that have been queued
+ */
+size_t SIM_UsartHostWrite(const uint8_t * data, size_t length);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Sets the baud rate of the SERCOM1 USART line.
+ *
+ * Every byte sent by the device then takes the time of one start bit, eight data bits and one
+ * stop bit on the line, after the bytes sent before it. The device does not wait for them, the
+ * host reads each byte once its stop bit has ended. The default of 0 sends the bytes without any delay. The baud rate is kept by @ref SIM_Reset.
+ *
+ * Both ends of the line run at this baud rate, and it is the one SERCOM1_USART_Initialize
+ * configures, like the MCC setting of the device.
+ *
+ * @param[in] baudRate - Baud rate in bits per second, 0 for no delay
+ * @return None
+ */
+void SIM_UsartBaudSet(uint32_t baudRate);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Sets the baud rate of the host end of the SERCOM1 USART line.
+ *
+ * While the host and the device run at different baud rates, every byte arrives as a byte
+ * with a framing error, which is read as 0x00.
+ *
+ * @param[in] baudRate - Baud rate in bits per second
+ * @return None
+ */
+void SIM_UsartHostBaudSet(uint32_t baudRate);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Reads the RTS line of the SERCOM1 USART, the CTS input of the host.
+ *
+ * Once the device has turned on flow control with SERCOM1_USART_FlowControlEnable, RTS holds
+ * off the host while the receive ring buffer is nearly full, with the levels of the PLIB.
+ *
+ * @param None
+ * @return True - The host may send
+ * @return False - The device holds off the host
+ */
+bool SIM_UsartHostClearToSend(void);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Reads the bytes sent by the SERCOM1 USART of the device.
+ *
+ * @param[out] data - Buffer for the bytes
+ * @param[in] size - Size of the buffer
+ * @return Number of bytes copied into the buffer
+ */
+size_t SIM_UsartHostRead(uint8_t * data, size_t size);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Runs one SPI transaction of the host against the SERCOM3 SPI client of the device.
+ *
+ * The chip select is asserted, every byte is shifted in both directions through the DMAC
+ * channels armed by the device, then the chip select is released again.
+ *
+ * @param[in] hostData - Bytes shifted out by the host
+ * @param[out] clientData - Bytes shifted out by the device, can be NULL
+ * @param[in] length - Number of bytes of the transaction
+ * @return None
+ */
+void SIM_SpiTransfer(const uint8_t * hostData, uint8_t * clientData, size_t length);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Runs one I2C write transaction of the host against the SERCOM0 I2C client of the device.
+ *
+ * @param[in] data - Bytes written by the host
+ * @param[in] length - Number of bytes
+ * @return True - The device has acknowledged its address and the bytes have been written
+ * @return False - The device has not acknowledged its address
+ */
+bool SIM_I2cWrite(const uint8_t * data, size_t length);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Runs one I2C read transaction of the host against the SERCOM0 I2C client of the device.
+ *
+ * @param[out] data - Buffer for the bytes read
+ * @param[in] length - Number of bytes to read
+ * @return True - The device has acknowledged its address and the bytes have been read
+ * @return False - The device has not acknowledged its address
+ */
+bool SIM_I2cRead(uint8_t * data, size_t length);
+
+#endif // SIM_HAL_H
@@ -0,0 +1,9 @@
+/**
+ * @file    system_pic32cmmc00.h
+ * @ingroup mdfu_host_sim
+ * @brief   Host stand-in for the CMSIS system header. The simulated device needs no system init.
+ */
+#ifndef SYSTEM_PIC32CMMC00_H
+#define SYSTEM_PIC32CMMC00_H
+
+#endif // SYSTEM_PIC32CMMC00_H
@@ -0,0 +1,11 @@
+/**
+ * @file    xc.h
+ * @ingroup mdfu_host_sim
+ * @brief   Host stand-in for the XC32 device header.
+ */
+#ifndef XC_H
+#define XC_H
+
+#include "device.h"
+
+#endif // XC_H
@@ -0,0 +1,1132 @@
+/**
+ * @file    sim_bench.c
+ * @ingroup mdfu_host_sim
+ * @brief   Measures complete MDFU updates of the simulated device over its serial link.
+ *
+ * The tool acts as the MDFU host: it sends Get Client Info, Start Transfer, one Write Chunk per
+ * block of the image, Get Image State and End Transfer through the host end of the transport.
+ * The device runs FTP_Task in between, so each command passes the transport, the FTP layer and
+ * the core as on the target, and the Flash and the wire charge their times on the virtual clock.
+ *
+ * Every update starts on a device reset to its power-on state. Besides .img files, synthetic
+ * images of a given application size can be measured. They hold pseudo-random data in full
+ * write blocks and a footer with the CRC of that data, so they verify on the device.
+ *
+ * Each update prints one JSON object on its own line with the throughput, the protocol overhead,
+ * the round trips and the split of the update time:
+ * - link: the bytes of the commands, responses and polls on the wire
+ * - flash: the device finishing the previous Flash operation before it answers a Write Chunk
+ * - verify: the device calculating the CRC of the image before it answers Get Image State
+ * - other: everything else, like waiting for the next poll of a bus
+ * - retry: attempts of a command that got no usable answer, like a timeout or a damaged response
+ * The Flash busy time is given on its own, as most of it overlaps with the transfer.
+ *
+ * Faults can be injected on the link to measure the goodput on a noisy line. The host then
+ * sends a command again, with the same sequence number, when its response is missing, damaged
+ * or asks for a resend. Each bit error rate given is measured on every image, so one call
+ * sweeps a range of rates.
+ *
+ * A client that supports the windowed mode takes several Write Chunks before it answers. The
+ * host asks for a window in Start Transfer and keeps up to the granted number of chunks in
+ * flight. The client acknowledges the last chunk of an unbroken run and asks for the first
+ * missing chunk again, so only the lost chunks are sent twice. The latency of a USB bridge can be
+ * added to the link to see what the window saves on each round trip.
+ *
+ * A UART client that lists the Set Baud Rate command in Get Client Info can be asked to switch
+ * the line to a higher baud rate before the transfer starts. The host switches its end of the
+ * line as soon as the client has confirmed the new baud rate.
+ *
+ * A UART client built with RTS/CTS flow control holds off the host while its receive ring buffer
+ * is nearly full. The host can follow RTS or ignore it, to see the overruns flow control saves.
+ *
+ * Usage:
+ *     mdfu_sim_bench_uart [options] [image.img...]
+ *
+ * Options:
+ *     --clock <hz>          Baud rate of the UART, SCK or SCL frequency of the bus
+ *     --poll-us <n>         Time the host waits before each transaction of a bus
+ *     --synthetic <bytes>   Adds an update with a synthetic image of the given application size
+ *     --write-size <bytes>  Size of the write blocks of synthetic images, whole Flash pages
+ *     --label <text>        Text copied into every result, for example the commit
+ *     --ber <rate>          Adds a bit error rate to the sweep, each data bit flips with this chance
+ *     --drop-rate <rate>    Chance of each byte to be lost
+ *     --truncate-rate <rate> Chance of a command frame to be cut off
+ *     --duplicate-rate <rate> Chance of a command frame to be sent twice
+ *     --seed <n>            Start value of the random faults
+ *     --retries <n>         Number of times a command is sent again before the update fails
+ *     --timeout-ms <n>      Time the host waits for a response
+ *     --window <n>          Number of Write Chunks the host asks to keep in flight, 1 waits for each answer
+ *     --latency-us <n>      Time a USB bridge holds the data in each direction
+ *     --baud <hz>           Baud rate the host proposes with Set Baud Rate, 0 keeps the clock
+ *     --flow-control        The host waits while the UART client holds it off with RTS
+ *
+ * The exit code is 0 when every update ends with a valid image.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bl_core.h"
+#include "bl_ftp.h"
+#include "peripheral/systick/plib_systick.h"
+#include "sim_hal.h"
+#include "sim_link.h"
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_BENCH_IMAGE_SIZE
+ * @brief Size of the buffer holding the image of one update.
+ */
+#define SIM_BENCH_IMAGE_SIZE            (0x40000U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_BENCH_RUN_COUNT
+ * @brief Number of updates that can be given on the command line.
+ */
+#define SIM_BENCH_RUN_COUNT             (32U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_BENCH_RESPONSE_SIZE
+ * @brief Size of the buffer for a response and its frame check.
+ */
+#define SIM_BENCH_RESPONSE_SIZE         (64U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_BENCH_RESPONSE_TIMEOUT
+ * @brief Default time in milliseconds the host waits for a response, the command timeout given by the client.
+ */
+#define SIM_BENCH_RESPONSE_TIMEOUT      (10000U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_BENCH_RETRY_COUNT
+ * @brief Default number of times a command is sent again before the update fails.
+ */
+#define SIM_BENCH_RETRY_COUNT           (5U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_BENCH_RATE_COUNT
+ * @brief Number of bit error rates that can be given on the command line.
+ */
+#define SIM_BENCH_RATE_COUNT            (16U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_BENCH_POLL_INTERVAL
+ * @brief Default time in nanoseconds the host waits before each transaction of a bus.
+ */
+#define SIM_BENCH_POLL_INTERVAL         (100000U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_BENCH_BLOCK_HEADER_SIZE
+ * @brief Size of the length and type fields that start every block of the image.
+ */
+#define SIM_BENCH_BLOCK_HEADER_SIZE     (3U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_BENCH_BLOCK_COUNT
+ * @brief Number of blocks of an image the windowed mode can send.
+ */
+#define SIM_BENCH_BLOCK_COUNT           (8192U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_BENCH_WINDOW_LIMIT
+ * @brief Largest window, half the range of the sequence number so old and new answers cannot be mixed up.
+ */
+#define SIM_BENCH_WINDOW_LIMIT          (16U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_BENCH_SEQUENCE_SYNC
+ * @brief Sequence field bit that makes the client take the sequence number of the packet.
+ */
+#define SIM_BENCH_SEQUENCE_SYNC         (0x80U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_BENCH_SEQUENCE_MASK
+ * @brief Range of the sequence number.
+ */
+#define SIM_BENCH_SEQUENCE_MASK         (0x1FU)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_BENCH_SEQUENCE_RESEND
+ * @brief Sequence field bit of a response that asks the host to send the command again.
+ */
+#define SIM_BENCH_SEQUENCE_RESEND       (0x40U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_BENCH_STATUS_SUCCESS
+ * @brief Status of a response to a command that has been executed.
+ */
+#define SIM_BENCH_STATUS_SUCCESS        (0x01U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_BENCH_BAUD_RATE_INFO
+ * @brief Type of the Get Client Info entry that holds the highest baud rate of Set Baud Rate.
+ */
+#define SIM_BENCH_BAUD_RATE_INFO        (0x81U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_BENCH_IMAGE_VALID
+ * @brief Image state reported for a valid image.
+ */
+#define SIM_BENCH_IMAGE_VALID           (0x01U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_BENCH_FOOTER_ADDRESS
+ * @brief Address of the footer at the end of the application space.
+ */
+#define SIM_BENCH_FOOTER_ADDRESS        (((uint32_t) BL_APPLICATION_END_ADDRESS + 1U) - (uint32_t) sizeof(bl_footer_data_t))
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_NANOSECONDS_PER_MILLISECOND
+ * @brief Conversion of the virtual clock to the printed times.
+ */
+#define SIM_NANOSECONDS_PER_MILLISECOND (1000000.0)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @enum sim_bench_command_t
+ * @brief MDFU commands sent by the host.
+ */
+typedef enum
+{
+    SIM_BENCH_GET_CLIENT_INFO = 0x01U,
+    SIM_BENCH_START_TRANSFER = 0x02U,
+    SIM_BENCH_WRITE_CHUNK = 0x03U,
+    SIM_BENCH_GET_IMAGE_STATE = 0x04U,
+    SIM_BENCH_END_TRANSFER = 0x05U,
+    SIM_BENCH_SET_BAUD_RATE = 0x81U
+} sim_bench_command_t;
+
+/**
+ * @ingroup mdfu_host_sim
+ * @struct sim_bench_result_t
+ * @brief Measurements of one update, all times in nanoseconds.
+ * @var sim_bench_result_t:: roundTrips
+ * Member 'roundTrips' contains the number of answers the host has used, one for each command unless a window is open
+ * @var sim_bench_result_t:: blocks
+ * Member 'blocks' contains the number of Write Chunk commands
+ * @var sim_bench_result_t:: linkTime
+ * Member 'linkTime' contains the time the link transferred data
+ * @var sim_bench_result_t:: flashTime
+ * Member 'flashTime' contains the time the host waited for the answer to a Write Chunk
+ * @var sim_bench_result_t:: verifyTime
+ * Member 'verifyTime' contains the time the host waited for the answer to Get Image State
+ * @var sim_bench_result_t:: otherTime
+ * Member 'otherTime' contains the time the host waited for the answer to the other commands
+ * @var sim_bench_result_t:: retryTime
+ * Member 'retryTime' contains the time of the attempts that got no usable answer
+ * @var sim_bench_result_t:: retries
+ * Member 'retries' contains the number of commands sent again
+ * @var sim_bench_result_t:: timeouts
+ * Member 'timeouts' contains the number of attempts without a response in time
+ * @var sim_bench_result_t:: damagedResponses
+ * Member 'damagedResponses' contains the number of responses with a wrong frame check
+ * @var sim_bench_result_t:: resendRequests
+ * Member 'resendRequests' contains the number of responses that asked for the command again
+ * @var sim_bench_result_t:: transferClock
+ * Member 'transferClock' contains the clock of the link during the transfer, changed by Set Baud Rate
+ * @var sim_bench_result_t:: window
+ * Member 'window' contains the number of Write Chunks granted in flight
+ * @var sim_bench_result_t:: isImageValid
+ * Member 'isImageValid' is set when the device has reported a valid image
+ */
+typedef struct
+{
+    uint32_t roundTrips;
+    uint32_t blocks;
+    uint64_t linkTime;
+    uint64_t flashTime;
+    uint64_t verifyTime;
+    uint64_t otherTime;
+    uint64_t retryTime;
+    uint32_t retries;
+    uint32_t timeouts;
+    uint32_t damagedResponses;
+    uint32_t resendRequests;
+    uint32_t transferClock;
+    uint8_t window;
+    bool isImageValid;
+} sim_bench_result_t;
+
+static uint8_t imageBuffer[SIM_BENCH_IMAGE_SIZE];
+static size_t blockOffsets[SIM_BENCH_BLOCK_COUNT + 1U];
+static uint8_t sequenceNumber = 0U;
+static uint8_t windowRequest = 1U;
+static uint32_t baudRateRequest = 0U;
+static bool isFlowControlled = false;
+static size_t lastResponseLength = 0U;
+static uint32_t retryLimit = SIM_BENCH_RETRY_COUNT;
+static uint16_t writeSize = (uint16_t) BL_WRITE_BYTE_LENGTH;
+static uint64_t responseTimeout = (uint64_t) SIM_BENCH_RESPONSE_TIMEOUT * 1000000U;
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Builds the packet of a command and sends it to the device.
+ *
+ * @param[in] sequenceField - Sequence byte of the packet
+ * @param[in] command - MDFU command
+ * @param[in] data - Data of the command, can be NULL when the length is 0
+ * @param[in] length - Length of the data
+ * @return None
+ */
+static void CommandSend(uint8_t sequenceField, sim_bench_command_t command, const uint8_t * data, size_t length);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Sends one command, waits for its response and adds the time it took to the result.
+ *
+ * The command is sent again when the response is missing, damaged or asks for a resend.
+ *
+ * @param[in] command - MDFU command
+ * @param[in] data - Data of the command, can be NULL when the length is 0
+ * @param[in] length - Length of the data
+ * @param[out] response - Buffer for the response, sequence byte first
+ * @param[in,out] result - Measurements of the update
+ * @return True - The device has executed the command
+ * @return False - No response after all retries, or the response reports an error
+ */
+static bool CommandRun(sim_bench_command_t command, const uint8_t * data, size_t length, uint8_t * response, sim_bench_result_t * result);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Sends the Write Chunks of the image with up to a window of them in flight.
+ *
+ * The time of the whole phase is split into the time on the wire and the time of the device,
+ * which is charged as Flash time.
+ *
+ * @param[in] image - Blocks of the image
+ * @param[in] blockCount - Number of blocks, their offsets are in blockOffsets
+ * @param[in,out] result - Measurements of the update
+ * @return True - The device has executed every Write Chunk
+ * @return False - No answer after all retries, or a Write Chunk has failed
+ */
+static bool WindowRun(const uint8_t * image, size_t blockCount, sim_bench_result_t * result);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Runs a complete update with the image.
+ *
+ * @param[in] image - Blocks of the image
+ * @param[in] imageLength - Length of the image
+ * @param[in] clock - Clock of the link at the start of the update
+ * @param[out] result - Measurements of the update
+ * @return None
+ */
+static void UpdateRun(const uint8_t * image, size_t imageLength, uint32_t clock, sim_bench_result_t * result);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Looks for an entry in the response to Get Client Info.
+ *
+ * @param[in] response - Response, sequence byte first
+ * @param[in] responseLength - Length of the response
+ * @param[in] type - Type of the entry
+ * @return Pointer to the value of the entry, NULL if the client does not list it
+ */
+static const uint8_t * ClientInfoFind(const uint8_t * response, size_t responseLength, uint8_t type);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Reads an .img file into the image buffer.
+ *
+ * @param[in] imagePath - Path of the file
+ * @return Length of the image, 0 if the file cannot be read or does not fit
+ */
+static size_t ImageLoad(const char * imagePath);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Builds an image with the given application size in the image buffer.
+ *
+ * The application is rounded up to whole write blocks. The footer is sent in its own block at
+ * the end of the application space.
+ *
+ * @param[in] applicationSize - Size of the application in bytes
+ * @return Length of the image, 0 if the application does not fit into the application space
+ */
+static size_t ImageSynthesize(uint32_t applicationSize);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Adds a write block to the image buffer.
+ *
+ * @param[in] offset - Offset of the block in the image buffer
+ * @param[in] address - Start address of the block
+ * @param[in] payload - Data of one write block, the write size of the synthetic images long
+ * @return Offset of the next block
+ */
+static size_t WriteBlockAdd(size_t offset, uint32_t address, const uint8_t * payload);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Calculates the CRC-32 the DSU calculates, without the final inversion.
+ *
+ * @param[in] data - Bytes to check
+ * @param[in] length - Number of bytes
+ * @return CRC of the bytes
+ */
+static uint32_t Crc32Calculate(const uint8_t * data, size_t length);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Reads an unsigned number option.
+ *
+ * @param[in] value - Text of the option value
+ * @param[in] minimum - Smallest valid value
+ * @param[out] number - Value of the option
+ * @return True - The value is a number not below the minimum that fits into 32 bits
+ * @return False - The value is not valid
+ */
+static bool NumberOptionRead(const char * value, uint32_t minimum, uint32_t * number);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Reads a rate option.
+ *
+ * @param[in] value - Text of the option value, a decimal or exponent notation like 1e-5
+ * @param[out] rate - Value of the option
+ * @return True - The value is a number from 0 to 1
+ * @return False - The value is not valid
+ */
+static bool RateOptionRead(const char * value, double * rate);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Prints the measurements of one update as a line of JSON.
+ *
+ * @param[in] label - Label given on the command line, can be NULL
+ * @param[in] imageName - Name of the image
+ * @param[in] imageLength - Length of the image
+ * @param[in] clock - Clock of the link in Hz
+ * @param[in] faults - Faults injected on the link
+ * @param[in] result - Measurements of the update
+ * @return None
+ */
+static void ResultPrint(const char * label, const char * imageName, size_t imageLength, uint32_t clock, const sim_link_faults_t * faults, const sim_bench_result_t * result);
+
+static void CommandSend(uint8_t sequenceField, sim_bench_command_t command, const uint8_t * data, size_t length)
+{
+    static uint8_t packet[SIM_BENCH_IMAGE_SIZE];
+
+    packet[0] = sequenceField;
+    packet[1] = (uint8_t) command;
+    if (length > 0U)
+    {
+        (void) memcpy(&packet[2], data, length);
+    }
+
+    // A command the device has not taken completely can still be answered with a resend request
+    (void) SIM_LinkCommandSend(&packet[0], length + 2U);
+}
+
+static bool CommandRun(sim_bench_command_t command, const uint8_t * data, size_t length, uint8_t * response, sim_bench_result_t * result)
+{
+    size_t responseLength = 0U;
+    bool isAnswered = false;
+
+    // The first command of an update synchronizes the sequence number of the client
+    uint8_t sequenceField = (command == SIM_BENCH_GET_CLIENT_INFO) ? (uint8_t)(sequenceNumber | SIM_BENCH_SEQUENCE_SYNC) : sequenceNumber;
+
+    for (uint32_t attempt = 0U; (attempt <= retryLimit) && (isAnswered == false); attempt++)
+    {
+        uint64_t startTime = SIM_TimeGet();
+        uint64_t startWireTime = SIM_LinkStatisticsGet()->wireTime;
+        uint64_t endTime = startTime + responseTimeout;
+        bool isWaiting = true;
+
+        if (attempt > 0U)
+        {
+            result->retries++;
+        }
+
+        CommandSend(sequenceField, command, data, length);
+
+        while (isWaiting)
+        {
+            uint64_t currentTime = SIM_TimeGet();
+            bool isReceived = (currentTime < endTime)
+                    && SIM_LinkResponseReceive(response, SIM_BENCH_RESPONSE_SIZE, &responseLength, endTime - currentTime);
+
+            if (isReceived == false)
+            {
+                if (SIM_TimeGet() >= endTime)
+                {
+                    result->timeouts++;
+                }
+                else
+                {
+                    result->damagedResponses++;
+                }
+                isWaiting = false;
+            }
+            else if (responseLength < 2U)
+            {
+                result->damagedResponses++;
+                isWaiting = false;
+            }
+            else if ((response[0] & SIM_BENCH_SEQUENCE_RESEND) != 0U)
+            {
+                result->resendRequests++;
+                isWaiting = false;
+            }
+            else if (response[0] == sequenceNumber)
+            {
+                isAnswered = true;
+                lastResponseLength = responseLength;
+                isWaiting = false;
+            }
+            else
+            {
+                // The answer to a repeated frame of an earlier command
+            }
+        }
+
+        // What is not spent on the wire is spent by the device before it answers
+        uint64_t wireTime = SIM_LinkStatisticsGet()->wireTime - startWireTime;
+        uint64_t elapsedTime = SIM_TimeGet() - startTime;
+        uint64_t deviceTime = (elapsedTime > wireTime) ? (elapsedTime - wireTime) : 0U;
+
+        if (isAnswered == false)
+        {
+            result->retryTime += elapsedTime;
+        }
+        else
+        {
+            result->linkTime += wireTime;
+            if (command == SIM_BENCH_WRITE_CHUNK)
+            {
+                result->flashTime += deviceTime;
+            }
+            else if (command == SIM_BENCH_GET_IMAGE_STATE)
+            {
+                result->verifyTime += deviceTime;
+            }
+            else
+            {
+                result->otherTime += deviceTime;
+            }
+        }
+    }
+
+    bool isExecuted = isAnswered && (response[1] == SIM_BENCH_STATUS_SUCCESS);
+    if (isAnswered == false)
+    {
+        (void) fprintf(stderr, "command 0x%02X not answered after %u retries\n", (unsigned int) command, (unsigned int) retryLimit);
+    }
+    else if (isExecuted == false)
+    {
+        // A damaged command that passes the frame check can be rejected by the client
+        (void) fprintf(stderr, "command 0x%02X failed, status 0x%02X\n", (unsigned int) command, (unsigned int) response[1]);
+    }
+    result->roundTrips++;
+
+    sequenceNumber = (uint8_t)((sequenceNumber + 1U) & SIM_BENCH_SEQUENCE_MASK);
+
+    return isExecuted;
+}
+
+static bool WindowRun(const uint8_t * image, size_t blockCount, sim_bench_result_t * result)
+{
+    uint8_t response[SIM_BENCH_RESPONSE_SIZE] = {0U};
+    uint8_t firstSequenceNumber = sequenceNumber;
+    uint64_t startTime = SIM_TimeGet();
+    uint64_t startWireTime = SIM_LinkStatisticsGet()->wireTime;
+    uint64_t endTime = startTime + responseTimeout;
+    size_t baseIndex = 0U;
+    size_t nextIndex = 0U;
+    uint32_t attempt = 0U;
+    bool isFailed = false;
+
+    // The blocks from the base on are not acknowledged yet, the blocks before the next one have been sent
+    while ((baseIndex < blockCount) && (isFailed == false))
+    {
+        size_t responseLength = 0U;
+        bool isResendNeeded = false;
+        bool isWindowFull = (nextIndex == blockCount) || ((nextIndex - baseIndex) == result->window);
+
+        if (isWindowFull == false)
+        {
+            const uint8_t * blockPtr = &image[blockOffsets[nextIndex]];
+            size_t blockLength = (size_t) blockPtr[0] | ((size_t) blockPtr[1] << 8);
+
+            CommandSend((uint8_t)((firstSequenceNumber + nextIndex) & SIM_BENCH_SEQUENCE_MASK), SIM_BENCH_WRITE_CHUNK, blockPtr, blockLength);
+            nextIndex++;
+        }
+
+        // The answers that have already come in are taken between the chunks, a full window waits for one
+        uint64_t currentTime = SIM_TimeGet();
+        uint64_t timeout = (isWindowFull && (currentTime < endTime)) ? (endTime - currentTime) : 0U;
+        bool isReceived = SIM_LinkResponseReceive(&response[0], SIM_BENCH_RESPONSE_SIZE, &responseLength, timeout);
+
+        if (isReceived && (responseLength >= 2U))
+        {
+            size_t answerOffset = ((size_t) response[0] - firstSequenceNumber - baseIndex) & SIM_BENCH_SEQUENCE_MASK;
+
+            if ((response[0] & SIM_BENCH_SEQUENCE_RESEND) != 0U)
+            {
+                // The client has taken everything before the chunk it asks for
+                result->resendRequests++;
+                if (answerOffset <= (nextIndex - baseIndex))
+                {
+                    result->roundTrips++;
+                    attempt = (answerOffset > 0U) ? 0U : attempt;
+                    baseIndex += answerOffset;
+                    isResendNeeded = (baseIndex < nextIndex);
+                }
+            }
+            else if (answerOffset >= (nextIndex - baseIndex))
+            {
+                // The answer to a copy of a chunk that has already been acknowledged
+            }
+            else if (response[1] != SIM_BENCH_STATUS_SUCCESS)
+            {
+                (void) fprintf(stderr, "command 0x%02X failed, status 0x%02X\n", (unsigned int) SIM_BENCH_WRITE_CHUNK, (unsigned int) response[1]);
+                isFailed = true;
+            }
+            else
+            {
+                // Acknowledges every chunk up to the one it answers
+                result->roundTrips++;
+                baseIndex += answerOffset + 1U;
+                attempt = 0U;
+                endTime = SIM_TimeGet() + responseTimeout;
+            }
+        }
+        else if (isWindowFull == false)
+        {
+            // No complete answer has come in yet
+        }
+        else if (SIM_TimeGet() >= endTime)
+        {
+            result->timeouts++;
+            isResendNeeded = true;
+        }
+        else
+        {
+            result->damagedResponses++;
+            isResendNeeded = true;
+        }
+
+        if (isResendNeeded)
+        {
+            // Only the first chunk that is not acknowledged is sent again, each chunk in flight can ask for it once
+            attempt++;
+            result->retries++;
+            if (attempt > (retryLimit * result->window))
+            {
+                (void) fprintf(stderr, "command 0x%02X not answered after %u retries\n", (unsigned int) SIM_BENCH_WRITE_CHUNK, (unsigned int) retryLimit);
+                isFailed = true;
+            }
+            else
+            {
+                const uint8_t * blockPtr = &image[blockOffsets[baseIndex]];
+                size_t blockLength = (size_t) blockPtr[0] | ((size_t) blockPtr[1] << 8);
+
+                CommandSend((uint8_t)((firstSequenceNumber + baseIndex) & SIM_BENCH_SEQUENCE_MASK), SIM_BENCH_WRITE_CHUNK, blockPtr, blockLength);
+                endTime = SIM_TimeGet() + responseTimeout;
+            }
+        }
+    }
+
+    // The transfer and the Flash operations overlap, what is not spent on the wire is spent by the device
+    uint64_t wireTime = SIM_LinkStatisticsGet()->wireTime - startWireTime;
+    uint64_t elapsedTime = SIM_TimeGet() - startTime;
+    result->linkTime += wireTime;
+    result->flashTime += (elapsedTime > wireTime) ? (elapsedTime - wireTime) : 0U;
+
+    sequenceNumber = (uint8_t)((firstSequenceNumber + blockCount) & SIM_BENCH_SEQUENCE_MASK);
+
+    return (isFailed == false);
+}
+
+static const uint8_t * ClientInfoFind(const uint8_t * response, size_t responseLength, uint8_t type)
+{
+    const uint8_t * valuePtr = NULL;
+    size_t offset = 2U;
+
+    // Each entry is its type, the length of its value and the value
+    while ((valuePtr == NULL) && ((offset + 2U) <= responseLength))
+    {
+        size_t valueLength = response[offset + 1U];
+
+        if ((response[offset] == type) && ((offset + 2U + valueLength) <= responseLength))
+        {
+            valuePtr = &response[offset + 2U];
+        }
+        offset += 2U + valueLength;
+    }
+
+    return valuePtr;
+}
+
+static void UpdateRun(const uint8_t * image, size_t imageLength, uint32_t clock, sim_bench_result_t * result)
+{
+    uint8_t response[SIM_BENCH_RESPONSE_SIZE] = {0U};
+    size_t offset = 0U;
+
+    (void) memset(result, 0, sizeof(sim_bench_result_t));
+    sequenceNumber = 0U;
+    result->window = 1U;
+    result->transferClock = clock;
+
+    bool isExecuted = CommandRun(SIM_BENCH_GET_CLIENT_INFO, NULL, 0U, &response[0], result);
+
+    // The client confirms the baud rate it switches to once the response has left
+    if (isExecuted && (baudRateRequest > 0U) && (ClientInfoFind(&response[0], lastResponseLength, SIM_BENCH_BAUD_RATE_INFO) != NULL))
+    {
+        uint8_t baudRateData[4];
+
+        (void) memcpy(&baudRateData[0], &baudRateRequest, sizeof(baudRateData));
+        isExecuted = CommandRun(SIM_BENCH_SET_BAUD_RATE, &baudRateData[0], sizeof(baudRateData), &response[0], result)
+                && (lastResponseLength >= 6U);
+        if (isExecuted)
+        {
+            (void) memcpy(&result->transferClock, &response[2], sizeof(result->transferClock));
+            SIM_LinkClockSet(result->transferClock);
+        }
+    }
+
+    // A client without the windowed mode ignores the request and answers without data
+    response[2] = 0U;
+    isExecuted = isExecuted && CommandRun(SIM_BENCH_START_TRANSFER, &windowRequest, (windowRequest > 1U) ? 1U : 0U, &response[0], result);
+
+    if (isExecuted && (response[2] > 1U) && (response[2] <= windowRequest))
+    {
+        result->window = response[2];
+    }
+
+    // Every block of the image is one chunk
+    while (isExecuted && ((offset + SIM_BENCH_BLOCK_HEADER_SIZE) <= imageLength))
+    {
+        size_t blockLength = (size_t) image[offset] | ((size_t) image[offset + 1U] << 8);
+
+        if ((blockLength < SIM_BENCH_BLOCK_HEADER_SIZE) || ((offset + blockLength) > imageLength))
+        {
+            (void) fprintf(stderr, "truncated block %u\n", (unsigned int) result->blocks);
+            isExecuted = false;
+        }
+        else if (result->window == 1U)
+        {
+            isExecuted = CommandRun(SIM_BENCH_WRITE_CHUNK, &image[offset], blockLength, &response[0], result);
+            offset += blockLength;
+            result->blocks++;
+        }
+        else if (result->blocks < SIM_BENCH_BLOCK_COUNT)
+        {
+            // An open window can send any block again, so they are all located first
+            blockOffsets[result->blocks] = offset;
+            offset += blockLength;
+            result->blocks++;
+        }
+        else
+        {
+            (void) fprintf(stderr, "more than %u blocks\n", (unsigned int) SIM_BENCH_BLOCK_COUNT);
+            isExecuted = false;
+        }
+    }
+
+    if (isExecuted && (result->window > 1U))
+    {
+        isExecuted = WindowRun(image, result->blocks, result);
+    }
+
+    if (isExecuted && CommandRun(SIM_BENCH_GET_IMAGE_STATE, NULL, 0U, &response[0], result))
+    {
+        result->isImageValid = (response[2] == SIM_BENCH_IMAGE_VALID);
+    }
+
+    if (result->isImageValid)
+    {
+        (void) CommandRun(SIM_BENCH_END_TRANSFER, NULL, 0U, &response[0], result);
+    }
+}
+
+static size_t ImageLoad(const char * imagePath)
+{
+    size_t imageLength = 0U;
+    FILE * imageFile = fopen(imagePath, "rb");
+
+    if (imageFile == NULL)
+    {
+        (void) fprintf(stderr, "cannot open %s\n", imagePath);
+    }
+    else
+    {
+        imageLength = fread(&imageBuffer[0], 1U, SIM_BENCH_IMAGE_SIZE, imageFile);
+        if (fgetc(imageFile) != EOF)
+        {
+            (void) fprintf(stderr, "%s is larger than %u bytes\n", imagePath, (unsigned int) SIM_BENCH_IMAGE_SIZE);
+            imageLength = 0U;
+        }
+        (void) fclose(imageFile);
+    }
+
+    return imageLength;
+}
+
+static size_t WriteBlockAdd(size_t offset, uint32_t address, const uint8_t * payload)
+{
+    uint16_t blockLength = (uint16_t)(SIM_BENCH_BLOCK_HEADER_SIZE + 4U + writeSize);
+    uint8_t * blockPtr = &imageBuffer[offset];
+
+    blockPtr[0] = (uint8_t) blockLength;
+    blockPtr[1] = (uint8_t)(blockLength >> 8);
+    blockPtr[2] = 0x02U;
+    (void) memcpy(&blockPtr[SIM_BENCH_BLOCK_HEADER_SIZE], &address, 4U);
+    (void) memcpy(&blockPtr[SIM_BENCH_BLOCK_HEADER_SIZE + 4U], payload, writeSize);
+
+    return offset + blockLength;
+}
+
+static size_t ImageSynthesize(uint32_t applicationSize)
+{
+    static uint8_t application[BL_APPLICATION_END_ADDRESS + 1U - BL_APPLICATION_START_ADDRESS];
+    const uint32_t startAddress = (uint32_t) BL_APPLICATION_START_ADDRESS;
+    uint32_t footerBlockAddress = SIM_BENCH_FOOTER_ADDRESS - (SIM_BENCH_FOOTER_ADDRESS % writeSize);
+    uint32_t applicationLength = ((applicationSize + writeSize - 1U) / writeSize) * writeSize;
+    size_t imageLength = 0U;
+
+    if ((applicationLength > 0U) && (applicationLength <= (footerBlockAddress - startAddress)))
+    {
+        // Same data for the same size, so results can be compared between builds
+        uint32_t randomState = 0x2545F491U ^ applicationSize;
+        for (uint32_t byteIndex = 0U; byteIndex < applicationLength; byteIndex++)
+        {
+            randomState ^= randomState << 13;
+            randomState ^= randomState >> 17;
+            randomState ^= randomState << 5;
+            application[byteIndex] = (uint8_t) randomState;
+        }
+
+        // The metadata block has the size of the write blocks: format version, device ID, write size and start address
+        uint16_t metadataLength = (uint16_t)(SIM_BENCH_BLOCK_HEADER_SIZE + 4U + writeSize);
+        uint32_t deviceId = CHIP_DSU_DID & ~0xF00U;
+        (void) memset(&imageBuffer[0], 0, metadataLength);
+        imageBuffer[0] = (uint8_t) metadataLength;
+        imageBuffer[1] = (uint8_t)(metadataLength >> 8);
+        imageBuffer[2] = 0x01U;
+        imageBuffer[5] = (uint8_t) BL_IMAGE_FORMAT_MAJOR_VERSION;
+        (void) memcpy(&imageBuffer[6], &deviceId, 4U);
+        (void) memcpy(&imageBuffer[10], &writeSize, 2U);
+        (void) memcpy(&imageBuffer[12], &startAddress, 4U);
+        imageLength = metadataLength;
+
+        for (uint32_t blockOffset = 0U; blockOffset < applicationLength; blockOffset += writeSize)
+        {
+            imageLength = WriteBlockAdd(imageLength, startAddress + blockOffset, &application[blockOffset]);
+        }
+
+        // The hash range ends with the application, the rest of the footer block stays erased
+        bl_footer_data_t footer = {
+            .applicationId = 0U,
+            .applicationVersion = 0x100U,
+            .verificationEndAddress = startAddress + applicationLength - 1U,
+            .verificationStartAddress = startAddress,
+            .verificationData = Crc32Calculate(&application[0], applicationLength)
+        };
+        uint8_t footerBlock[BL_WRITE_BYTE_LENGTH];
+        (void) memset(&footerBlock[0], 0xFF, writeSize);
+        (void) memcpy(&footerBlock[SIM_BENCH_FOOTER_ADDRESS - footerBlockAddress], &footer, sizeof(footer));
+        imageLength = WriteBlockAdd(imageLength, footerBlockAddress, &footerBlock[0]);
+    }
+
+    return imageLength;
+}
+
+static uint32_t Crc32Calculate(const uint8_t * data, size_t length)
+{
+    uint32_t crc = 0xFFFFFFFFU;
+
+    for (size_t byteIndex = 0U; byteIndex < length; byteIndex++)
+    {
+        crc ^= data[byteIndex];
+        for (uint8_t bitIndex = 0U; bitIndex < 8U; bitIndex++)
+        {
+            crc = ((crc & 1U) != 0U) ? ((crc >> 1) ^ 0xEDB88320U) : (crc >> 1);
+        }
+    }
+
+    return crc;
+}
+
+static bool NumberOptionRead(const char * value, uint32_t minimum, uint32_t * number)
+{
+    char * endPtr = NULL;
+    unsigned long optionValue = strtoul(value, &endPtr, 10);
+    bool isValid = ((endPtr != value) && (*endPtr == '\0') && (optionValue >= minimum) && (optionValue <= UINT32_MAX));
+
+    if (isValid)
+    {
+        *number = (uint32_t) optionValue;
+    }
+
+    return isValid;
+}
+
+static bool RateOptionRead(const char * value, double * rate)
+{
+    char * endPtr = NULL;
+    double optionValue = strtod(value, &endPtr);
+    bool isValid = ((endPtr != value) && (*endPtr == '\0') && (optionValue >= 0.0) && (optionValue <= 1.0));
+
+    if (isValid)
+    {
+        *rate = optionValue;
+    }
+
+    return isValid;
+}
+
+static void ResultPrint(const char * label, const char * imageName, size_t imageLength, uint32_t clock, const sim_link_faults_t * faults, const sim_bench_result_t * result)
+{
+    const sim_link_statistics_t * linkStatistics = SIM_LinkStatisticsGet();
+    sim_flash_statistics_t flashStatistics;
+    uint64_t totalTime = result->linkTime + result->flashTime + result->verifyTime + result->otherTime + result->retryTime;
+    uint64_t wireBytes = linkStatistics->hostBytes + linkStatistics->clientBytes;
+
+    SIM_FlashStatisticsGet(&flashStatistics);
+
+    (void) printf("{\"label\":\"%s\",\"transport\":\"%s\",\"image\":\"%s\",\"clock\":%u,\"transferClock\":%u,",
+            (label != NULL) ? label : "", SIM_BENCH_TRANSPORT, imageName, (unsigned int) clock, (unsigned int) result->transferClock);
+    (void) printf("\"ber\":%g,\"dropRate\":%g,\"truncateRate\":%g,\"duplicateRate\":%g,\"seed\":%llu,",
+            faults->bitErrorRate, faults->byteDropRate, faults->truncateRate, faults->duplicateRate, (unsigned long long) faults->seed);
+    (void) printf("\"imageBytes\":%u,\"writeSize\":%u,\"blocks\":%u,\"window\":%u,\"flowControl\":%s,\"roundTrips\":%u,\"transactions\":%u,\"busyPolls\":%u,",
+            (unsigned int) imageLength, (unsigned int) imageBuffer[10] | ((unsigned int) imageBuffer[11] << 8), (unsigned int) result->blocks, (unsigned int) result->window,
+            isFlowControlled ? "true" : "false", (unsigned int) result->roundTrips, (unsigned int) linkStatistics->transactions, (unsigned int) linkStatistics->busyPolls);
+    (void) printf("\"hostBytes\":%llu,\"clientBytes\":%llu,\"overheadPercent\":%.2f,",
+            (unsigned long long) linkStatistics->hostBytes, (unsigned long long) linkStatistics->clientBytes,
+            (imageLength > 0U) ? (((double) wireBytes - (double) imageLength) * 100.0 / (double) imageLength) : 0.0);
+    (void) printf("\"totalMs\":%.3f,\"linkMs\":%.3f,\"flashMs\":%.3f,\"verifyMs\":%.3f,\"otherMs\":%.3f,\"flashBusyMs\":%.3f,\"holdMs\":%.3f,",
+            (double) totalTime / SIM_NANOSECONDS_PER_MILLISECOND,
+            (double) result->linkTime / SIM_NANOSECONDS_PER_MILLISECOND,
+            (double) result->flashTime / SIM_NANOSECONDS_PER_MILLISECOND,
+            (double) result->verifyTime / SIM_NANOSECONDS_PER_MILLISECOND,
+            (double) result->otherTime / SIM_NANOSECONDS_PER_MILLISECOND,
+            (double) flashStatistics.busyTime / SIM_NANOSECONDS_PER_MILLISECOND,
+            (double) linkStatistics->holdTime / SIM_NANOSECONDS_PER_MILLISECOND);
+    (void) printf("\"retryMs\":%.3f,\"retries\":%u,\"timeouts\":%u,\"damagedResponses\":%u,\"resendRequests\":%u,",
+            (double) result->retryTime / SIM_NANOSECONDS_PER_MILLISECOND, (unsigned int) result->retries,
+            (unsigned int) result->timeouts, (unsigned int) result->damagedResponses, (unsigned int) result->resendRequests);
+    (void) printf("\"bitFlips\":%u,\"droppedBytes\":%u,\"truncatedFrames\":%u,\"duplicatedFrames\":%u,",
+            (unsigned int) linkStatistics->bitFlips, (unsigned int) linkStatistics->droppedBytes,
+            (unsigned int) linkStatistics->truncatedFrames, (unsigned int) linkStatistics->duplicatedFrames);
+    (void) printf("\"throughput\":%.1f,\"result\":\"%s\"}\n",
+            ((totalTime > 0U) && result->isImageValid) ? ((double) imageLength * 1000000000.0 / (double) totalTime) : 0.0,
+            result->isImageValid ? "valid" : "failed");
+}
+
+int main(int argc, char ** argv)
+{
+    const char * imagePaths[SIM_BENCH_RUN_COUNT];
+    uint32_t syntheticSizes[SIM_BENCH_RUN_COUNT];
+    size_t runCount = 0U;
+    uint32_t clock = SIM_LinkDefaultClockGet();
+    uint32_t pollInterval = SIM_BENCH_POLL_INTERVAL / 1000U;
+    const char * label = NULL;
+    double bitErrorRates[SIM_BENCH_RATE_COUNT] = {0.0};
+    size_t rateCount = 0U;
+    sim_link_faults_t faults = {0.0, 0.0, 0.0, 0.0, 1U};
+    uint32_t seed = 1U;
+    uint32_t timeout = SIM_BENCH_RESPONSE_TIMEOUT;
+    uint32_t window = 1U;
+    uint32_t latency = 0U;
+    bool isValid = true;
+
+    for (int argIndex = 1; (argIndex < argc) && isValid; argIndex++)
+    {
+        bool hasValue = ((argIndex + 1) < argc);
+
+        if (strncmp(argv[argIndex], "--", 2U) != 0)
+        {
+            isValid = (runCount < SIM_BENCH_RUN_COUNT);
+            if (isValid)
+            {
+                imagePaths[runCount] = argv[argIndex];
+                syntheticSizes[runCount] = 0U;
+                runCount++;
+            }
+        }
+        else if (hasValue && (strcmp(argv[argIndex], "--synthetic") == 0))
+        {
+            argIndex++;
+            isValid = (runCount < SIM_BENCH_RUN_COUNT) && NumberOptionRead(argv[argIndex], 1U, &syntheticSizes[runCount]);
+            if (isValid)
+            {
+                imagePaths[runCount] = NULL;
+                runCount++;
+            }
+        }
+        else if (hasValue && (strcmp(argv[argIndex], "--clock") == 0))
+        {
+            argIndex++;
+            isValid = NumberOptionRead(argv[argIndex], 1U, &clock);
+        }
+        else if (hasValue && (strcmp(argv[argIndex], "--poll-us") == 0))
+        {
+            argIndex++;
+            isValid = NumberOptionRead(argv[argIndex], 1U, &pollInterval);
+        }
+        else if (hasValue && (strcmp(argv[argIndex], "--write-size") == 0))
+        {
+            uint32_t blockSize = 0U;
+
+            // The client takes whole pages up to the size of its write buffer
+            argIndex++;
+            isValid = NumberOptionRead(argv[argIndex], 1U, &blockSize) && (blockSize <= BL_WRITE_BYTE_LENGTH)
+                    && ((blockSize % NVMCTRL_FLASH_PAGESIZE) == 0U);
+            writeSize = (uint16_t) blockSize;
+        }
+        else if (hasValue && (strcmp(argv[argIndex], "--ber") == 0))
+        {
+            argIndex++;
+            isValid = (rateCount < SIM_BENCH_RATE_COUNT) && RateOptionRead(argv[argIndex], &bitErrorRates[rateCount]);
+            rateCount++;
+        }
+        else if (hasValue && (strcmp(argv[argIndex], "--drop-rate") == 0))
+        {
+            argIndex++;
+            isValid = RateOptionRead(argv[argIndex], &faults.byteDropRate);
+        }
+        else if (hasValue && (strcmp(argv[argIndex], "--truncate-rate") == 0))
+        {
+            argIndex++;
+            isValid = RateOptionRead(argv[argIndex], &faults.truncateRate);
+        }
+        else if (hasValue && (strcmp(argv[argIndex], "--duplicate-rate") == 0))
+        {
+            argIndex++;
+            isValid = RateOptionRead(argv[argIndex], &faults.duplicateRate);
+        }
+        else if (hasValue && (strcmp(argv[argIndex], "--seed") == 0))
+        {
+            argIndex++;
+            isValid = NumberOptionRead(argv[argIndex], 1U, &seed);
+        }
+        else if (hasValue && (strcmp(argv[argIndex], "--retries") == 0))
+        {
+            argIndex++;
+            isValid = NumberOptionRead(argv[argIndex], 0U, &retryLimit);
+        }
+        else if (hasValue && (strcmp(argv[argIndex], "--timeout-ms") == 0))
+        {
+            argIndex++;
+            isValid = NumberOptionRead(argv[argIndex], 1U, &timeout);
+        }
+        else if (hasValue && (strcmp(argv[argIndex], "--window") == 0))
+        {
+            argIndex++;
+            isValid = NumberOptionRead(argv[argIndex], 1U, &window) && (window <= SIM_BENCH_WINDOW_LIMIT);
+        }
+        else if (hasValue && (strcmp(argv[argIndex], "--latency-us") == 0))
+        {
+            argIndex++;
+            isValid = NumberOptionRead(argv[argIndex], 0U, &latency);
+        }
+        else if (hasValue && (strcmp(argv[argIndex], "--baud") == 0))
+        {
+            argIndex++;
+            isValid = NumberOptionRead(argv[argIndex], 0U, &baudRateRequest);
+        }
+        else if (strcmp(argv[argIndex], "--flow-control") == 0)
+        {
+            isFlowControlled = true;
+        }
+        else if (hasValue && (strcmp(argv[argIndex], "--label") == 0))
+        {
+            argIndex++;
+            label = argv[argIndex];
+        }
+        else
+        {
+            isValid = false;
+        }
+    }
+
+    if ((isValid == false) || (runCount == 0U))
+    {
+        (void) fprintf(stderr, "usage: %s [--clock <hz>] [--poll-us <n>] [--label <text>] [--ber <rate>]... [--drop-rate <rate>]"
+                " [--truncate-rate <rate>] [--duplicate-rate <rate>] [--seed <n>] [--retries <n>] [--timeout-ms <n>]"
+                " [--window <n>] [--latency-us <n>] [--baud <hz>] [--flow-control]"
+                " [--write-size <bytes>] [--synthetic <bytes>]... [<image.img>...]\n", argv[0]);
+        return 2;
+    }
+
+    // Without a sweep every image is measured once on a clean line
+    rateCount = (rateCount > 0U) ? rateCount : 1U;
+    faults.seed = seed;
+    responseTimeout = (uint64_t) timeout * 1000000U;
+    windowRequest = (uint8_t) window;
+
+    int exitCode = 0;
+
+    for (size_t runIndex = 0U; runIndex < runCount; runIndex++)
+    {
+        char imageName[32];
+        const char * namePtr = imagePaths[runIndex];
+        size_t imageLength = 0U;
+        sim_bench_result_t result;
+
+        if (namePtr != NULL)
+        {
+            imageLength = ImageLoad(namePtr);
+            const char * separatorPtr = strrchr(namePtr, '/');
+            namePtr = (separatorPtr != NULL) ? (separatorPtr + 1) : namePtr;
+        }
+        else
+        {
+            imageLength = ImageSynthesize(syntheticSizes[runIndex]);
+            (void) snprintf(&imageName[0], sizeof(imageName), "synthetic-%u", (unsigned int) syntheticSizes[runIndex]);
+            namePtr = &imageName[0];
+            if (imageLength == 0U)
+            {
+                (void) fprintf(stderr, "a %u byte application does not fit into the application space\n", (unsigned int) syntheticSizes[runIndex]);
+            }
+        }
+
+        if (imageLength == 0U)
+        {
+            exitCode = 1;
+            continue;
+        }
+
+        for (size_t rateIndex = 0U; rateIndex < rateCount; rateIndex++)
+        {
+            // Power-on state, then the start up of the bootloader
+            SIM_Reset();
+            SYSTICK_TimerInitialize();
+            (void) FTP_Initialize();
+            SIM_LinkInitialize(clock, (uint64_t) pollInterval * 1000U, (uint64_t) latency * 1000U);
+            SIM_LinkFlowControlSet(isFlowControlled);
+
+            // The same faults for every rate and image, so the results only differ by the rate
+            faults.bitErrorRate = bitErrorRates[rateIndex];
+            SIM_LinkFaultsSet(&faults);
+
+            UpdateRun(&imageBuffer[0], imageLength, clock, &result);
+            ResultPrint(label, namePtr, imageLength, clock, &faults, &result);
+
+            if (result.isImageValid == false)
+            {
+                exitCode = 1;
+            }
+        }
+    }
+
+    return exitCode;
+}
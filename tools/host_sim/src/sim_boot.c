@@ -0,0 +1,167 @@
+/**
+ * @file    sim_boot.c
+ * @ingroup mdfu_host_sim
+ * @brief   Runs one start-up of the MI_ARB bootloader on a saved Flash and checks how often the boot
+ *          decision reads each footer and verifies each image space.
+ *
+ * The Flash file written by mdfu_sim_replay_mi_arb --flash-out is loaded and BL_ExampleInitialize
+ * of bl_example.c takes the boot decision with the entry pin released: the staged image is checked
+ * against its target, loaded when the rollback check allows it, and the execution space is
+ * verified. Each run of the tool is one power-up, so the library starts from its reset state. The
+ * Flash is written back to the file afterwards and the next run boots the result of this one.
+ *
+ * The boot decision reads the footer of each image space and calculates its hash at most once.
+ * An image space written during the boot is read and verified again after the copy, so it may be
+ * counted twice.
+ *
+ * Usage:
+ *     mdfu_sim_boot_mi_arb flash.bin
+ *
+ * The exit code is 0 when no image space has been read or verified more often than that.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "bl_core.h"
+#include "bl_image_manager.h"
+#include "bootloader/example/bl_example.h"
+#include "peripheral/systick/plib_systick.h"
+#include "sim_hal.h"
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_RAM_END
+ * @brief End of the RAM the library reaches through fixed addresses: the software entry pattern and the boot time record.
+ */
+#define SIM_RAM_END (BL_BOOT_TRACE_START + sizeof(bl_boot_trace_t))
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_NANOSECONDS_PER_MILLISECOND
+ * @brief Conversion of the virtual clock to the printed times.
+ */
+#define SIM_NANOSECONDS_PER_MILLISECOND (1000000.0)
+
+static uint8_t imageSnapshot[BL_APPLICATION_IMAGE_COUNT][BL_IMAGE_PARTITION_SIZE];
+
+static const char * const bootPhaseNames[BL_BOOT_PHASE_COUNT] = {
+    "SYS_Initialize",
+    "Forced entry check",
+    "Load new image",
+    "Image verify",
+    "Load image backup",
+    "Application start",
+    "FTP start",
+};
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Maps zeroed host memory at the device RAM addresses the library reads and writes directly.
+ *
+ * @param None
+ * @return True - The RAM is mapped at its device address
+ * @return False - The host has placed something else there
+ */
+static bool RamMap(void);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Prints the time stamps of the boot time record.
+ *
+ * @param None
+ * @return True - The boot decision has chosen the application
+ * @return False - The device stays in Boot mode
+ */
+static bool BootTracePrint(void);
+
+static bool RamMap(void)
+{
+    uintptr_t pageSize = (uintptr_t) sysconf(_SC_PAGESIZE);
+    uintptr_t ramStart = (uintptr_t) BL_SOFTWARE_ENTRY_PATTERN_START & ~(pageSize - 1U);
+    size_t ramLength = (size_t)(((uintptr_t) SIM_RAM_END - ramStart + pageSize - 1U) & ~(pageSize - 1U));
+
+    // Only a hint, the address is checked instead of replacing whatever the host placed there
+    void * ramPtr = mmap((void *) ramStart, ramLength, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    return (ramPtr == (void *) ramStart);
+}
+
+static bool BootTracePrint(void)
+{
+    const bl_boot_trace_t * bootTrace = (const bl_boot_trace_t *) (BL_BOOT_TRACE_START);
+
+    for (uint32_t phase = 0U; phase < (uint32_t) BL_BOOT_PHASE_COUNT; phase++)
+    {
+        if ((bootTrace->phaseMask & (1UL << phase)) != 0U)
+        {
+            (void) printf("%-20s: %.3f ms\n", bootPhaseNames[phase], ((double) bootTrace->timeStamp[phase] * 1000.0) / (double) bootTrace->tickFrequency);
+        }
+    }
+
+    // The application start is stamped when the jump is taken, the boot decision only skips the FTP start
+    return ((bootTrace->phaseMask & (1UL << (uint32_t) BL_BOOT_PHASE_FTP_START)) == 0U);
+}
+
+int main(int argc, char ** argv)
+{
+    bool isPassed = true;
+
+    if (argc != 2)
+    {
+        (void) fprintf(stderr, "usage: %s <flash.bin>\n", argv[0]);
+        return 2;
+    }
+    if (RamMap() == false)
+    {
+        (void) fprintf(stderr, "cannot map the RAM at 0x%08X\n", (unsigned int) BL_SOFTWARE_ENTRY_PATTERN_START);
+        return 2;
+    }
+
+    SIM_Reset();
+    if (SIM_FlashLoad(argv[1]) == false)
+    {
+        (void) fprintf(stderr, "cannot read %s\n", argv[1]);
+        return 2;
+    }
+
+    for (uint8_t imageId = 0U; imageId < BL_APPLICATION_IMAGE_COUNT; imageId++)
+    {
+        (void) memcpy(&imageSnapshot[imageId][0], SIM_MemoryGet(BL_ApplicationStartAddressGet(imageId), BL_IMAGE_PARTITION_SIZE), BL_IMAGE_PARTITION_SIZE);
+    }
+
+    // The part of SYS_Initialize and main that runs before the boot decision
+    SYSTICK_TimerInitialize();
+    BL_BootTraceStart();
+    (void) BL_ExampleInitialize();
+
+    bool isApplicationStarted = BootTracePrint();
+
+    for (uint8_t imageId = 0U; imageId < BL_APPLICATION_IMAGE_COUNT; imageId++)
+    {
+        bool isWritten = (memcmp(&imageSnapshot[imageId][0], SIM_MemoryGet(BL_ApplicationStartAddressGet(imageId), BL_IMAGE_PARTITION_SIZE), BL_IMAGE_PARTITION_SIZE) != 0);
+        uint16_t countLimit = isWritten ? 2U : 1U;
+
+        // Reads the footer of an image space the boot decision has not looked at, which stays within the limit
+        const bl_slot_descriptor_t * slotDescriptor = BL_SlotDescriptorGet(imageId);
+        bool isWithinLimit = (slotDescriptor->footerReadCount <= countLimit) && (slotDescriptor->verificationCount <= countLimit);
+
+        (void) printf("Image %u             : %u footer reads, %u verifications%s%s\n", (unsigned int) imageId,
+                (unsigned int) slotDescriptor->footerReadCount, (unsigned int) slotDescriptor->verificationCount,
+                isWritten ? " (written)" : "", isWithinLimit ? "" : " - too many");
+        isPassed = isPassed && isWithinLimit;
+    }
+
+    if (SIM_FlashSave(argv[1]) == false)
+    {
+        (void) fprintf(stderr, "cannot write %s\n", argv[1]);
+        isPassed = false;
+    }
+
+    (void) printf("Boot time           : %.3f ms\n", (double) SIM_TimeGet() / SIM_NANOSECONDS_PER_MILLISECOND);
+    (void) printf("Boot decision       : %s\n", isApplicationStarted ? "application" : "bootloader");
+    (void) printf("Result              : %s\n", isPassed ? "passed" : "failed");
+
+    return isPassed ? 0 : 1;
+}
@@ -0,0 +1,194 @@
+/**
+ * @file    sim_link.c
+ * @ingroup mdfu_host_sim
+ * @brief   Parts of the host link shared by all transports: the device loop, the frame check, the traffic counters and the fault injection.
+ */
+
+#include "bl_ftp.h"
+#include "sim_hal.h"
+#include "sim_link.h"
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_LINK_LOOP_TIME
+ * @brief Time in nanoseconds charged for a pass of the main loop of the device that did not wait on anything.
+ */
+#define SIM_LINK_LOOP_TIME  (1000U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_LINK_DATA_BITS
+ * @brief Data bits of a byte that can be flipped.
+ */
+#define SIM_LINK_DATA_BITS  (8U)
+
+static sim_link_statistics_t linkStatistics;
+static sim_link_faults_t linkFaults = {0.0, 0.0, 0.0, 0.0, 1U};
+static uint64_t randomState = 1U;
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Draws the next value of the fault sequence.
+ *
+ * @param None
+ * @return Random value in the range [0, 1)
+ */
+static double RandomGet(void);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Decides whether a fault with the given rate happens.
+ *
+ * @param[in] rate - Chance of the fault
+ * @return True - The fault happens
+ * @return False - The fault does not happen
+ */
+static bool FaultHappens(double rate);
+
+static double RandomGet(void)
+{
+    // xorshift64*, the 53 upper bits fill the mantissa
+    randomState ^= randomState >> 12;
+    randomState ^= randomState << 25;
+    randomState ^= randomState >> 27;
+
+    return (double) ((randomState * 0x2545F4914F6CDD1DULL) >> 11) / 9007199254740992.0;
+}
+
+static bool FaultHappens(double rate)
+{
+    // A fault that is turned off does not draw, so the sequence of the other faults stays the same
+    return (rate > 0.0) && (RandomGet() < rate);
+}
+
+const sim_link_statistics_t * SIM_LinkStatisticsGet(void)
+{
+    return &linkStatistics;
+}
+
+void SIM_LinkStatisticsClear(void)
+{
+    linkStatistics.hostBytes = 0U;
+    linkStatistics.clientBytes = 0U;
+    linkStatistics.transactions = 0U;
+    linkStatistics.busyPolls = 0U;
+    linkStatistics.wireTime = 0U;
+    linkStatistics.bitFlips = 0U;
+    linkStatistics.droppedBytes = 0U;
+    linkStatistics.truncatedFrames = 0U;
+    linkStatistics.duplicatedFrames = 0U;
+    linkStatistics.holdTime = 0U;
+}
+
+void SIM_LinkTransferCount(size_t hostBytes, size_t clientBytes, uint64_t wireTime)
+{
+    linkStatistics.hostBytes += hostBytes;
+    linkStatistics.clientBytes += clientBytes;
+    linkStatistics.wireTime += wireTime;
+}
+
+void SIM_LinkHoldCount(uint64_t holdTime)
+{
+    linkStatistics.holdTime += holdTime;
+}
+
+void SIM_LinkTransactionCount(bool isBusyPoll)
+{
+    linkStatistics.transactions++;
+    if (isBusyPoll)
+    {
+        linkStatistics.busyPolls++;
+    }
+}
+
+void SIM_LinkFaultsSet(const sim_link_faults_t * faults)
+{
+    linkFaults = *faults;
+
+    // xorshift must not start from 0
+    randomState = (faults->seed != 0U) ? faults->seed : 1U;
+}
+
+size_t SIM_LinkBytesDistort(uint8_t * data, size_t length)
+{
+    size_t keptLength = 0U;
+
+    for (size_t byteIndex = 0U; byteIndex < length; byteIndex++)
+    {
+        if (FaultHappens(linkFaults.byteDropRate))
+        {
+            linkStatistics.droppedBytes++;
+            continue;
+        }
+
+        uint8_t byteValue = data[byteIndex];
+        if (linkFaults.bitErrorRate > 0.0)
+        {
+            for (uint8_t bitIndex = 0U; bitIndex < SIM_LINK_DATA_BITS; bitIndex++)
+            {
+                if (FaultHappens(linkFaults.bitErrorRate))
+                {
+                    byteValue ^= (uint8_t)(1U << bitIndex);
+                    linkStatistics.bitFlips++;
+                }
+            }
+        }
+        data[keptLength] = byteValue;
+        keptLength++;
+    }
+
+    return keptLength;
+}
+
+size_t SIM_LinkFrameLengthDistort(size_t length)
+{
+    size_t sentLength = length;
+
+    if ((length > 1U) && FaultHappens(linkFaults.truncateRate))
+    {
+        sentLength = 1U + (size_t)(RandomGet() * (double)(length - 1U));
+        linkStatistics.truncatedFrames++;
+    }
+
+    return sentLength;
+}
+
+bool SIM_LinkFrameDuplicate(void)
+{
+    bool isDuplicated = FaultHappens(linkFaults.duplicateRate);
+
+    if (isDuplicated)
+    {
+        linkStatistics.duplicatedFrames++;
+    }
+
+    return isDuplicated;
+}
+
+void SIM_LinkDeviceRun(uint64_t endTime)
+{
+    while (SIM_TimeGet() < endTime)
+    {
+        uint64_t loopStartTime = SIM_TimeGet();
+
+        (void) FTP_Task();
+
+        // The clock only moves while the device waits, a pass without a wait still takes some time
+        if (SIM_TimeGet() == loopStartTime)
+        {
+            SIM_TimeAdvance(SIM_LINK_LOOP_TIME);
+        }
+    }
+}
+
+uint16_t SIM_LinkFrameCheckCalculate(const uint8_t * data, size_t length)
+{
+    uint32_t checksum = 0U;
+
+    for (size_t byteIndex = 0U; byteIndex < length; byteIndex++)
+    {
+        checksum += ((byteIndex & 1U) == 0U) ? (uint32_t) data[byteIndex] : ((uint32_t) data[byteIndex] << 8);
+    }
+
+    return (uint16_t)(~checksum);
+}
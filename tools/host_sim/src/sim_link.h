@@ -0,0 +1,261 @@
+/**
+ * @file    sim_link.h
+ * @ingroup mdfu_host_sim
+ * @brief   Host end of the serial link to the simulated device, used by the benchmark.
+ *
+ * Each transport has its own implementation of the framing, sim_link_<transport>.c next to the
+ * stand-in of the device peripheral in hal/sim_<transport>.c. While the host waits, the device
+ * runs its main loop, so every command goes through FTP_Task, COM_FrameTransfer and the core as
+ * on the target. The time the bytes take on the wire is charged on the virtual clock.
+ *
+ * Faults can be injected on the wire. Bit flips and lost bytes hit the bytes of both directions
+ * after the device has sent them or before it receives them. Cut off and repeated frames hit
+ * the commands of the host.
+ */
+#ifndef SIM_LINK_H
+#define SIM_LINK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_LINK_NANOSECONDS_PER_SECOND
+ * @brief Conversion of the link clock to the virtual clock.
+ */
+#define SIM_LINK_NANOSECONDS_PER_SECOND (1000000000U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @struct sim_link_statistics_t
+ * @brief Traffic on the link since the last @ref SIM_LinkInitialize.
+ * @var sim_link_statistics_t:: hostBytes
+ * Member 'hostBytes' contains the number of bytes sent by the host, including framing and polls
+ * @var sim_link_statistics_t:: clientBytes
+ * Member 'clientBytes' contains the number of bytes sent by the device, including framing
+ * @var sim_link_statistics_t:: transactions
+ * Member 'transactions' contains the number of frames or bus transactions started by the host
+ * @var sim_link_statistics_t:: busyPolls
+ * Member 'busyPolls' contains the number of polls that found no response ready
+ * @var sim_link_statistics_t:: wireTime
+ * Member 'wireTime' contains the time in nanoseconds the link has been transferring data
+ * @var sim_link_statistics_t:: bitFlips
+ * Member 'bitFlips' contains the number of bits flipped by the injected faults
+ * @var sim_link_statistics_t:: droppedBytes
+ * Member 'droppedBytes' contains the number of bytes lost by the injected faults
+ * @var sim_link_statistics_t:: truncatedFrames
+ * Member 'truncatedFrames' contains the number of command frames cut off by the injected faults
+ * @var sim_link_statistics_t:: duplicatedFrames
+ * Member 'duplicatedFrames' contains the number of command frames sent twice by the injected faults
+ * @var sim_link_statistics_t:: holdTime
+ * Member 'holdTime' contains the time in nanoseconds the device has held off bytes of the host with flow control
+ */
+typedef struct
+{
+    uint64_t hostBytes;
+    uint64_t clientBytes;
+    uint32_t transactions;
+    uint32_t busyPolls;
+    uint64_t wireTime;
+    uint32_t bitFlips;
+    uint32_t droppedBytes;
+    uint32_t truncatedFrames;
+    uint32_t duplicatedFrames;
+    uint64_t holdTime;
+} sim_link_statistics_t;
+
+/**
+ * @ingroup mdfu_host_sim
+ * @struct sim_link_faults_t
+ * @brief Faults injected on the link. A rate of 0 turns the fault off.
+ * @var sim_link_faults_t:: bitErrorRate
+ * Member 'bitErrorRate' contains the chance of each data bit to flip, in both directions
+ * @var sim_link_faults_t:: byteDropRate
+ * Member 'byteDropRate' contains the chance of each byte to be lost, in both directions
+ * @var sim_link_faults_t:: truncateRate
+ * Member 'truncateRate' contains the chance of a command frame to be cut off before its end
+ * @var sim_link_faults_t:: duplicateRate
+ * Member 'duplicateRate' contains the chance of a command frame to be sent a second time
+ * @var sim_link_faults_t:: seed
+ * Member 'seed' contains the start value of the random faults, the same seed gives the same faults
+ */
+typedef struct
+{
+    double bitErrorRate;
+    double byteDropRate;
+    double truncateRate;
+    double duplicateRate;
+    uint64_t seed;
+} sim_link_faults_t;
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Returns the default clock of the link.
+ *
+ * @param None
+ * @return Baud rate of a USART, or SCK or SCL frequency of a bus, in Hz
+ */
+uint32_t SIM_LinkDefaultClockGet(void);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Sets up the link and clears its statistics, called after the device has been initialized.
+ *
+ * @param[in] clock - Baud rate of a USART, or SCK or SCL frequency of a bus, in Hz
+ * @param[in] pollInterval - Time in nanoseconds the host waits before each transaction of a bus
+ * @param[in] latency - Time in nanoseconds a USB bridge between the host and the wire holds the data in each direction
+ * @return None
+ */
+void SIM_LinkInitialize(uint32_t clock, uint64_t pollInterval, uint64_t latency);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Changes the clock of the host end of the link, for example after the client has confirmed a new baud rate.
+ *
+ * @param[in] clock - Baud rate of a USART, or SCK or SCL frequency of a bus, in Hz
+ * @return None
+ */
+void SIM_LinkClockSet(uint32_t clock);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Makes the host end of the link follow the flow control of the device, called after @ref SIM_LinkInitialize.
+ *
+ * Only a UART has flow control: the USB bridge then waits with each byte while RTS of the device holds it off.
+ * The buses ignore the setting.
+ *
+ * @param[in] isEnabled - The host honors the RTS line of the device
+ * @return None
+ */
+void SIM_LinkFlowControlSet(bool isEnabled);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Frames an FTP packet and sends it to the device.
+ *
+ * @param[in] packet - FTP packet, sequence byte first
+ * @param[in] length - Length of the packet
+ * @return True - The device has taken the whole frame
+ * @return False - The device has not taken the frame in time
+ */
+bool SIM_LinkCommandSend(const uint8_t * packet, size_t length);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Waits for the next response of the device and checks its frame.
+ *
+ * @param[out] packet - Buffer for the FTP response, sequence byte first
+ * @param[in] size - Size of the buffer
+ * @param[out] length - Length of the response
+ * @param[in] timeout - Time in nanoseconds to wait for the response, 0 only takes a response that has already arrived
+ * @return True - A response with a valid frame check has been received
+ * @return False - No response has been received in time, or the response has a wrong frame check
+ */
+bool SIM_LinkResponseReceive(uint8_t * packet, size_t size, size_t * length, uint64_t timeout);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Returns the traffic on the link.
+ *
+ * @param None
+ * @return Pointer to the statistics
+ */
+const sim_link_statistics_t * SIM_LinkStatisticsGet(void);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Clears the traffic on the link, used by the implementation of @ref SIM_LinkInitialize.
+ *
+ * @param None
+ * @return None
+ */
+void SIM_LinkStatisticsClear(void);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Counts the bytes of a transfer and the time they took on the wire.
+ *
+ * @param[in] hostBytes - Bytes sent by the host
+ * @param[in] clientBytes - Bytes sent by the device
+ * @param[in] wireTime - Time on the wire in nanoseconds
+ * @return None
+ */
+void SIM_LinkTransferCount(size_t hostBytes, size_t clientBytes, uint64_t wireTime);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Counts the time the device has held off bytes of the host.
+ *
+ * @param[in] holdTime - Time in nanoseconds
+ * @return None
+ */
+void SIM_LinkHoldCount(uint64_t holdTime);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Counts a transaction of the host, a poll that found no response when requested.
+ *
+ * @param[in] isBusyPoll - The transaction was a poll without a response
+ * @return None
+ */
+void SIM_LinkTransactionCount(bool isBusyPoll);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Sets the faults injected on the link and restarts their random sequence, called after @ref SIM_LinkInitialize.
+ *
+ * @param[in] faults - Fault rates and seed
+ * @return None
+ */
+void SIM_LinkFaultsSet(const sim_link_faults_t * faults);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Flips bits and drops bytes of data on the wire, used by the implementation of each transport.
+ *
+ * @param[in,out] data - Bytes on the wire, the bytes that are not lost are moved to the front
+ * @param[in] length - Number of bytes
+ * @return Number of bytes that are not lost
+ */
+size_t SIM_LinkBytesDistort(uint8_t * data, size_t length);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Decides whether a command frame is cut off, used by the implementation of each transport.
+ *
+ * @param[in] length - Number of bytes of the frame
+ * @return Number of bytes that are sent, at least one
+ */
+size_t SIM_LinkFrameLengthDistort(size_t length);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Decides whether a command frame is sent a second time, used by the implementation of each transport.
+ *
+ * @param None
+ * @return True - The frame is sent again right after the first time
+ * @return False - The frame is sent once
+ */
+bool SIM_LinkFrameDuplicate(void);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Runs the main loop of the device until the virtual clock reaches the given time.
+ *
+ * @param[in] endTime - Virtual time in nanoseconds
+ * @return None
+ */
+void SIM_LinkDeviceRun(uint64_t endTime);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Calculates the MDFU frame check: the ones' complement of the sum of little endian 16-bit words.
+ *
+ * @param[in] data - Bytes to check
+ * @param[in] length - Number of bytes, an odd last byte is the low half of a word
+ * @return Frame check sequence
+ */
+uint16_t SIM_LinkFrameCheckCalculate(const uint8_t * data, size_t length);
+
+#endif // SIM_LINK_H
@@ -0,0 +1,193 @@
+/**
+ * @file    sim_link_i2c.c
+ * @ingroup mdfu_host_sim
+ * @brief   Host end of the I2C transport.
+ *
+ * A command is a write transaction of the packet and its frame check. The device does not
+ * acknowledge its address while it processes a command, so the host polls with read
+ * transactions for the length stage and then reads the response stage. The host waits for the
+ * poll interval before each transaction.
+ */
+
+#include <string.h>
+#include "sim_hal.h"
+#include "sim_link.h"
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_LINK_LENGTH_STAGE_SIZE
+ * @brief Size of the length stage: prefix, length and its frame check.
+ */
+#define SIM_LINK_LENGTH_STAGE_SIZE  (5U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_LINK_BYTE_BITS
+ * @brief Clock cycles of one byte on the bus: eight data bits and the acknowledge bit.
+ */
+#define SIM_LINK_BYTE_BITS          (9U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_LINK_FRAMING_BITS
+ * @brief Clock cycles taken by the start and the stop condition of a transaction.
+ */
+#define SIM_LINK_FRAMING_BITS       (2U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_LINK_BUFFER_SIZE
+ * @brief Size of the largest transaction of the host.
+ */
+#define SIM_LINK_BUFFER_SIZE        (1024U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_LINK_DEFAULT_SCL
+ * @brief SCL frequency used when none is given.
+ */
+#define SIM_LINK_DEFAULT_SCL        (100000U)
+
+static uint32_t sclFrequency = SIM_LINK_DEFAULT_SCL;
+static uint64_t transactionGap = 0U;
+static uint64_t transactionLatency = 0U;
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Waits for the poll interval, then runs one transaction and charges its time on the bus.
+ *
+ * @param[in,out] data - Bytes written by the host, or buffer for the bytes read
+ * @param[in] length - Number of bytes after the address
+ * @param[in] isRead - The host reads from the device
+ * @return True - The device has acknowledged its address
+ * @return False - The device has not acknowledged its address, only the address took time
+ */
+static bool TransactionRun(uint8_t * data, size_t length, bool isRead);
+
+static bool TransactionRun(uint8_t * data, size_t length, bool isRead)
+{
+    static uint8_t lineData[SIM_LINK_BUFFER_SIZE];
+    bool isAcknowledged = false;
+
+    // A USB bridge runs each transaction on its own, its latency is paid both ways every time
+    SIM_LinkDeviceRun(SIM_TimeGet() + transactionGap + transactionLatency);
+
+    if (isRead)
+    {
+        isAcknowledged = SIM_I2cRead(data, length);
+
+        // The bytes after a lost one move up, the end of the transaction reads the released bus
+        size_t keptLength = isAcknowledged ? SIM_LinkBytesDistort(data, length) : length;
+        (void) memset(&data[keptLength], 0xFF, length - keptLength);
+    }
+    else
+    {
+        (void) memcpy(&lineData[0], data, length);
+        isAcknowledged = SIM_I2cWrite(&lineData[0], SIM_LinkBytesDistort(&lineData[0], length));
+    }
+
+    // A transaction that is not acknowledged ends after the address
+    size_t byteCount = isAcknowledged ? length : 0U;
+    uint64_t wireTime = ((((uint64_t) byteCount + 1U) * SIM_LINK_BYTE_BITS) + SIM_LINK_FRAMING_BITS) * SIM_LINK_NANOSECONDS_PER_SECOND / sclFrequency;
+
+    SIM_TimeAdvance(wireTime);
+    SIM_LinkTransferCount(isRead ? 1U : (byteCount + 1U), isRead ? byteCount : 0U, wireTime);
+
+    return isAcknowledged;
+}
+
+uint32_t SIM_LinkDefaultClockGet(void)
+{
+    return SIM_LINK_DEFAULT_SCL;
+}
+
+void SIM_LinkInitialize(uint32_t clock, uint64_t pollInterval, uint64_t latency)
+{
+    sclFrequency = clock;
+    transactionGap = pollInterval;
+    transactionLatency = 2U * latency;
+    SIM_LinkStatisticsClear();
+}
+
+void SIM_LinkClockSet(uint32_t clock)
+{
+    sclFrequency = clock;
+}
+
+void SIM_LinkFlowControlSet(bool isEnabled)
+{
+    // There are no flow control lines on the bus, the host polls the client
+    (void) isEnabled;
+}
+
+bool SIM_LinkCommandSend(const uint8_t * packet, size_t length)
+{
+    static uint8_t hostData[SIM_LINK_BUFFER_SIZE];
+    bool isSent = false;
+
+    if ((length + 2U) <= SIM_LINK_BUFFER_SIZE)
+    {
+        uint16_t frameCheck = SIM_LinkFrameCheckCalculate(packet, length);
+
+        (void) memcpy(&hostData[0], packet, length);
+        hostData[length] = (uint8_t) frameCheck;
+        hostData[length + 1U] = (uint8_t)(frameCheck >> 8);
+
+        bool isDuplicated = SIM_LinkFrameDuplicate();
+
+        SIM_LinkTransactionCount(false);
+        isSent = TransactionRun(&hostData[0], SIM_LinkFrameLengthDistort(length + 2U), false);
+        if (isDuplicated)
+        {
+            // The device does not acknowledge the copy while it processes the first one
+            SIM_LinkTransactionCount(false);
+            (void) TransactionRun(&hostData[0], length + 2U, false);
+        }
+    }
+
+    return isSent;
+}
+
+bool SIM_LinkResponseReceive(uint8_t * packet, size_t size, size_t * length, uint64_t timeout)
+{
+    static uint8_t clientData[SIM_LINK_BUFFER_SIZE];
+    uint64_t endTime = SIM_TimeGet() + timeout;
+    size_t readLength = 0U;
+    bool isReceived = false;
+
+    // Poll for the length stage, the address is not acknowledged until the response is ready
+    while ((readLength == 0U) && (SIM_TimeGet() < endTime))
+    {
+        bool isLengthValid = TransactionRun(&clientData[0], SIM_LINK_LENGTH_STAGE_SIZE, true);
+        uint16_t frameCheck = (uint16_t)((uint16_t) clientData[3] | ((uint16_t) clientData[4] << 8));
+
+        isLengthValid = isLengthValid && (clientData[0] == (uint8_t)'L') && (SIM_LinkFrameCheckCalculate(&clientData[1], 2U) == frameCheck);
+
+        SIM_LinkTransactionCount(isLengthValid == false);
+        if (isLengthValid)
+        {
+            readLength = (size_t) clientData[1] | ((size_t) clientData[2] << 8);
+        }
+    }
+
+    // The length counts the response and its frame check, the stage starts with its prefix
+    if ((readLength > 2U) && ((readLength - 2U) <= size) && ((readLength + 1U) <= SIM_LINK_BUFFER_SIZE))
+    {
+        size_t responseLength = readLength - 2U;
+
+        SIM_LinkTransactionCount(false);
+        if (TransactionRun(&clientData[0], readLength + 1U, true))
+        {
+            uint16_t frameCheck = (uint16_t)((uint16_t) clientData[1U + responseLength] | ((uint16_t) clientData[2U + responseLength] << 8));
+
+            if ((clientData[0] == (uint8_t)'R') && (SIM_LinkFrameCheckCalculate(&clientData[1], responseLength) == frameCheck))
+            {
+                (void) memcpy(packet, &clientData[1], responseLength);
+                *length = responseLength;
+                isReceived = true;
+            }
+        }
+    }
+
+    return isReceived;
+}
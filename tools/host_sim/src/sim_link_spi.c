@@ -0,0 +1,205 @@
+/**
+ * @file    sim_link_spi.c
+ * @ingroup mdfu_host_sim
+ * @brief   Host end of the SPI transport.
+ *
+ * A command is a write transaction: the write code, the packet and its frame check. The host
+ * then polls with read transactions for the length stage, followed by one read transaction for
+ * the response stage. The host waits for the poll interval before each transaction, so the device
+ * can process the end of the previous one and arm the next stage.
+ */
+
+#include <string.h>
+#include "sim_hal.h"
+#include "sim_link.h"
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_LINK_WRITE_CODE
+ * @brief First byte of a transaction that carries a command.
+ */
+#define SIM_LINK_WRITE_CODE         (0x11U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_LINK_READ_CODE
+ * @brief First byte of a transaction that reads a stage of the response.
+ */
+#define SIM_LINK_READ_CODE          (0x55U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_LINK_PREFIX_SIZE
+ * @brief Size of the start sequence of the length and of the response stage.
+ */
+#define SIM_LINK_PREFIX_SIZE        (4U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_LINK_LENGTH_STAGE_SIZE
+ * @brief Size of the length stage: start sequence, length and its frame check.
+ */
+#define SIM_LINK_LENGTH_STAGE_SIZE  (SIM_LINK_PREFIX_SIZE + 4U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_LINK_BUFFER_SIZE
+ * @brief Size of the largest transaction of the host.
+ */
+#define SIM_LINK_BUFFER_SIZE        (1024U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_LINK_DEFAULT_SCK
+ * @brief SCK frequency used when none is given.
+ */
+#define SIM_LINK_DEFAULT_SCK        (1000000U)
+
+static uint32_t sckFrequency = SIM_LINK_DEFAULT_SCK;
+static uint64_t transactionGap = 0U;
+static uint64_t transactionLatency = 0U;
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Waits for the poll interval, then runs one transaction and charges its time on the wire.
+ *
+ * @param[in] hostData - Bytes shifted out by the host
+ * @param[out] clientData - Bytes shifted out by the device, NULL for a write transaction
+ * @param[in] length - Number of bytes of the transaction
+ * @return None
+ */
+static void TransactionRun(const uint8_t * hostData, uint8_t * clientData, size_t length);
+
+static void TransactionRun(const uint8_t * hostData, uint8_t * clientData, size_t length)
+{
+    static uint8_t lineData[SIM_LINK_BUFFER_SIZE];
+    uint64_t wireTime = ((uint64_t) length * 8U * SIM_LINK_NANOSECONDS_PER_SECOND) / sckFrequency;
+
+    // A USB bridge runs each transaction on its own, its latency is paid both ways every time
+    SIM_LinkDeviceRun(SIM_TimeGet() + transactionGap + transactionLatency);
+
+    // Only one direction carries data, a read is the read code followed by the bytes of the device
+    if (clientData == NULL)
+    {
+        // The DMAC moves the bytes, the device only sees the transaction after the chip select is released
+        (void) memcpy(&lineData[0], hostData, length);
+        SIM_SpiTransfer(&lineData[0], NULL, SIM_LinkBytesDistort(&lineData[0], length));
+        SIM_TimeAdvance(wireTime);
+        SIM_LinkTransferCount(length, 0U, wireTime);
+    }
+    else
+    {
+        SIM_SpiTransfer(hostData, clientData, length);
+        SIM_TimeAdvance(wireTime);
+        SIM_LinkTransferCount(1U, length - 1U, wireTime);
+
+        // The bytes after a lost one move up, the end of the transaction reads the idle line
+        size_t keptLength = SIM_LinkBytesDistort(clientData, length);
+        (void) memset(&clientData[keptLength], 0xFF, length - keptLength);
+    }
+}
+
+uint32_t SIM_LinkDefaultClockGet(void)
+{
+    return SIM_LINK_DEFAULT_SCK;
+}
+
+void SIM_LinkInitialize(uint32_t clock, uint64_t pollInterval, uint64_t latency)
+{
+    sckFrequency = clock;
+    transactionGap = pollInterval;
+    transactionLatency = 2U * latency;
+    SIM_LinkStatisticsClear();
+}
+
+void SIM_LinkClockSet(uint32_t clock)
+{
+    sckFrequency = clock;
+}
+
+void SIM_LinkFlowControlSet(bool isEnabled)
+{
+    // The host polls for the response, there is nothing to hold off
+    (void) isEnabled;
+}
+
+bool SIM_LinkCommandSend(const uint8_t * packet, size_t length)
+{
+    static uint8_t hostData[SIM_LINK_BUFFER_SIZE];
+    bool isSent = false;
+
+    if ((length + 3U) <= SIM_LINK_BUFFER_SIZE)
+    {
+        uint16_t frameCheck = SIM_LinkFrameCheckCalculate(packet, length);
+
+        hostData[0] = SIM_LINK_WRITE_CODE;
+        (void) memcpy(&hostData[1], packet, length);
+        hostData[length + 1U] = (uint8_t) frameCheck;
+        hostData[length + 2U] = (uint8_t)(frameCheck >> 8);
+
+        bool isDuplicated = SIM_LinkFrameDuplicate();
+
+        SIM_LinkTransactionCount(false);
+        TransactionRun(&hostData[0], NULL, SIM_LinkFrameLengthDistort(length + 3U));
+        if (isDuplicated)
+        {
+            SIM_LinkTransactionCount(false);
+            TransactionRun(&hostData[0], NULL, length + 3U);
+        }
+        isSent = true;
+    }
+
+    return isSent;
+}
+
+bool SIM_LinkResponseReceive(uint8_t * packet, size_t size, size_t * length, uint64_t timeout)
+{
+    static const uint8_t lengthPrefix[SIM_LINK_PREFIX_SIZE] = {0x00U, (uint8_t)'L', (uint8_t)'E', (uint8_t)'N'};
+    static const uint8_t responsePrefix[SIM_LINK_PREFIX_SIZE] = {0x00U, (uint8_t)'R', (uint8_t)'S', (uint8_t)'P'};
+    static uint8_t hostData[SIM_LINK_BUFFER_SIZE];
+    static uint8_t clientData[SIM_LINK_BUFFER_SIZE];
+    uint64_t endTime = SIM_TimeGet() + timeout;
+    size_t readLength = 0U;
+    bool isReceived = false;
+
+    (void) memset(&hostData[0], 0xFF, sizeof(hostData));
+    hostData[0] = SIM_LINK_READ_CODE;
+
+    // Poll for the length stage, the device shifts out the idle value until the response is ready
+    while ((readLength == 0U) && (SIM_TimeGet() < endTime))
+    {
+        TransactionRun(&hostData[0], &clientData[0], SIM_LINK_LENGTH_STAGE_SIZE);
+
+        uint16_t frameCheck = (uint16_t)((uint16_t) clientData[6] | ((uint16_t) clientData[7] << 8));
+        bool isLengthValid = ((memcmp(&clientData[0], &lengthPrefix[0], SIM_LINK_PREFIX_SIZE) == 0)
+                && (SIM_LinkFrameCheckCalculate(&clientData[4], 2U) == frameCheck));
+
+        SIM_LinkTransactionCount(isLengthValid == false);
+        if (isLengthValid)
+        {
+            readLength = (size_t) clientData[4] | ((size_t) clientData[5] << 8);
+        }
+    }
+
+    // The length counts the response and its frame check
+    if ((readLength > 2U) && ((readLength - 2U) <= size) && ((SIM_LINK_PREFIX_SIZE + readLength) <= SIM_LINK_BUFFER_SIZE))
+    {
+        size_t responseLength = readLength - 2U;
+
+        SIM_LinkTransactionCount(false);
+        TransactionRun(&hostData[0], &clientData[0], SIM_LINK_PREFIX_SIZE + readLength);
+
+        uint16_t frameCheck = (uint16_t)((uint16_t) clientData[SIM_LINK_PREFIX_SIZE + responseLength]
+                | ((uint16_t) clientData[SIM_LINK_PREFIX_SIZE + responseLength + 1U] << 8));
+
+        if ((memcmp(&clientData[0], &responsePrefix[0], SIM_LINK_PREFIX_SIZE) == 0)
+                && (SIM_LinkFrameCheckCalculate(&clientData[SIM_LINK_PREFIX_SIZE], responseLength) == frameCheck))
+        {
+            (void) memcpy(packet, &clientData[SIM_LINK_PREFIX_SIZE], responseLength);
+            *length = responseLength;
+            isReceived = true;
+        }
+    }
+
+    return isReceived;
+}
@@ -0,0 +1,491 @@
+/**
+ * @file    sim_link_usart.c
+ * @ingroup mdfu_host_sim
+ * @brief   Host end of the UART transport, used by the UART and MI_ARB projects.
+ *
+ * A frame is the start of packet code, the packet and its frame check with the special codes
+ * escaped, and the end of packet code. The host bytes reach the receive ring buffer of the device
+ * one at a time at the baud rate, while the device keeps running its main loop.
+ *
+ * A USB serial bridge holds the bytes for a while in each direction. The line keeps the bytes of
+ * both directions in queues until their latency has passed, so the host can send the next
+ * frames while the earlier ones are still on their way.
+ *
+ * With flow control, the bridge only puts the next byte on the wire while RTS of the device lets
+ * it. The bytes held back go out one byte time after the other once RTS comes back.
+ */
+
+#include <string.h>
+#include "sim_hal.h"
+#include "sim_link.h"
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_LINK_START_OF_PACKET
+ * @brief Code that starts every frame.
+ */
+#define SIM_LINK_START_OF_PACKET    (0x56U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_LINK_END_OF_PACKET
+ * @brief Code that ends every frame.
+ */
+#define SIM_LINK_END_OF_PACKET      (0x9EU)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_LINK_ESCAPE
+ * @brief Code sent before the complement of a byte that equals one of the special codes.
+ */
+#define SIM_LINK_ESCAPE             (0xCCU)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_LINK_FRAME_BITS
+ * @brief Bits on the line for one byte: start bit, eight data bits and stop bit.
+ */
+#define SIM_LINK_FRAME_BITS         (10U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_LINK_DEFAULT_BAUD_RATE
+ * @brief Baud rate used when none is given.
+ */
+#define SIM_LINK_DEFAULT_BAUD_RATE  (115200U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_LINK_BUFFER_SIZE
+ * @brief Size of the largest frame of the host, every byte of the packet escaped.
+ */
+#define SIM_LINK_BUFFER_SIZE        (2048U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_LINK_QUEUE_SIZE
+ * @brief Number of bytes each direction of the line can hold in flight.
+ */
+#define SIM_LINK_QUEUE_SIZE         (16384U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @struct sim_link_queue_t
+ * @brief Bytes on their way in one direction of the line, oldest first.
+ * @var sim_link_queue_t:: arrivalTime
+ * Member 'arrivalTime' contains the virtual time each byte reaches the other end
+ * @var sim_link_queue_t:: data
+ * Member 'data' contains the bytes
+ * @var sim_link_queue_t:: head
+ * Member 'head' contains the index of the oldest byte
+ * @var sim_link_queue_t:: count
+ * Member 'count' contains the number of bytes in the queue
+ */
+typedef struct
+{
+    uint64_t arrivalTime[SIM_LINK_QUEUE_SIZE];
+    uint8_t data[SIM_LINK_QUEUE_SIZE];
+    size_t head;
+    size_t count;
+} sim_link_queue_t;
+
+/**
+ * @ingroup mdfu_host_sim
+ * @struct sim_link_parser_t
+ * @brief State of the response frame being received, kept between the calls of @ref SIM_LinkResponseReceive.
+ * @var sim_link_parser_t:: frame
+ * Member 'frame' contains the unescaped bytes of the frame
+ * @var sim_link_parser_t:: frameLength
+ * Member 'frameLength' contains the number of bytes in the frame
+ * @var sim_link_parser_t:: isInFrame
+ * Member 'isInFrame' is set after a start of packet code
+ * @var sim_link_parser_t:: isEscaped
+ * Member 'isEscaped' is set after an escape code
+ */
+typedef struct
+{
+    uint8_t frame[SIM_LINK_BUFFER_SIZE];
+    size_t frameLength;
+    bool isInFrame;
+    bool isEscaped;
+} sim_link_parser_t;
+
+static uint64_t byteTime = 0U;
+static uint64_t lineLatency = 0U;
+static sim_link_queue_t hostQueue;
+static sim_link_queue_t clientQueue;
+static sim_link_parser_t responseParser;
+static bool isFlowControlEnabled = false;
+static uint64_t lineFreeTime = 0U;
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Adds a byte to a direction of the line.
+ *
+ * @param[in,out] queue - Direction of the line
+ * @param[in] data - Byte to add
+ * @param[in] arrivalTime - Virtual time the byte reaches the other end
+ * @return True - The byte has been added
+ * @return False - The queue is full, the byte is lost
+ */
+static bool QueuePut(sim_link_queue_t * queue, uint8_t data, uint64_t arrivalTime);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Takes the oldest byte from a direction of the line once it has arrived.
+ *
+ * @param[in,out] queue - Direction of the line
+ * @param[out] data - Byte taken
+ * @return True - A byte has arrived
+ * @return False - No byte has arrived yet
+ */
+static bool QueueGet(sim_link_queue_t * queue, uint8_t * data);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Takes the next byte of the host that reaches the device, following RTS with flow control.
+ *
+ * @param[out] data - Byte taken
+ * @return True - A byte has reached the device
+ * @return False - No byte has arrived yet, or the device holds off the host
+ */
+static bool HostByteGet(uint8_t * data);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Runs the device until the given time, passing the bytes of the line as they arrive.
+ *
+ * @param[in] endTime - Virtual time in nanoseconds
+ * @return None
+ */
+static void LineRun(uint64_t endTime);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Adds one received byte to the response frame.
+ *
+ * @param[in] data - Byte read from the line
+ * @return True - The byte has ended a frame
+ * @return False - The frame goes on
+ */
+static bool ResponseByteParse(uint8_t data);
+
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Sends one byte of a frame once the previous one has left the line.
+ *
+ * @param[in] data - Byte to send
+ * @return True - The byte has been queued by the device, or has been lost on the line
+ * @return False - The receive ring buffer of the device is full, the byte is lost
+ */
+static bool ByteSend(uint8_t data);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Adds one byte of the packet or the frame check to a frame, escaped when needed.
+ *
+ * @param[out] frame - Frame being built
+ * @param[in] frameLength - Number of bytes already in the frame
+ * @param[in] data - Byte to add
+ * @return Number of bytes in the frame
+ */
+static size_t DataByteAdd(uint8_t * frame, size_t frameLength, uint8_t data);
+
+static bool QueuePut(sim_link_queue_t * queue, uint8_t data, uint64_t arrivalTime)
+{
+    bool isAdded = (queue->count < SIM_LINK_QUEUE_SIZE);
+
+    if (isAdded)
+    {
+        size_t tail = (queue->head + queue->count) % SIM_LINK_QUEUE_SIZE;
+
+        queue->data[tail] = data;
+        queue->arrivalTime[tail] = arrivalTime;
+        queue->count++;
+    }
+
+    return isAdded;
+}
+
+static bool QueueGet(sim_link_queue_t * queue, uint8_t * data)
+{
+    bool hasArrived = (queue->count > 0U) && (queue->arrivalTime[queue->head] <= SIM_TimeGet());
+
+    if (hasArrived)
+    {
+        *data = queue->data[queue->head];
+        queue->head = (queue->head + 1U) % SIM_LINK_QUEUE_SIZE;
+        queue->count--;
+    }
+
+    return hasArrived;
+}
+
+static bool HostByteGet(uint8_t * data)
+{
+    bool isTaken = false;
+
+    if (isFlowControlEnabled == false)
+    {
+        isTaken = QueueGet(&hostQueue, data);
+    }
+    else if (SIM_UsartHostClearToSend() == false)
+    {
+        // The bridge checks RTS before each byte, the next one cannot end before a byte time after RTS comes back
+        lineFreeTime = SIM_TimeGet() + byteTime;
+    }
+    else if ((hostQueue.count > 0U) && (lineFreeTime <= SIM_TimeGet()))
+    {
+        uint64_t arrivalTime = hostQueue.arrivalTime[hostQueue.head];
+
+        isTaken = QueueGet(&hostQueue, data);
+        if (isTaken)
+        {
+            lineFreeTime = ((arrivalTime > lineFreeTime) ? arrivalTime : lineFreeTime) + byteTime;
+        }
+    }
+    else
+    {
+        // The line is still busy with the previous byte
+    }
+
+    return isTaken;
+}
+
+static void LineRun(uint64_t endTime)
+{
+    do
+    {
+        uint8_t data = 0U;
+
+        // A full receive ring buffer of the device loses the byte, as an overrun would
+        while (HostByteGet(&data))
+        {
+            (void) SIM_UsartHostWrite(&data, 1U);
+        }
+
+        // Stop at the next byte of the host, so it reaches the device in time
+        uint64_t stepTime = endTime;
+        bool isHeldOff = (hostQueue.count > 0U) && isFlowControlEnabled && (SIM_UsartHostClearToSend() == false);
+        if (hostQueue.count > 0U)
+        {
+            uint64_t nextTime = hostQueue.arrivalTime[hostQueue.head];
+
+            // Look at RTS again after a byte time while the device holds off the host
+            if (isFlowControlEnabled)
+            {
+                nextTime = isHeldOff ? lineFreeTime : ((nextTime > lineFreeTime) ? nextTime : lineFreeTime);
+            }
+            stepTime = (nextTime < stepTime) ? nextTime : stepTime;
+        }
+
+        uint64_t startTime = SIM_TimeGet();
+        SIM_LinkDeviceRun(stepTime);
+        if (isHeldOff)
+        {
+            SIM_LinkHoldCount(SIM_TimeGet() - startTime);
+        }
+
+        // Take the bytes of the device whose stop bit has ended by now
+        while (SIM_UsartHostRead(&data, 1U) == 1U)
+        {
+            (void) QueuePut(&clientQueue, data, SIM_TimeGet() + lineLatency);
+        }
+    } while (SIM_TimeGet() < endTime);
+}
+
+static bool ResponseByteParse(uint8_t data)
+{
+    bool isFrameEnded = false;
+
+    if (data == SIM_LINK_START_OF_PACKET)
+    {
+        responseParser.isInFrame = true;
+        responseParser.isEscaped = false;
+        responseParser.frameLength = 0U;
+    }
+    else if (responseParser.isInFrame == false)
+    {
+        // Noise between frames
+    }
+    else if (data == SIM_LINK_END_OF_PACKET)
+    {
+        responseParser.isInFrame = false;
+        isFrameEnded = true;
+    }
+    else if (data == SIM_LINK_ESCAPE)
+    {
+        responseParser.isEscaped = true;
+    }
+    else if (responseParser.frameLength < SIM_LINK_BUFFER_SIZE)
+    {
+        responseParser.frame[responseParser.frameLength] = responseParser.isEscaped ? (uint8_t)(~data) : data;
+        responseParser.isEscaped = false;
+        responseParser.frameLength++;
+    }
+    else
+    {
+        // A frame longer than the buffer cannot be a response
+        responseParser.isInFrame = false;
+    }
+
+    return isFrameEnded;
+}
+
+static bool ByteSend(uint8_t data)
+{
+    uint8_t lineData = data;
+    bool isQueued = true;
+
+    // The device keeps running while the byte is on the wire
+    LineRun(SIM_TimeGet() + byteTime);
+    SIM_LinkTransferCount(1U, 0U, byteTime);
+
+    if (SIM_LinkBytesDistort(&lineData, 1U) == 1U)
+    {
+        isQueued = QueuePut(&hostQueue, lineData, SIM_TimeGet() + lineLatency);
+        LineRun(SIM_TimeGet());
+    }
+
+    return isQueued;
+}
+
+static size_t DataByteAdd(uint8_t * frame, size_t frameLength, uint8_t data)
+{
+    size_t nextLength = frameLength;
+
+    if ((data == SIM_LINK_START_OF_PACKET) || (data == SIM_LINK_END_OF_PACKET) || (data == SIM_LINK_ESCAPE))
+    {
+        frame[nextLength] = SIM_LINK_ESCAPE;
+        nextLength++;
+        data = (uint8_t)(~data);
+    }
+    frame[nextLength] = data;
+
+    return nextLength + 1U;
+}
+
+uint32_t SIM_LinkDefaultClockGet(void)
+{
+    return SIM_LINK_DEFAULT_BAUD_RATE;
+}
+
+void SIM_LinkInitialize(uint32_t clock, uint64_t pollInterval, uint64_t latency)
+{
+    // The host reads the line as the bytes come in, there is nothing to poll
+    (void) pollInterval;
+
+    byteTime = ((uint64_t) SIM_LINK_FRAME_BITS * SIM_LINK_NANOSECONDS_PER_SECOND) / clock;
+    lineLatency = latency;
+    hostQueue.head = 0U;
+    hostQueue.count = 0U;
+    clientQueue.head = 0U;
+    clientQueue.count = 0U;
+    responseParser.frameLength = 0U;
+    responseParser.isInFrame = false;
+    responseParser.isEscaped = false;
+    isFlowControlEnabled = false;
+    lineFreeTime = 0U;
+    SIM_UsartBaudSet(clock);
+    SIM_LinkStatisticsClear();
+}
+
+void SIM_LinkClockSet(uint32_t clock)
+{
+    byteTime = ((uint64_t) SIM_LINK_FRAME_BITS * SIM_LINK_NANOSECONDS_PER_SECOND) / clock;
+    SIM_UsartHostBaudSet(clock);
+}
+
+void SIM_LinkFlowControlSet(bool isEnabled)
+{
+    isFlowControlEnabled = isEnabled;
+}
+
+bool SIM_LinkCommandSend(const uint8_t * packet, size_t length)
+{
+    static uint8_t frame[SIM_LINK_BUFFER_SIZE];
+    bool isSent = false;
+
+    if (((length + 2U) * 2U) <= (SIM_LINK_BUFFER_SIZE - 2U))
+    {
+        uint16_t frameCheck = SIM_LinkFrameCheckCalculate(packet, length);
+        size_t frameLength = 0U;
+
+        frame[frameLength] = SIM_LINK_START_OF_PACKET;
+        frameLength++;
+        for (size_t byteIndex = 0U; byteIndex < length; byteIndex++)
+        {
+            frameLength = DataByteAdd(&frame[0], frameLength, packet[byteIndex]);
+        }
+        frameLength = DataByteAdd(&frame[0], frameLength, (uint8_t) frameCheck);
+        frameLength = DataByteAdd(&frame[0], frameLength, (uint8_t)(frameCheck >> 8));
+        frame[frameLength] = SIM_LINK_END_OF_PACKET;
+        frameLength++;
+
+        // A cut off frame is finished by the start of the next one
+        bool isDuplicated = SIM_LinkFrameDuplicate();
+        size_t sendLength = SIM_LinkFrameLengthDistort(frameLength);
+
+        SIM_LinkTransactionCount(false);
+        isSent = true;
+        for (size_t byteIndex = 0U; byteIndex < sendLength; byteIndex++)
+        {
+            isSent = ByteSend(frame[byteIndex]) && isSent;
+        }
+
+        if (isDuplicated)
+        {
+            SIM_LinkTransactionCount(false);
+            for (size_t byteIndex = 0U; byteIndex < frameLength; byteIndex++)
+            {
+                (void) ByteSend(frame[byteIndex]);
+            }
+        }
+    }
+
+    return isSent;
+}
+
+bool SIM_LinkResponseReceive(uint8_t * packet, size_t size, size_t * length, uint64_t timeout)
+{
+    uint64_t endTime = SIM_TimeGet() + timeout;
+    bool isFrameEnded = false;
+    bool isReceived = false;
+
+    while (isFrameEnded == false)
+    {
+        uint8_t data = 0U;
+
+        if (QueueGet(&clientQueue, &data))
+        {
+            SIM_LinkTransferCount(0U, 1U, byteTime);
+
+            // A byte lost on the line does not reach the parser
+            isFrameEnded = (SIM_LinkBytesDistort(&data, 1U) == 1U) && ResponseByteParse(data);
+        }
+        else if (SIM_TimeGet() < endTime)
+        {
+            // The line stays idle for at least a byte
+            LineRun(SIM_TimeGet() + byteTime);
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    // A damaged frame ends the wait as well, the host sends the command again right away
+    if (isFrameEnded && (responseParser.frameLength > 2U) && ((responseParser.frameLength - 2U) <= size))
+    {
+        size_t responseLength = responseParser.frameLength - 2U;
+        uint16_t frameCheck = (uint16_t)((uint16_t) responseParser.frame[responseLength]
+                | ((uint16_t) responseParser.frame[responseLength + 1U] << 8));
+
+        isReceived = (SIM_LinkFrameCheckCalculate(&responseParser.frame[0], responseLength) == frameCheck);
+        (void) memcpy(packet, &responseParser.frame[0], responseLength);
+        *length = responseLength;
+    }
+
+    return isReceived;
+}
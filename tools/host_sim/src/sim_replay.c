@@ -0,0 +1,319 @@
+/**
+ * @file    sim_replay.c
+ * @ingroup mdfu_host_sim
+ * @brief   Applies MDFU firmware images (.img) to the simulated device through the bootloader core.
+ *
+ * The blocks of each image are passed to the core one at a time, in the same order and with the
+ * same Flash handshake as the FTP layer, then the downloaded image is verified. Further images are
+ * applied to the same Flash, after a bootloader with more than one image space has loaded the
+ * staged image the way its boot flow does, so a delta image can follow the image it is based on.
+ *
+ * The Flash model charges its command times on the virtual clock, so the tool predicts the time
+ * the device needs to apply each image, leaving out the transfer over the serial port, and the
+ * wear of the Flash rows.
+ *
+ * Usage:
+ *     mdfu_sim_replay_uart [options] PIC32CM_DefaultTest.img
+ *     mdfu_sim_replay_mi_arb [options] PIC32CM_TestApp_Binary_v1.img delta_v1_v2.img
+ *
+ * Options:
+ *     --page-write-us <n>   Page write time in microseconds
+ *     --row-erase-us <n>    Row erase time in microseconds
+ *     --region-lock-us <n>  Region lock and unlock time in microseconds
+ *     --flash-out <file>    Saves the Flash after the last image, for mdfu_sim_boot_mi_arb
+ *
+ * The exit code is 0 when every block is accepted and every image verifies.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bl_core.h"
+#include "bl_app_verify.h"
+#if BL_APPLICATION_IMAGE_COUNT > 1
+#include "bl_image_manager.h"
+#endif
+#include "sim_hal.h"
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_BLOCK_HEADER_SIZE
+ * @brief Size of the length and type fields that start every block of the image.
+ */
+#define SIM_BLOCK_HEADER_SIZE   (3U)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @def SIM_NANOSECONDS_PER_MILLISECOND
+ * @brief Conversion of the virtual clock to the printed times.
+ */
+#define SIM_NANOSECONDS_PER_MILLISECOND (1000000.0)
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Runs the queued Flash operations to the end.
+ *
+ * @param None
+ * @return Status of the last Flash operation
+ */
+static bl_result_t FlashTaskComplete(void);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Downloads one image and verifies it.
+ *
+ * @param[in] imagePath - Path of the .img file
+ * @return @ref BL_PASS - Every block has been accepted and the downloaded image is valid
+ * @return Status of the block or of the verification that failed otherwise
+ */
+static bl_result_t ImageApply(const char * imagePath);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Loads the staged image into the image space named by its footer, as the boot flow does.
+ *
+ * @param None
+ * @return @ref BL_PASS - The image has been loaded and verified, or there is a single image space
+ * @return Status of the copy or of the verification that failed otherwise
+ */
+static bl_result_t StagedImageLoad(void);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Reads a timing option given in microseconds.
+ *
+ * @param[in] value - Text of the option value
+ * @param[out] duration - Duration in nanoseconds
+ * @return True - The value is a number that fits into the duration
+ * @return False - The value is not valid
+ */
+static bool TimingOptionRead(const char * value, uint32_t * duration);
+
+/**
+ * @ingroup mdfu_host_sim
+ * @brief Prints the Flash wear caused since the reset and the updates left until the most erased row wears out.
+ *
+ * @param None
+ * @return None
+ */
+static void WearPrint(void);
+
+static bl_result_t FlashTaskComplete(void)
+{
+    bl_result_t flashStatus = BL_BUSY;
+
+    while (flashStatus == BL_BUSY)
+    {
+        flashStatus = BL_FlashTask();
+    }
+
+    return flashStatus;
+}
+
+static bl_result_t ImageApply(const char * imagePath)
+{
+    static uint32_t blockBuffer[(0xFFFFU + 3U) / 4U];
+    uint8_t * blockPtr = (uint8_t *) &blockBuffer[0];
+    bl_result_t status = BL_PASS;
+    uint32_t blockCount = 0U;
+    long imageLength = 0;
+
+    uint64_t startTime = SIM_TimeGet();
+
+    FILE * imageFile = fopen(imagePath, "rb");
+    if (imageFile == NULL)
+    {
+        (void) fprintf(stderr, "cannot open %s\n", imagePath);
+        return BL_FAIL;
+    }
+
+    (void) BL_Initialize();
+
+    while (status == BL_PASS)
+    {
+        uint8_t blockHeader[SIM_BLOCK_HEADER_SIZE];
+
+        if (fread(&blockHeader[0], 1U, SIM_BLOCK_HEADER_SIZE, imageFile) != SIM_BLOCK_HEADER_SIZE)
+        {
+            // End of the image
+            break;
+        }
+
+        uint16_t blockLength = (uint16_t)((uint16_t) blockHeader[0] | ((uint16_t) blockHeader[1] << 8));
+        if ((blockLength < SIM_BLOCK_HEADER_SIZE)
+                || (fread(&blockPtr[SIM_BLOCK_HEADER_SIZE], 1U, blockLength - SIM_BLOCK_HEADER_SIZE, imageFile) != (size_t)(blockLength - SIM_BLOCK_HEADER_SIZE)))
+        {
+            (void) fprintf(stderr, "truncated block %u\n", (unsigned int) blockCount);
+            status = BL_ERROR_COMMAND_PROCESSING;
+            break;
+        }
+        (void) memcpy(blockPtr, &blockHeader[0], SIM_BLOCK_HEADER_SIZE);
+
+        // The FTP layer only hands a new block to the core once the Flash is free
+        status = FlashTaskComplete();
+        if (status == BL_PASS)
+        {
+            status = BL_BootCommandProcess(blockPtr, blockLength);
+        }
+        if (status != BL_PASS)
+        {
+            (void) fprintf(stderr, "block %u (type 0x%02X) failed with 0x%02X\n", (unsigned int) blockCount, (unsigned int) blockHeader[2], (unsigned int) status);
+        }
+
+        blockCount++;
+        imageLength += blockLength;
+    }
+    (void) fclose(imageFile);
+
+    if (status == BL_PASS)
+    {
+        (void) BL_DownloadAreaComplete();
+        status = FlashTaskComplete();
+    }
+    if (status == BL_PASS)
+    {
+        status = BL_ImageVerify();
+    }
+
+    (void) printf("Image file          : %s\n", imagePath);
+    (void) printf("Blocks              : %u\n", (unsigned int) blockCount);
+    (void) printf("Image               : %ld bytes\n", imageLength);
+    (void) printf("Update time         : %.3f ms\n", (double)(SIM_TimeGet() - startTime) / SIM_NANOSECONDS_PER_MILLISECOND);
+
+    return status;
+}
+
+static bl_result_t StagedImageLoad(void)
+{
+    bl_result_t loadStatus = BL_PASS;
+
+#if BL_APPLICATION_IMAGE_COUNT > 1
+    uint8_t targetId = BL_ApplicationDownloadIdGet((uint8_t) BL_STAGING_IMAGE_ID);
+
+    loadStatus = BL_CopyImageAreas((uint8_t) BL_STAGING_IMAGE_ID, targetId);
+    if (loadStatus == BL_PASS)
+    {
+        loadStatus = BL_ImageVerifyById(targetId);
+    }
+    (void) printf("Loaded into image   : %u\n", (unsigned int) targetId);
+#endif
+
+    return loadStatus;
+}
+
+static bool TimingOptionRead(const char * value, uint32_t * duration)
+{
+    char * endPtr = NULL;
+    unsigned long microseconds = strtoul(value, &endPtr, 10);
+    bool isValid = ((endPtr != value) && (*endPtr == '\0') && (microseconds <= (UINT32_MAX / 1000U)));
+
+    if (isValid)
+    {
+        *duration = (uint32_t) microseconds * 1000U;
+    }
+
+    return isValid;
+}
+
+static void WearPrint(void)
+{
+    sim_flash_statistics_t statistics;
+
+    SIM_FlashStatisticsGet(&statistics);
+    (void) printf("Flash busy          : %.3f ms\n", (double) statistics.busyTime / SIM_NANOSECONDS_PER_MILLISECOND);
+    (void) printf("Page writes         : %u (%u without erase)\n", (unsigned int) statistics.pageWrites, (unsigned int) statistics.pageRewrites);
+    (void) printf("Row erases          : %u on %u rows\n", (unsigned int) statistics.rowErases, (unsigned int) statistics.erasedRows);
+    (void) printf("Most erased row     : %u (data Flash %u)\n", (unsigned int) statistics.maxRowErases, (unsigned int) statistics.maxDataRowErases);
+
+    // Each run stands for one update, the row erased most often wears out first
+    uint32_t updatesLeft = UINT32_MAX;
+    if (statistics.maxRowErases > 0U)
+    {
+        updatesLeft = SIM_FLASH_ENDURANCE / statistics.maxRowErases;
+    }
+    if ((statistics.maxDataRowErases > 0U) && ((SIM_DATAFLASH_ENDURANCE / statistics.maxDataRowErases) < updatesLeft))
+    {
+        updatesLeft = SIM_DATAFLASH_ENDURANCE / statistics.maxDataRowErases;
+    }
+    if (updatesLeft != UINT32_MAX)
+    {
+        (void) printf("Endurance           : %u updates\n", (unsigned int) updatesLeft);
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    bl_result_t status = BL_PASS;
+    sim_flash_timing_t flashTiming = *SIM_FlashTimingGet();
+    const char * flashPath = NULL;
+    int imageIndex = 1;
+
+    for (; (imageIndex < (argc - 1)) && (strncmp(argv[imageIndex], "--", 2U) == 0); imageIndex += 2)
+    {
+        bool isValid = false;
+
+        if (strcmp(argv[imageIndex], "--page-write-us") == 0)
+        {
+            isValid = TimingOptionRead(argv[imageIndex + 1], &flashTiming.pageWriteTime);
+        }
+        else if (strcmp(argv[imageIndex], "--row-erase-us") == 0)
+        {
+            isValid = TimingOptionRead(argv[imageIndex + 1], &flashTiming.rowEraseTime);
+        }
+        else if (strcmp(argv[imageIndex], "--region-lock-us") == 0)
+        {
+            isValid = TimingOptionRead(argv[imageIndex + 1], &flashTiming.regionLockTime);
+        }
+        else if (strcmp(argv[imageIndex], "--flash-out") == 0)
+        {
+            flashPath = argv[imageIndex + 1];
+            isValid = true;
+        }
+        else
+        {
+            // Unknown option
+        }
+
+        if (isValid == false)
+        {
+            (void) fprintf(stderr, "invalid option %s %s\n", argv[imageIndex], argv[imageIndex + 1]);
+            return 2;
+        }
+    }
+
+    if (imageIndex >= argc)
+    {
+        (void) fprintf(stderr, "usage: %s [--page-write-us <n>] [--row-erase-us <n>] [--region-lock-us <n>] [--flash-out <file>] <image.img> [<image.img>...]\n", argv[0]);
+        return 2;
+    }
+
+    SIM_FlashTimingSet(&flashTiming);
+    SIM_Reset();
+
+    for (; (imageIndex < argc) && (status == BL_PASS); imageIndex++)
+    {
+        status = ImageApply(argv[imageIndex]);
+
+        // The next image is built against the one the device runs
+        if ((status == BL_PASS) && ((imageIndex + 1) < argc))
+        {
+            status = StagedImageLoad();
+        }
+    }
+
+    if ((flashPath != NULL) && (SIM_FlashSave(flashPath) == false))
+    {
+        (void) fprintf(stderr, "cannot write %s\n", flashPath);
+        status = BL_FAIL;
+    }
+
+    const bl_flash_statistics_t * flashStatistics = BL_FlashStatisticsGet();
+    (void) printf("Programmed          : %u bytes\n", (unsigned int) flashStatistics->bytesProgrammed);
+    (void) printf("Rows erased         : %u\n", (unsigned int) flashStatistics->rowsErased);
+    (void) printf("Core busy time      : %.3f ms\n", (double) flashStatistics->busyTime / 1000.0);
+    (void) printf("Total time          : %.3f ms\n", (double) SIM_TimeGet() / SIM_NANOSECONDS_PER_MILLISECOND);
+    WearPrint();
+    (void) printf("Result              : %s (0x%02X)\n", (status == BL_PASS) ? "image valid" : "failed", (unsigned int) status);
+
+    return (status == BL_PASS) ? 0 : 1;
+}
@@ -0,0 +1,315 @@
+#!/usr/bin/env python3
+"""
+mdfu_image_compress.py
+
+Converts the Flash write blocks of an MDFU firmware image (.img) built by
+pyfwimagebuilder into compressed Flash data blocks (block type 0x05) as
+defined in docs/FirmwareUpdateFileFormat.md.
+
+Each compressed block decodes into the same bytes as the write block it
+replaces. Matches can reach back up to 4096 bytes, into the rows that the
+earlier blocks of the image have already written, so the bootloader needs no
+extra RAM for the window. A block is only replaced when its compressed form is
+smaller. The metadata block is updated to image format version 1.2.0 when at
+least one compressed block is emitted.
+
+Usage:
+    python mdfu_image_compress.py -i PIC32CM_DefaultTest.img -o PIC32CM_DefaultTest_lz.img
+    python mdfu_image_compress.py -i PIC32CM_DefaultTest.img -o out.img --write-size 256
+
+The output image is decoded again before it is written to check that it
+reproduces the Flash content of the input image.
+"""
+
+import argparse
+import struct
+import sys
+
+UNLOCK_BOOTLOADER = 0x01
+WRITE_FLASH = 0x02
+COMPRESSED_FLASH = 0x05
+
+BLOCK_HEADER_SIZE = 3
+COMMAND_HEADER_SIZE = 4
+COMPRESSED_HEADER_SIZE = 6
+
+FLASH_ROW_SIZE = 256
+FLASH_PAGE_SIZE = 64
+
+WINDOW_SIZE = 4096
+MIN_MATCH = 3
+MAX_MATCH = 18
+MAX_CANDIDATES = 256
+
+COMPRESSED_FORMAT_MINOR_VERSION = 2
+
+
+def blocks_parse(image):
+    """Splits the image into a list of (block type, block bytes)."""
+    blocks = []
+    offset = 0
+    while offset < len(image):
+        if (offset + BLOCK_HEADER_SIZE) > len(image):
+            raise ValueError("Truncated block header at offset {}".format(offset))
+        length, block_type = struct.unpack_from("<HB", image, offset)
+        if (length < BLOCK_HEADER_SIZE) or ((offset + length) > len(image)):
+            raise ValueError("Invalid block length {} at offset {}".format(length, offset))
+        blocks.append((block_type, image[offset:offset + length]))
+        offset += length
+    return blocks
+
+
+def block_build(block_type, body):
+    """Prepends the block header to the given body."""
+    return struct.pack("<HB", len(body) + BLOCK_HEADER_SIZE, block_type) + body
+
+
+class FlashModel:
+    """Flash content of the download area as the bootloader builds it.
+
+    A row is erased the first time a block writes into it, so only the rows
+    that have been touched hold data that a match can reference.
+    """
+
+    def __init__(self):
+        self.rows = {}
+
+    def write(self, address, data):
+        for index, value in enumerate(data):
+            row = (address + index) // FLASH_ROW_SIZE
+            if row not in self.rows:
+                self.rows[row] = bytearray(b"\xFF" * FLASH_ROW_SIZE)
+            self.rows[row][(address + index) % FLASH_ROW_SIZE] = value
+
+    def read(self, address):
+        """Returns the byte at the address or None if its row is not written yet."""
+        row = self.rows.get(address // FLASH_ROW_SIZE)
+        return None if row is None else row[address % FLASH_ROW_SIZE]
+
+
+def block_compress(flash, address, data):
+    """Compresses one block of data written at the given address.
+
+    Returns the LZSS stream: groups of a flag byte followed by eight tokens.
+    A flag bit of 0 selects a literal byte, 1 selects a little endian match
+    token holding (distance - 1) in bits 0-11 and (length - 3) in bits 12-15.
+    """
+    window_start = max(0, address - WINDOW_SIZE)
+    history = [flash.read(a) for a in range(window_start, address)]
+    buffer = history + list(data)
+    base = len(history)
+
+    chains = {}
+
+    def position_add(position):
+        if (position + MIN_MATCH) <= len(buffer):
+            key = tuple(buffer[position:position + MIN_MATCH])
+            if None not in key:
+                chains.setdefault(key, []).append(position)
+
+    for position in range(base):
+        position_add(position)
+
+    stream = bytearray()
+    flags = 0
+    flag_count = 0
+    flag_index = None
+    position = base
+
+    while position < len(buffer):
+        if flag_count == 0:
+            flag_index = len(stream)
+            stream.append(0)
+            flags = 0
+
+        best_length = 0
+        best_distance = 0
+        key = tuple(buffer[position:position + MIN_MATCH])
+        limit = min(MAX_MATCH, len(buffer) - position)
+        for candidate in reversed(chains.get(key, [])[-MAX_CANDIDATES:]):
+            distance = position - candidate
+            if distance > WINDOW_SIZE:
+                break
+            length = 0
+            while (length < limit) and (buffer[candidate + length] is not None) and (buffer[candidate + length] == buffer[position + length]):
+                length += 1
+            if length > best_length:
+                best_length = length
+                best_distance = distance
+                if length == limit:
+                    break
+
+        if best_length >= MIN_MATCH:
+            token = ((best_distance - 1) & 0x0FFF) | ((best_length - MIN_MATCH) << 12)
+            stream += struct.pack("<H", token)
+            flags |= 1 << flag_count
+            step = best_length
+        else:
+            stream.append(buffer[position])
+            step = 1
+
+        for _ in range(step):
+            position_add(position)
+            position += 1
+
+        stream[flag_index] = flags
+        flag_count = (flag_count + 1) % 8
+
+    return bytes(stream)
+
+
+def block_decompress(flash, address, stream, length):
+    """Decodes a compressed block the same way as the bootloader."""
+    output = bytearray()
+    index = 0
+    flags = 0
+    flag_count = 0
+    while len(output) < length:
+        if flag_count == 0:
+            flags = stream[index]
+            index += 1
+            flag_count = 8
+        if (flags & 0x01) == 0:
+            output.append(stream[index])
+            index += 1
+        else:
+            token = struct.unpack_from("<H", stream, index)[0]
+            index += 2
+            distance = (token & 0x0FFF) + 1
+            match_length = (token >> 12) + MIN_MATCH
+            for _ in range(match_length):
+                if distance <= len(output):
+                    output.append(output[len(output) - distance])
+                else:
+                    value = flash.read(address + len(output) - distance)
+                    if value is None:
+                        raise ValueError("Match at 0x{:08X} reads a row that is not written".format(address))
+                    output.append(value)
+        flags >>= 1
+        flag_count -= 1
+    if len(output) != length:
+        raise ValueError("Block at 0x{:08X} decodes to {} bytes instead of {}".format(address, len(output), length))
+    return bytes(output)
+
+
+def write_data_collect(blocks):
+    """Returns the (address, data) list of the write blocks, in image order."""
+    writes = []
+    for block_type, block in blocks:
+        if block_type == WRITE_FLASH:
+            address = struct.unpack_from("<I", block, BLOCK_HEADER_SIZE)[0]
+            writes.append((address, block[BLOCK_HEADER_SIZE + COMMAND_HEADER_SIZE:]))
+    return writes
+
+
+def writes_regroup(writes, write_size):
+    """Merges contiguous write data and splits it again into blocks of write_size bytes."""
+    regrouped = []
+    for address, data in writes:
+        if regrouped and ((regrouped[-1][0] + len(regrouped[-1][1])) == address) and (len(regrouped[-1][1]) < write_size):
+            last_address, last_data = regrouped[-1]
+            room = write_size - len(last_data)
+            regrouped[-1] = (last_address, last_data + data[:room])
+            data = data[room:]
+            address += room
+        while data:
+            regrouped.append((address, data[:write_size]))
+            address += len(data[:write_size])
+            data = data[write_size:]
+    return regrouped
+
+
+def image_compress(image, write_size=None):
+    blocks = blocks_parse(image)
+    if (not blocks) or (blocks[0][0] != UNLOCK_BOOTLOADER):
+        raise ValueError("The image does not start with a metadata block")
+    for block_type, _ in blocks[1:]:
+        if block_type != WRITE_FLASH:
+            raise ValueError("Only images made of Flash write blocks can be compressed, found block type 0x{:02X}".format(block_type))
+
+    metadata = bytearray(blocks[0][1])
+    metadata_write_size = struct.unpack_from("<H", metadata, 10)[0]
+    writes = write_data_collect(blocks)
+
+    if write_size is not None:
+        if (write_size % FLASH_PAGE_SIZE) != 0:
+            raise ValueError("The write size must be a multiple of {} bytes".format(FLASH_PAGE_SIZE))
+        struct.pack_into("<H", metadata, 10, write_size)
+        writes = writes_regroup(writes, write_size)
+    else:
+        write_size = metadata_write_size
+
+    flash = FlashModel()
+    output_blocks = []
+    compressed_count = 0
+    for address, data in writes:
+        stream = block_compress(flash, address, data)
+        compressed_body = struct.pack("<IH", address, len(data)) + stream
+        raw_body = struct.pack("<I", address) + data
+        if len(compressed_body) < len(raw_body):
+            output_blocks.append(block_build(COMPRESSED_FLASH, compressed_body))
+            compressed_count += 1
+        else:
+            output_blocks.append(block_build(WRITE_FLASH, raw_body))
+        flash.write(address, data)
+
+    if compressed_count > 0:
+        # Compressed blocks need image format 1.2.0
+        metadata[4] = max(metadata[4], COMPRESSED_FORMAT_MINOR_VERSION)
+        metadata[3] = 0
+
+    output = bytes(metadata) + b"".join(output_blocks)
+    return output, len(writes), compressed_count, write_size
+
+
+def image_verify(original, compressed):
+    """Checks that both images program the same Flash content."""
+    expected = FlashModel()
+    for address, data in write_data_collect(blocks_parse(original)):
+        expected.write(address, data)
+
+    actual = FlashModel()
+    for block_type, block in blocks_parse(compressed)[1:]:
+        if block_type == WRITE_FLASH:
+            address = struct.unpack_from("<I", block, BLOCK_HEADER_SIZE)[0]
+            actual.write(address, block[BLOCK_HEADER_SIZE + COMMAND_HEADER_SIZE:])
+        elif block_type == COMPRESSED_FLASH:
+            address, length = struct.unpack_from("<IH", block, BLOCK_HEADER_SIZE)
+            stream = block[BLOCK_HEADER_SIZE + COMPRESSED_HEADER_SIZE:]
+            actual.write(address, block_decompress(actual, address, stream, length))
+        else:
+            raise ValueError("Unexpected block type 0x{:02X}".format(block_type))
+
+    if expected.rows != actual.rows:
+        raise ValueError("The compressed image does not reproduce the Flash content of the input image")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compress the write blocks of an MDFU firmware image")
+    parser.add_argument("-i", "--input", required=True, help="Input .img file built by pyfwimagebuilder")
+    parser.add_argument("-o", "--output", required=True, help="Output .img file")
+    parser.add_argument("--write-size", type=lambda value: int(value, 0), default=None,
+                        help="Regroup the data into write blocks of this many bytes and update the metadata write size")
+    parser.add_argument("--baud", type=int, default=115200, help="Baud rate used for the transfer time estimate")
+    args = parser.parse_args()
+
+    with open(args.input, "rb") as input_file:
+        original = input_file.read()
+
+    compressed, block_count, compressed_count, write_size = image_compress(original, args.write_size)
+    image_verify(original, compressed)
+
+    with open(args.output, "wb") as output_file:
+        output_file.write(compressed)
+
+    # Each byte on the wire costs ten bit times with 8N1 framing
+    print("Write size          : {} bytes".format(write_size))
+    print("Write blocks        : {} ({} compressed)".format(block_count, compressed_count))
+    print("Input image         : {} bytes, ~{:.2f} s at {} baud".format(len(original), len(original) * 10.0 / args.baud, args.baud))
+    print("Output image        : {} bytes, ~{:.2f} s at {} baud".format(len(compressed), len(compressed) * 10.0 / args.baud, args.baud))
+    print("Size ratio          : {:.1f} %".format(100.0 * len(compressed) / len(original)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
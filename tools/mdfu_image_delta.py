@@ -0,0 +1,180 @@
+#!/usr/bin/env python3
+"""
+mdfu_image_delta.py
+
+Builds a delta firmware image (.img) for the MI_ARB bootloader out of the
+image running on the device and the new image, both built by
+pyfwimagebuilder. The output uses delta blocks (block type 0x06) as defined
+in docs/FirmwareUpdateFileFormat.md.
+
+Each delta block copies a run of Flash pages from the execution image into
+the staging image, then programs the pages that could not be found in the
+execution image from its literal data. Pages are looked up at any 2-byte
+offset of the execution image, so code that only moved is copied as well.
+The staging image is verified by the bootloader as usual, so a device that
+does not run the expected base image rejects the update.
+
+Usage:
+    python mdfu_image_delta.py --base PIC32CM_TestApp_Binary_v1.img -i PIC32CM_TestApp_Binary_v2.img -o v1_to_v2.img
+
+The output image is applied again to the base image before it is written to
+check that it reproduces the Flash content of the new image.
+"""
+
+import argparse
+import struct
+import sys
+
+from mdfu_image_compress import (BLOCK_HEADER_SIZE, FLASH_PAGE_SIZE, UNLOCK_BOOTLOADER, WRITE_FLASH,
+                                 block_build, blocks_parse, write_data_collect)
+
+DELTA_FLASH = 0x06
+
+DELTA_HEADER_SIZE = 12
+
+DELTA_FORMAT_MINOR_VERSION = 3
+
+SOURCE_ALIGNMENT = 2
+
+
+def pages_collect(blocks):
+    """Returns a dictionary of the Flash pages written by the image, keyed by address."""
+    pages = {}
+    for address, data in write_data_collect(blocks):
+        if (address % FLASH_PAGE_SIZE) != 0:
+            raise ValueError("Write block at 0x{:08X} is not aligned to a Flash page".format(address))
+        for offset in range(0, len(data), FLASH_PAGE_SIZE):
+            page = data[offset:offset + FLASH_PAGE_SIZE]
+            pages[address + offset] = page + (b"\xFF" * (FLASH_PAGE_SIZE - len(page)))
+    return pages
+
+
+class BaseImage:
+    """Execution image content that the bootloader can copy from."""
+
+    def __init__(self, pages):
+        self.start = min(pages)
+        self.end = max(pages) + FLASH_PAGE_SIZE
+        self.data = bytearray(b"\xFF" * (self.end - self.start))
+        for address, page in pages.items():
+            self.data[address - self.start:address - self.start + FLASH_PAGE_SIZE] = page
+
+        # Index every aligned offset by its first bytes to find pages that moved
+        self.index = {}
+        for offset in range(0, len(self.data) - FLASH_PAGE_SIZE + 1, SOURCE_ALIGNMENT):
+            self.index.setdefault(bytes(self.data[offset:offset + 8]), []).append(offset)
+
+    def read(self, address, length):
+        return bytes(self.data[address - self.start:address - self.start + length])
+
+    def contains(self, address, length):
+        return (address >= self.start) and ((address + length) <= self.end)
+
+    def page_find(self, page, preferred):
+        """Returns the address of a copy of the page, trying the preferred address first."""
+        if (preferred is not None) and self.contains(preferred, FLASH_PAGE_SIZE) and (self.read(preferred, FLASH_PAGE_SIZE) == page):
+            return preferred
+        for offset in self.index.get(bytes(page[:8]), []):
+            if self.data[offset:offset + FLASH_PAGE_SIZE] == page:
+                return self.start + offset
+        return None
+
+
+def delta_build(base, pages, write_size):
+    """Returns the list of delta blocks as (start address, copy length, source address, literal data)."""
+    deltas = []
+    current = None
+
+    for address in sorted(pages):
+        page = pages[address]
+        contiguous = (current is not None) and ((current[0] + current[1] + len(current[3])) == address)
+
+        # Keep extending the current copy run with the same source offset when possible
+        preferred = address
+        if contiguous and (len(current[3]) == 0) and (current[1] > 0):
+            preferred = current[2] + current[1]
+        source = base.page_find(page, preferred)
+
+        if source is not None:
+            if contiguous and (len(current[3]) == 0) and (current[1] > 0) and ((current[2] + current[1]) == source):
+                current[1] += FLASH_PAGE_SIZE
+            else:
+                current = [address, FLASH_PAGE_SIZE, source, b""]
+                deltas.append(current)
+        else:
+            if contiguous and ((len(current[3]) + FLASH_PAGE_SIZE) <= write_size):
+                current[3] += page
+            else:
+                current = [address, 0, 0, page]
+                deltas.append(current)
+
+    return [tuple(delta) for delta in deltas]
+
+
+def delta_apply(base, blocks):
+    """Applies the delta blocks to the base image and returns the pages that they program."""
+    pages = {}
+    for block_type, block in blocks:
+        if block_type != DELTA_FLASH:
+            raise ValueError("Unexpected block type 0x{:02X}".format(block_type))
+        address, copy_length, source = struct.unpack_from("<III", block, BLOCK_HEADER_SIZE)
+        data = base.read(source, copy_length) + block[BLOCK_HEADER_SIZE + DELTA_HEADER_SIZE:]
+        for offset in range(0, len(data), FLASH_PAGE_SIZE):
+            page = data[offset:offset + FLASH_PAGE_SIZE]
+            pages[address + offset] = page + (b"\xFF" * (FLASH_PAGE_SIZE - len(page)))
+    return pages
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Build a delta MDFU firmware image for the MI_ARB bootloader")
+    parser.add_argument("--base", required=True, help="Image running in the execution slot of the device")
+    parser.add_argument("-i", "--input", required=True, help="New image built by pyfwimagebuilder")
+    parser.add_argument("-o", "--output", required=True, help="Output .img file")
+    parser.add_argument("--baud", type=int, default=115200, help="Baud rate used for the transfer time estimate")
+    args = parser.parse_args()
+
+    with open(args.base, "rb") as base_file:
+        base_blocks = blocks_parse(base_file.read())
+    with open(args.input, "rb") as input_file:
+        original = input_file.read()
+    blocks = blocks_parse(original)
+
+    if (not blocks) or (blocks[0][0] != UNLOCK_BOOTLOADER):
+        raise ValueError("The image does not start with a metadata block")
+    for block_type, _ in blocks[1:]:
+        if block_type != WRITE_FLASH:
+            raise ValueError("Only images made of Flash write blocks can be converted, found block type 0x{:02X}".format(block_type))
+
+    metadata = bytearray(blocks[0][1])
+    write_size = struct.unpack_from("<H", metadata, 10)[0]
+    base = BaseImage(pages_collect(base_blocks))
+    pages = pages_collect(blocks)
+
+    deltas = delta_build(base, pages, write_size)
+    output_blocks = [block_build(DELTA_FLASH, struct.pack("<III", address, copy_length, source) + literal)
+                     for address, copy_length, source, literal in deltas]
+
+    # Delta blocks need image format 1.3.0
+    metadata[4] = max(metadata[4], DELTA_FORMAT_MINOR_VERSION)
+    metadata[3] = 0
+    output = bytes(metadata) + b"".join(output_blocks)
+
+    if delta_apply(base, blocks_parse(output)[1:]) != pages:
+        raise ValueError("The delta image does not reproduce the Flash content of the new image")
+
+    with open(args.output, "wb") as output_file:
+        output_file.write(output)
+
+    copied = sum(delta[1] for delta in deltas)
+    literal = sum(len(delta[3]) for delta in deltas)
+    print("Delta blocks        : {}".format(len(deltas)))
+    print("Copied from base    : {} bytes".format(copied))
+    print("Sent as literal     : {} bytes".format(literal))
+    print("Input image         : {} bytes, ~{:.2f} s at {} baud".format(len(original), len(original) * 10.0 / args.baud, args.baud))
+    print("Output image        : {} bytes, ~{:.2f} s at {} baud".format(len(output), len(output) * 10.0 / args.baud, args.baud))
+    print("Size ratio          : {:.1f} %".format(100.0 * len(output) / len(original)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
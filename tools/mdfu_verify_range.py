@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+"""
+mdfu_verify_range.py
+
+Post build helper for the single image applications (UART, SPI and I2C).
+
+Finds the last address used by the application in the linker output (.hex),
+stores it as the verification end address of the application footer and
+prints the verification range in the form used by the hexmate -CK option.
+The bootloader only checks the hash over this range, so the verification
+time follows the size of the application instead of the size of the Flash.
+
+The footer layout matches bl_footer_data_t of the bootloader:
+    +0x00 application ID
+    +0x04 application version
+    +0x08 verification end address
+    +0x0C verification start address
+    +0x10 hash
+
+This script must run before the empty application space is filled, otherwise
+the fill data is taken as part of the application.
+
+Usage:
+    python mdfu_verify_range.py -i app.hex --start 0x1000 --footer 0x1FFEC
+    prints: 1000-2C3F
+"""
+
+import argparse
+import struct
+import sys
+
+FOOTER_END_ADDRESS_OFFSET = 0x08
+FOOTER_START_ADDRESS_OFFSET = 0x0C
+FOOTER_SIZE = 0x14
+
+# The DSU calculates the CRC over whole 32-bit words
+VERIFY_ALIGNMENT = 4
+
+
+def hex_read(path):
+    """Returns the data of an Intel HEX file as a dictionary keyed by address, and the start address record."""
+    memory = {}
+    start_record = None
+    base_address = 0
+    with open(path, "r") as hex_file:
+        for line_number, line in enumerate(hex_file, 1):
+            line = line.strip()
+            if not line:
+                continue
+            if not line.startswith(":"):
+                raise ValueError("Line {} is not an Intel HEX record".format(line_number))
+            record = bytes.fromhex(line[1:])
+            if (sum(record) & 0xFF) != 0:
+                raise ValueError("Line {} has an invalid checksum".format(line_number))
+            length, offset, record_type = record[0], struct.unpack(">H", record[1:3])[0], record[3]
+            data = record[4:4 + length]
+            if record_type == 0x00:
+                for index, value in enumerate(data):
+                    memory[base_address + offset + index] = value
+            elif record_type == 0x01:
+                break
+            elif record_type == 0x02:
+                base_address = struct.unpack(">H", data)[0] << 4
+            elif record_type == 0x04:
+                base_address = struct.unpack(">H", data)[0] << 16
+            elif record_type in (0x03, 0x05):
+                start_record = (record_type, data)
+            else:
+                raise ValueError("Line {} has an unknown record type 0x{:02X}".format(line_number, record_type))
+    return memory, start_record
+
+
+def record_format(record_type, offset, data):
+    record = struct.pack(">BHB", len(data), offset, record_type) + data
+    return ":{}{:02X}\n".format(record.hex().upper(), (-sum(record)) & 0xFF)
+
+
+def hex_write(path, memory, start_record):
+    """Writes the data back as an Intel HEX file with 16 bytes per record."""
+    lines = []
+    upper_address = None
+    addresses = sorted(memory)
+    index = 0
+    while index < len(addresses):
+        address = addresses[index]
+        if (address >> 16) != upper_address:
+            upper_address = address >> 16
+            lines.append(record_format(0x04, 0, struct.pack(">H", upper_address)))
+        data = bytearray()
+        while ((index < len(addresses)) and (addresses[index] == (address + len(data))) and (len(data) < 16)
+               and ((addresses[index] >> 16) == upper_address)):
+            data.append(memory[addresses[index]])
+            index += 1
+        lines.append(record_format(0x00, address & 0xFFFF, bytes(data)))
+    if start_record is not None:
+        lines.append(record_format(start_record[0], 0, start_record[1]))
+    lines.append(record_format(0x01, 0, b""))
+    with open(path, "w") as hex_file:
+        hex_file.writelines(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Store the real application end address in the footer and print the verification range")
+    parser.add_argument("-i", "--input", required=True, help="Application .hex file, updated in place")
+    parser.add_argument("--start", type=lambda value: int(value, 0), required=True, help="Start address of the application space")
+    parser.add_argument("--footer", type=lambda value: int(value, 0), required=True, help="Start address of the application footer")
+    args = parser.parse_args()
+
+    memory, start_record = hex_read(args.input)
+
+    used = [address for address in memory if args.start <= address < args.footer]
+    if not used:
+        raise ValueError("The image holds no data between 0x{:X} and 0x{:X}".format(args.start, args.footer))
+
+    end_address = max(used)
+    end_address = (((end_address + VERIFY_ALIGNMENT) // VERIFY_ALIGNMENT) * VERIFY_ALIGNMENT) - 1
+
+    for offset, value in ((FOOTER_END_ADDRESS_OFFSET, end_address), (FOOTER_START_ADDRESS_OFFSET, args.start)):
+        for index, byte in enumerate(struct.pack("<I", value)):
+            memory[args.footer + offset + index] = byte
+
+    hex_write(args.input, memory, start_record)
+
+    print("{:X}-{:X}".format(args.start, end_address))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())